@@ -535,11 +535,46 @@ void print3AddressCodeAfterOptimizationToFile(int before_count, int after_count)
     fprintf(output_file, "║  ├─ Instructions Eliminated:           %-3d                                                     ║\n", instructions_eliminated);
     fprintf(output_file, "║  └─ Code Size Reduction:               %.2f%%                                                  ║\n", reduction_percentage);
     fprintf(output_file, "║                                                                                                  ║\n");
+    char row[MAX_NAME];
+    snprintf(row, sizeof(row), "Pass Pipeline (%s):", opt_pipeline_name);
+    fprintf(output_file, "║  %-95s ║\n", row);
+    fprintf(output_file, "║     %-24s %-4s %11s %14s  %-9s                          ║\n", "Pass", "Runs", "Wall Time", "Instructions", "Changed");
+    for (int i = 0; i < opt_phase_count; i++) {
+        optPhaseStat* stat = &optPhaseStats[i];
+        bool last = (i == opt_phase_count - 1);
+        if (stat->runs == 0 && !stat->skipped) continue;
+
+        snprintf(row, sizeof(row), "%-24s x%-3d %8.3f ms  %5d -> %-5d  %s%s",
+                 stat->name, stat->runs, stat->timeMs,
+                 stat->instructionsBefore, stat->instructionsAfter,
+                 stat->skipped ? "skipped (no budget)" : (stat->changed ? "yes" : "no"),
+                 stat->outOfBudget ? " (budget ran out)" : "");
+        fprintf(output_file, "║  %s %-92s ║\n", last ? "└─" : "├─", row);
+
+        // phase-specific counters on their own line
+        if (stat->detail[0] != '\0') {
+            fprintf(output_file, "║  %s    %-90s ║\n", last ? " " : "│", stat->detail);
+        }
+    }
+    if (opt_phase_count == 0) {
+        fprintf(output_file, "║  └─ (no optimization passes)                                                                    ║\n");
+    }
+    if (opt_fuel_limit >= 0 || opt_time_limit_ms >= 0) {
+        snprintf(row, sizeof(row), "Budget: %s%s", getOptimizationBudgetSummary(),
+                 opt_budget_exhausted ? " - EXHAUSTED" : "");
+        fprintf(output_file, "║  %-95s ║\n", row);
+    }
+    fprintf(output_file, "║                                                                                                  ║\n");
     fprintf(output_file, "║  Optimizations Applied:                                                                         ║\n");
     fprintf(output_file, "║  • Constant Folding                                                                             ║\n");
     fprintf(output_file, "║  • Constant Propagation                                                                         ║\n");
+    fprintf(output_file, "║  • Sparse Conditional Constant Propagation (Branch Pruning)                                     ║\n");
+    fprintf(output_file, "║  • Local Value Numbering (CSE)                                                                  ║\n");
+    fprintf(output_file, "║  • Algebraic Simplification & Strength Reduction                                                ║\n");
+    fprintf(output_file, "║  • Partial Redundancy Elimination (Lazy Code Motion)                                            ║\n");
     fprintf(output_file, "║  • Copy Propagation                                                                             ║\n");
     fprintf(output_file, "║  • Dead Code Elimination (DCE)                                                                  ║\n");
+    fprintf(output_file, "║  • CFG Simplification (Jump Threading, Block Merging)                                           ║\n");
     fprintf(output_file, "║  • Live Variable Analysis                                                                       ║\n");
     fprintf(output_file, "║                                                                                                  ║\n");
     fprintf(output_file, "╚══════════════════════════════════════════════════════════════════════════════════════════════════╝\n");
@@ -1169,22 +1204,22 @@ void printRealTargetCodeToFile() {
     fprintf(output_file, "║  #    │ Assembly Instruction                                                                     ║\n");
     fprintf(output_file, "╠═══════╪══════════════════════════════════════════════════════════════════════════════════════════╣\n");
 
-    extern AsmInstruction* realAsmCode[];
     extern int real_asm_count;
 
     if (real_asm_count == 0) {
         fprintf(output_file, "║                                  (No real target code generated)                                 ║\n");
     } else {
         for (int i = 0; i < real_asm_count; i++) {
-            if (strlen(realAsmCode[i]->instruction) == 0) {
+            const char* line = getRealAsmLine(i);
+            if (strlen(line) == 0) {
                 fprintf(output_file, "║       │                                                                                      ║\n");
-            } else if (realAsmCode[i]->instruction[0] != ' ' && 
-                       realAsmCode[i]->instruction[0] != '\t' &&
-                       (strchr(realAsmCode[i]->instruction, ':') != NULL || 
-                        realAsmCode[i]->instruction[0] == '.')) {
-                fprintf(output_file, "║       │ %-84s ║\n", realAsmCode[i]->instruction);
+            } else if (line[0] != ' ' && 
+                       line[0] != '\t' &&
+                       (strchr(line, ':') != NULL || 
+                        line[0] == '.')) {
+                fprintf(output_file, "║       │ %-84s ║\n", line);
             } else {
-                fprintf(output_file, "║ %5d │ %-84s ║\n", i + 1, realAsmCode[i]->instruction);
+                fprintf(output_file, "║ %5d │ %-84s ║\n", i + 1, line);
             }
         }
     }
@@ -1201,6 +1236,21 @@ void printRealTargetCodeToFile() {
     fprintf(output_file, "║  Total Assembly Instructions: %-3d                                                              ║\n", real_asm_count);
     fprintf(output_file, "║  Target Architecture: x86-64 (AT&T syntax)                                                     ║\n");
     fprintf(output_file, "║  Stack Allocated: Variables mapped to stack offsets                                            ║\n");
+    char frame[MAX_NAME];
+    snprintf(frame, sizeof(frame), "Stack Frame: %d bytes (%d without slot sharing), %d names in %d slots, %d copies coalesced",
+             stack_frame_after, stack_frame_before, stack_slot_names, stack_slot_count, stack_copies_coalesced);
+    fprintf(output_file, "║  %-96s║\n", frame);
+    snprintf(frame, sizeof(frame), "Registers: %d names in %d registers (linear scan), %d on the stack",
+             reg_names_allocated, reg_used_count, reg_names_spilled);
+    fprintf(output_file, "║  %-96s║\n", frame);
+    snprintf(frame, sizeof(frame), "Peephole: %d forwarded loads, %d moves removed, %d strength reduced, %d jumps removed",
+             peep_store_load_forwarded, peep_moves_removed, peep_strength_reduced, peep_jumps_removed);
+    fprintf(output_file, "║  %-96s║\n", frame);
+    snprintf(frame, sizeof(frame), "Loop idioms: %d fill/copy loops as straight stores or rep stos/movs", real_loop_idioms);
+    fprintf(output_file, "║  %-96s║\n", frame);
+    snprintf(frame, sizeof(frame), "Vectorized: %d loops with %s", real_loops_vectorized,
+             real_vector_isa == VECTOR_AVX2 ? "AVX2 (4 elements per %ymm)" : real_vector_isa == VECTOR_SSE2 ? "SSE2 (2 elements per %xmm)" : "none (--vector=none)");
+    fprintf(output_file, "║  %-96s║\n", frame);
     fprintf(output_file, "║  Status: Ready for GCC Assembly (save as .s file and assemble)                                 ║\n");
     fprintf(output_file, "╚══════════════════════════════════════════════════════════════════════════════════════════════════╝\n");
     fprintf(output_file, "\n");
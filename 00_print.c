@@ -841,7 +841,6 @@ void printRealTargetCode() {
     // printf("╠═══════╪══════════════════════════════════════════════════════════════════════════════════════════╣\n");
 
     // External declarations for real assembly code
-    extern AsmInstruction* realAsmCode[];
     extern int real_asm_count;
 
     if (real_asm_count == 0) {
@@ -849,17 +848,17 @@ void printRealTargetCode() {
     } else {
         for (int i = 0; i < real_asm_count; i++) {
             // Handle empty lines and labels (no line numbers for formatting)
-            if (strlen(realAsmCode[i]->instruction) == 0) {
+            if (strlen(getRealAsmLine(i)) == 0) {
                 // printf("║       │                                                                                      ║\n");
-            } else if (realAsmCode[i]->instruction[0] != ' ' && 
-                       realAsmCode[i]->instruction[0] != '\t' &&
-                       (strchr(realAsmCode[i]->instruction, ':') != NULL || 
-                        realAsmCode[i]->instruction[0] == '.')) {
+            } else if (getRealAsmLine(i)[0] != ' ' && 
+                       getRealAsmLine(i)[0] != '\t' &&
+                       (strchr(getRealAsmLine(i), ':') != NULL || 
+                        getRealAsmLine(i)[0] == '.')) {
                 // It's a label or section directive
-                // printf("║       │ %-84s ║\n", realAsmCode[i]->instruction);
+                // printf("║       │ %-84s ║\n", getRealAsmLine(i));
             } else {
                 // Regular instruction with line number
-                // printf("║ %5d │ %-84s ║\n", i + 1, realAsmCode[i]->instruction);
+                // printf("║ %5d │ %-84s ║\n", i + 1, getRealAsmLine(i));
             }
         }
     }
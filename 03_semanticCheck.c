@@ -262,8 +262,9 @@ tokenType getOutputTokenTypeOfAST(ASTNode* top){
             
             return KEYWORD_DOUBLE; // either both are int or one is int and one is double
         } else if(check == 2){ // found == != > < >= <=
-            if((left != KEYWORD_INT && left != KEYWORD_DOUBLE && left != KEYWORD_BOOL) || (right != KEYWORD_INT && right != KEYWORD_DOUBLE && right != KEYWORD_BOOL)){ // left and right must be int/double/bool
-                printf("03 || Semantic Check error [03.13] -> Expected INT/DOUBLE/BOOLEON around binop\n");
+            bool charCompare = (left == KEYWORD_CHAR && right == KEYWORD_CHAR); // chars compare only with chars
+            if(!charCompare && ((left != KEYWORD_INT && left != KEYWORD_DOUBLE && left != KEYWORD_BOOL) || (right != KEYWORD_INT && right != KEYWORD_DOUBLE && right != KEYWORD_BOOL))){ // left and right must be int/double/bool (or both char)
+                printf("03 || Semantic Check error [03.13] -> Expected INT/DOUBLE/BOOLEON around binop (or CHAR on both sides)\n");
                 exit(3);
             }            
 
@@ -479,7 +479,7 @@ address* genAddr(ASTNode* top){
         sprintf(value , "%d" , top->int_value);
         return genAssign(generateNewAddrResult() , value);
     } else if(top->type == AST_DOUBLE){ // floating point literal
-        sprintf(value , "%f" , top->double_value);
+        formatDoubleConstant(top->double_value , value); // exact, shortest form
         return genAssign(generateNewAddrResult() , value);
     } else if(top->type == AST_BOOL){ // boolean literal
         if(top->bool_value){
@@ -489,7 +489,7 @@ address* genAddr(ASTNode* top){
         }
         return genAssign(generateNewAddrResult() , value);
     } else if(top->type == AST_CHAR){ // character literal
-        sprintf(value , "%c" , top->char_value);
+        formatCharConstant(top->char_value , value); // quoted so it is never taken for a variable
         return genAssign(generateNewAddrResult() , value);
     } else if(top->type == AST_VAR){ // variable access
         return genAssign(generateNewAddrResult() , top->var.var_name);
@@ -0,0 +1,329 @@
+/**
+ * 05_01_localValueNumbering.c - Local Value Numbering (Block-Level CSE)
+ *
+ * This module removes redundant computations inside each basic block.
+ * Every value computed in the block gets a number, and the optimizer
+ * remembers which variable already holds that value.
+ *
+ * Features:
+ * - Hash-based value numbering of operands and expressions
+ * - Canonical operand order for commutative operators (+, *, ==, !=, &&, ||)
+ * - Redundant expressions rewritten to copies of the earlier result
+ * - Operands rewritten to the oldest variable still holding the same value
+ * - Array reads forwarded from earlier reads/writes until the next write to that array
+ * - Blocks are independent and numbered in parallel (05_08)
+ *
+ * Example:
+ *   T1 = i              T1 = i
+ *   T2 = arr[T1]        T2 = arr[i]
+ *   T4 = T2 + 1   ==>   T4 = T2 + 1
+ *   T5 = i              T5 = i          (dead, removed by DCE)
+ *   arr[T5] = T4        arr[i] = T4
+ *   T7 = arr[T5]        T7 = T4         (forwarded from the write)
+ *
+ * Author: Ridham Khurana
+ */
+
+#include "database.h"
+
+// set by every optimization that changes an instruction (05_optimization.c)
+extern bool flag;
+
+// name -> current value number
+typedef struct {
+    char name[MAX_NAME];
+    int valueNumber;
+    bool used;
+} lvnName;
+
+// expression (op , left value number , right value number) -> value number
+typedef struct {
+    char op[8];
+    int left;
+    int right;
+    int valueNumber;
+    bool used;
+} lvnExpr;
+
+// state of the value numbering for the block being processed
+// (one per thread, blocks are numbered in parallel, see 05_08)
+static _Thread_local lvnName* lvnNames = NULL;
+static _Thread_local int lvnNameCapacity = 0;
+
+static _Thread_local lvnExpr* lvnExprs = NULL;
+static _Thread_local int lvnExprCapacity = 0;
+
+// list of names that were given each value number (in order), used to find a holder
+static _Thread_local int* lvnHolderHead = NULL;   // value number -> first link
+static _Thread_local int* lvnHolderTail = NULL;   // value number -> last link
+static _Thread_local int* lvnLinkNext = NULL;     // link -> next link of the same value number
+static _Thread_local int* lvnLinkName = NULL;     // link -> index into lvnNames
+static _Thread_local int lvnLinkCount = 0;
+
+static _Thread_local int lvnValueCount = 0;
+static _Thread_local int lvnChanges = 0;    // rewrites in the current block
+
+// allocate the tables for a block with n instructions
+static void lvnAllocate(int n){
+    // every instruction introduces at most 3 names and 1 new value
+    int maxNames = 3*n + 4;
+    int maxValues = 4*n + 4;
+
+    lvnNameCapacity = hashTableSize(maxNames);
+    lvnExprCapacity = hashTableSize(n + 1);
+
+    lvnNames = (lvnName*)calloc(lvnNameCapacity , sizeof(lvnName));
+    lvnExprs = (lvnExpr*)calloc(lvnExprCapacity , sizeof(lvnExpr));
+    lvnHolderHead = (int*)malloc(maxValues * sizeof(int));
+    lvnHolderTail = (int*)malloc(maxValues * sizeof(int));
+    lvnLinkNext = (int*)malloc((maxNames + 2*n + 4) * sizeof(int));
+    lvnLinkName = (int*)malloc((maxNames + 2*n + 4) * sizeof(int));
+
+    if(!lvnNames || !lvnExprs || !lvnHolderHead || !lvnHolderTail || !lvnLinkNext || !lvnLinkName){
+        printf("05 || Optimization error [05.09] -> Memory allocation failed for value numbering tables\n");
+        exit(5);
+    }
+
+    for(int i=0 ; i<maxValues ; i++){
+        lvnHolderHead[i] = -1;
+        lvnHolderTail[i] = -1;
+    }
+
+    lvnLinkCount = 0;
+    lvnValueCount = 0;
+}
+
+static void lvnRelease(){
+    free(lvnNames);
+    free(lvnExprs);
+    free(lvnHolderHead);
+    free(lvnHolderTail);
+    free(lvnLinkNext);
+    free(lvnLinkName);
+
+    lvnNames = NULL;
+    lvnExprs = NULL;
+    lvnHolderHead = NULL;
+    lvnHolderTail = NULL;
+    lvnLinkNext = NULL;
+    lvnLinkName = NULL;
+}
+
+// find the slot of a name (either the slot holding it or the empty slot where it goes)
+static int lvnFindNameSlot(char* name){
+    int mask = lvnNameCapacity - 1;
+    int slot = hashString(name) & mask;
+
+    while(lvnNames[slot].used && !isStringSame(lvnNames[slot].name , name)){
+        slot = (slot + 1) & mask; // linear probing
+    }
+
+    return slot;
+}
+
+// record that the name (at slot) now holds value number vn
+static void lvnSetName(int slot , char* name , int vn){
+    if(!lvnNames[slot].used){
+        lvnNames[slot].used = true;
+        strcpy(lvnNames[slot].name , name);
+    }
+    lvnNames[slot].valueNumber = vn;
+
+    // append name to the holder list of vn
+    lvnLinkName[lvnLinkCount] = slot;
+    lvnLinkNext[lvnLinkCount] = -1;
+    if(lvnHolderTail[vn] == -1){
+        lvnHolderHead[vn] = lvnLinkCount;
+    } else{
+        lvnLinkNext[lvnHolderTail[vn]] = lvnLinkCount;
+    }
+    lvnHolderTail[vn] = lvnLinkCount;
+    lvnLinkCount++;
+}
+
+// return value number of a name, giving it a fresh number when seen for the first time
+static int lvnValueOfName(char* name){
+    int slot = lvnFindNameSlot(name);
+
+    if(lvnNames[slot].used) return lvnNames[slot].valueNumber;
+
+    lvnSetName(slot , name , lvnValueCount);
+    return lvnValueCount++;
+}
+
+// assign value number vn to a name (the name is being defined)
+static void lvnAssignName(char* name , int vn){
+    lvnSetName(lvnFindNameSlot(name) , name , vn);
+}
+
+// oldest name that still holds value number vn (NULL if every holder was overwritten)
+static char* lvnHolderOf(int vn){
+    for(int link = lvnHolderHead[vn] ; link != -1 ; link = lvnLinkNext[link]){
+        lvnName* entry = &lvnNames[lvnLinkName[link]];
+        if(entry->valueNumber == vn) return entry->name;
+    }
+    return NULL;
+}
+
+// find the slot of an expression (either the slot holding it or the empty slot where it goes)
+static int lvnFindExprSlot(char* op , int left , int right){
+    int mask = lvnExprCapacity - 1;
+    unsigned int hash = hashString(op);
+    hash = (hash ^ (unsigned int)left) * 16777619u;
+    hash = (hash ^ (unsigned int)right) * 16777619u;
+    int slot = hash & mask;
+
+    while(lvnExprs[slot].used){
+        if(lvnExprs[slot].left == left && lvnExprs[slot].right == right && isStringSame(lvnExprs[slot].op , op)) break;
+        slot = (slot + 1) & mask; // linear probing
+    }
+
+    return slot;
+}
+
+static void lvnInsertExpr(int slot , char* op , int left , int right , int vn){
+    lvnExprs[slot].used = true;
+    strncpy(lvnExprs[slot].op , op , 7);
+    lvnExprs[slot].op[7] = '\0';
+    lvnExprs[slot].left = left;
+    lvnExprs[slot].right = right;
+    lvnExprs[slot].valueNumber = vn;
+}
+
+// value number an operand and rewrite it to the oldest name holding the same value
+// (skipping 'self' so that x = x is never produced)
+static int lvnUseOperand(char* operand , char* self){
+    int vn = lvnValueOfName(operand);
+    char* holder = lvnHolderOf(vn);
+
+    if(holder && !isStringSame(holder , operand) && (self == NULL || !isStringSame(holder , self)) && hasOptimizationFuel()){
+        strcpy(operand , holder);
+        burnOptimizationFuel();
+        lvnChanges++;
+    }
+
+    return vn;
+}
+
+// turn instruction into "result = holder" when the value is already available
+static void lvnReplaceWithCopy(address* addr , char* result , char* holder){
+    char res[MAX_NAME];
+    char src[MAX_NAME];
+    strcpy(res , result);
+    strcpy(src , holder);
+
+    addr->type = ADDR_ASSIGN;
+    strcpy(addr->assign.result , res);
+    strcpy(addr->assign.arg1 , src);
+
+    lvnChanges++;
+}
+
+// result = op(left , right): reuse an existing value or create a new one
+static void lvnDefineExpr(address* addr , char* result , char* op , int left , int right){
+    int slot = lvnFindExprSlot(op , left , right);
+
+    if(lvnExprs[slot].used){
+        int vn = lvnExprs[slot].valueNumber;
+        char* holder = lvnHolderOf(vn);
+
+        if(holder && !isStringSame(holder , result) && hasOptimizationFuel()){
+            lvnReplaceWithCopy(addr , result , holder);
+            burnOptimizationFuel();
+        }
+
+        // value already known, result becomes one more holder of it
+        lvnAssignName(result , vn);
+        return;
+    }
+
+    lvnInsertExpr(slot , op , left , right , lvnValueCount);
+    lvnAssignName(result , lvnValueCount++);
+}
+
+// value numbering of the block at index, returns the number of rewrites
+static int valueNumberBlock(int index){
+    block* currBlock = allBlocks[index];
+    lvnAllocate(currBlock->numberOfAddressesInBlock);
+    lvnChanges = 0;
+
+    // loop through all instructions of the block in order
+    for(int i=0 ; i<currBlock->numberOfAddressesInBlock ; i++){
+        address* addr = currBlock->list[i];
+
+        switch(addr->type){
+            case ADDR_ASSIGN : {
+                // x = y : x now holds the value of y
+                int vn = lvnUseOperand(addr->assign.arg1 , addr->assign.result);
+                lvnAssignName(addr->assign.result , vn);
+                break;
+            }
+
+            case ADDR_BINOP : {
+                int left = lvnUseOperand(addr->binop.arg1 , NULL);
+                int right = lvnUseOperand(addr->binop.arg2 , NULL);
+
+                // canonical order for commutative operators
+                if(isCommutativeOp(addr->binop.op) && left > right){
+                    int swap = left;
+                    left = right;
+                    right = swap;
+                }
+
+                lvnDefineExpr(addr , addr->binop.result , addr->binop.op , left , right);
+                break;
+            }
+
+            case ADDR_UNOP : {
+                int operand = lvnUseOperand(addr->unop.arg1 , NULL);
+                char op[8] = "u";  // keep unary and binary minus apart
+                strncat(op , addr->unop.op , 6);
+                lvnDefineExpr(addr , addr->unop.result , op , operand , -1);
+                break;
+            }
+
+            case ADDR_ARRAY_READ : {
+                // arr[i] is numbered as an expression over (current version of arr , i)
+                int index = lvnUseOperand(addr->array_read.index , NULL);
+                int array = lvnValueOfName(addr->array_read.array);
+                lvnDefineExpr(addr , addr->array_read.result , "[]" , array , index);
+                break;
+            }
+
+            case ADDR_ARRAY_WRITE : {
+                int index = lvnUseOperand(addr->array_write.index , NULL);
+                int value = lvnUseOperand(addr->array_write.value , NULL);
+
+                // every write gives the array a new version, so earlier reads are forgotten
+                lvnAssignName(addr->array_write.array , lvnValueCount++);
+                int array = lvnValueOfName(addr->array_write.array);
+
+                // the written element can be forwarded to later reads of the same index
+                int slot = lvnFindExprSlot("[]" , array , index);
+                lvnInsertExpr(slot , "[]" , array , index , value);
+                break;
+            }
+
+            case ADDR_IF_F_GOTO :
+                lvnUseOperand(addr->if_false.condition , NULL);
+                break;
+
+            case ADDR_IF_T_GOTO :
+                lvnUseOperand(addr->if_true.condition , NULL);
+                break;
+
+            default :
+                break;
+        }
+    }
+
+    lvnRelease();
+    return lvnChanges;
+}
+
+// run local value numbering on every basic block (blocks are independent, see 05_08)
+void checkForLocalValueNumbering(){
+    if(runOnAllBlocks(valueNumberBlock) > 0) flag = true;
+
+    return;
+}
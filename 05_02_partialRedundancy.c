@@ -0,0 +1,793 @@
+/**
+ * 05_02_partialRedundancy.c - Partial Redundancy Elimination (Lazy Code Motion)
+ *
+ * This module removes expressions that are recomputed along some (or all)
+ * paths of the control flow graph. Computations are inserted on the paths
+ * that lack them and the later recomputations become copies of a temporary.
+ *
+ * Features:
+ * - Global CSE (fully redundant expressions across blocks)
+ * - Partially redundant expressions after if/else diamonds
+ * - Loop-invariant expressions moved to the loop entry when the loop body is sure to run
+ * - Critical edges split by new blocks when no existing block can hold the computation
+ *
+ * Algorithm (lazy code motion, edge-based formulation):
+ *   AVAILOUT(b)  = DEEXPR(b) ∪ (AVAILIN(b) - EXPRKILL(b))   AVAILIN  = ∩ AVAILOUT(preds)
+ *   ANTIN(b)     = UEEXPR(b) ∪ (ANTOUT(b) - EXPRKILL(b))    ANTOUT   = ∩ ANTIN(succs)
+ *   EARLIEST(i,j)= ANTIN(j) - AVAILOUT(i) - (ANTOUT(i) - EXPRKILL(i))
+ *   LATER(i,j)   = EARLIEST(i,j) ∪ (LATERIN(i) - UEEXPR(i)) LATERIN  = ∩ LATER(preds)
+ *   INSERT(i,j)  = LATER(i,j) - LATERIN(j)
+ *   DELETE(b)    = UEEXPR(b) - LATERIN(b)
+ *
+ * Every expression that is moved gets one temporary (h). Inserted computations
+ * write h, deleted computations read h, and every other computation that is
+ * still available at the end of its block also copies its result into h.
+ * Copies that turn out to be unnecessary are removed by DCE afterwards.
+ *
+ * Note: the body of a while/for loop may run zero times, so its invariant
+ * expressions are not anticipated before the loop and are not hoisted
+ * (hoisting them could compute values the program never asked for).
+ *
+ * Author: Ridham Khurana
+ */
+
+#include "database.h"
+
+// number of 64-bit words in one expression set
+static int preWords = 0;
+
+typedef unsigned long long preWord;
+
+// one candidate expression: arg1 op arg2 (or op arg1 for unary operations)
+typedef struct {
+    char op[MAX_NAME];
+    char arg1[MAX_NAME];
+    char arg2[MAX_NAME];
+    bool isUnary;
+    char temp[MAX_NAME];   // temporary holding the value (empty until needed)
+} preExpr;
+
+static preExpr* preExprs = NULL;
+static int preExprCount = 0;
+
+// expression key -> expression index (open addressing)
+static int* preExprTable = NULL;
+static int preExprTableSize = 0;
+
+// operand name -> list of expressions that use it (killed when the name is defined)
+typedef struct {
+    char name[MAX_NAME];
+    int head;              // first entry in preUseNext/preUseExpr, -1 if none
+    bool used;
+} preOperand;
+
+static preOperand* preOperands = NULL;
+static int preOperandTableSize = 0;
+static int* preUseNext = NULL;
+static int* preUseExpr = NULL;
+static int preUseCount = 0;
+
+// per-block sets
+static preWord** preUE = NULL;        // upward exposed expressions
+static preWord** preDE = NULL;        // downward exposed expressions
+static preWord** preKill = NULL;      // expressions whose operands are defined in the block
+static preWord** preAvailOut = NULL;
+static preWord** preAntIn = NULL;
+static preWord** preAntOut = NULL;
+static preWord** preLaterIn = NULL;
+
+static bool* preReachable = NULL;
+static bool* preFallsOffEnd = NULL;   // block falls through past the last instruction
+
+// statistics of the last run (shown in the optimization report)
+int pre_replaced_count = 0;
+int pre_inserted_count = 0;
+
+// ----- small bit-set helpers -----
+
+static preWord* preNewSet(bool full){
+    preWord* set = (preWord*)malloc((preWords > 0 ? preWords : 1) * sizeof(preWord));
+    if(set == NULL){
+        printf("05 || Optimization error [05.11] -> Memory allocation failed for partial redundancy sets\n");
+        exit(5);
+    }
+    for(int i=0 ; i<preWords ; i++) set[i] = full ? ~0ULL : 0ULL;
+    return set;
+}
+
+static void preSetBit(preWord* set , int bit){
+    set[bit / 64] |= (1ULL << (bit % 64));
+}
+
+static void preClearBit(preWord* set , int bit){
+    set[bit / 64] &= ~(1ULL << (bit % 64));
+}
+
+static bool preTestBit(preWord* set , int bit){
+    return (set[bit / 64] >> (bit % 64)) & 1ULL;
+}
+
+static void preCopy(preWord* dst , preWord* src){
+    for(int i=0 ; i<preWords ; i++) dst[i] = src[i];
+}
+
+static bool preEqual(preWord* a , preWord* b){
+    for(int i=0 ; i<preWords ; i++){
+        if(a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+// ----- expression universe -----
+
+// fill op/arg1/arg2 of the expression computed by addr (false if addr computes none)
+static bool preExprOf(address* addr , char** op , char** arg1 , char** arg2){
+    if(addr->type == ADDR_BINOP){
+        *op = addr->binop.op;
+        *arg1 = addr->binop.arg1;
+        *arg2 = addr->binop.arg2;
+
+        // canonical order so that a+b and b+a are the same expression
+        if(isCommutativeOp(*op) && strcmp(*arg1 , *arg2) > 0){
+            char* swap = *arg1;
+            *arg1 = *arg2;
+            *arg2 = swap;
+        }
+        return true;
+    } else if(addr->type == ADDR_UNOP){
+        *op = addr->unop.op;
+        *arg1 = addr->unop.arg1;
+        *arg2 = "";
+        return true;
+    }
+    return false;
+}
+
+static unsigned int preHashExpr(char* op , char* arg1 , char* arg2){
+    unsigned int hash = hashString(op);
+    hash = (hash ^ hashString(arg1)) * 16777619u;
+    hash = (hash ^ hashString(arg2)) * 16777619u;
+    return hash;
+}
+
+// slot of the expression in the table (holding it, or empty slot where it goes)
+static int preFindExprSlot(char* op , char* arg1 , char* arg2){
+    int mask = preExprTableSize - 1;
+    int slot = preHashExpr(op , arg1 , arg2) & mask;
+
+    while(preExprTable[slot] != -1){
+        preExpr* e = &preExprs[preExprTable[slot]];
+        if(isStringSame(e->op , op) && isStringSame(e->arg1 , arg1) && isStringSame(e->arg2 , arg2)) break;
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+// expression index of the instruction (-1 if it computes no expression)
+static int preExprIndexOf(address* addr){
+    char *op , *arg1 , *arg2;
+    if(!preExprOf(addr , &op , &arg1 , &arg2)) return -1;
+
+    return preExprTable[preFindExprSlot(op , arg1 , arg2)];
+}
+
+static int preFindOperandSlot(char* name){
+    int mask = preOperandTableSize - 1;
+    int slot = hashString(name) & mask;
+
+    while(preOperands[slot].used && !isStringSame(preOperands[slot].name , name)){
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static void preAddUse(char* name , int exprIndex){
+    if(!isVariable(name)) return; // constants are never killed
+
+    int slot = preFindOperandSlot(name);
+    if(!preOperands[slot].used){
+        preOperands[slot].used = true;
+        strcpy(preOperands[slot].name , name);
+        preOperands[slot].head = -1;
+    }
+
+    preUseExpr[preUseCount] = exprIndex;
+    preUseNext[preUseCount] = preOperands[slot].head;
+    preOperands[slot].head = preUseCount++;
+}
+
+// add all expressions that use the defined name to the set
+static void preKillUsesOf(char* name , preWord* set){
+    if(name == NULL) return;
+
+    int slot = preFindOperandSlot(name);
+    if(!preOperands[slot].used) return;
+
+    for(int use = preOperands[slot].head ; use != -1 ; use = preUseNext[use]){
+        preSetBit(set , preUseExpr[use]);
+    }
+}
+
+// collect every binary/unary expression computed in the program
+static void preCollectExpressions(){
+    int total = countInstructionsInBlocks();
+
+    preExprs = (preExpr*)malloc((total + 1) * sizeof(preExpr));
+    preExprTableSize = hashTableSize(total + 1);
+    preExprTable = (int*)malloc(preExprTableSize * sizeof(int));
+    preOperandTableSize = hashTableSize(2*total + 2);
+    preOperands = (preOperand*)calloc(preOperandTableSize , sizeof(preOperand));
+    preUseNext = (int*)malloc((2*total + 2) * sizeof(int));
+    preUseExpr = (int*)malloc((2*total + 2) * sizeof(int));
+
+    if(!preExprs || !preExprTable || !preOperands || !preUseNext || !preUseExpr){
+        printf("05 || Optimization error [05.11] -> Memory allocation failed for partial redundancy sets\n");
+        exit(5);
+    }
+
+    for(int i=0 ; i<preExprTableSize ; i++) preExprTable[i] = -1;
+    preExprCount = 0;
+    preUseCount = 0;
+
+    // loop through all instructions of all blocks
+    for(int i=0 ; i<block_count ; i++){
+        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
+            char *op , *arg1 , *arg2;
+            if(!preExprOf(allBlocks[i]->list[j] , &op , &arg1 , &arg2)) continue;
+
+            int slot = preFindExprSlot(op , arg1 , arg2);
+            if(preExprTable[slot] != -1) continue; // already known
+
+            preExpr* e = &preExprs[preExprCount];
+            strcpy(e->op , op);
+            strcpy(e->arg1 , arg1);
+            strcpy(e->arg2 , arg2);
+            e->isUnary = (allBlocks[i]->list[j]->type == ADDR_UNOP);
+            e->temp[0] = '\0';
+
+            preAddUse(e->arg1 , preExprCount);
+            if(!e->isUnary) preAddUse(e->arg2 , preExprCount);
+
+            preExprTable[slot] = preExprCount++;
+        }
+    }
+
+    preWords = (preExprCount + 63) / 64;
+}
+
+// name defined by the instruction (scalar definitions only)
+static char* preDefinedName(address* addr){
+    if(addr->type == ADDR_ARRAY_WRITE) return NULL;
+    return getLeftSideOfKindOfAssign(addr);
+}
+
+// ----- local and global sets -----
+
+static void preComputeLocalSets(){
+    for(int i=0 ; i<block_count ; i++){
+        block* b = allBlocks[i];
+        preUE[i] = preNewSet(false);
+        preDE[i] = preNewSet(false);
+        preKill[i] = preNewSet(false);
+
+        // forward scan: upward exposed expressions and kill set
+        for(int j=0 ; j<b->numberOfAddressesInBlock ; j++){
+            int e = preExprIndexOf(b->list[j]);
+            if(e != -1 && !preTestBit(preKill[i] , e)) preSetBit(preUE[i] , e);
+
+            preKillUsesOf(preDefinedName(b->list[j]) , preKill[i]);
+        }
+
+        // backward scan: downward exposed expressions
+        preWord* killedAfter = preNewSet(false);
+        for(int j=b->numberOfAddressesInBlock-1 ; j>=0 ; j--){
+            preKillUsesOf(preDefinedName(b->list[j]) , killedAfter);
+
+            int e = preExprIndexOf(b->list[j]);
+            if(e != -1 && !preTestBit(killedAfter , e)) preSetBit(preDE[i] , e);
+        }
+        free(killedAfter);
+    }
+}
+
+static void preFindReachableBlocks(){
+    int* stack = (int*)malloc((block_count + 1) * sizeof(int));
+    int top = 0;
+
+    for(int i=0 ; i<block_count ; i++) preReachable[i] = false;
+    if(block_count == 0){
+        free(stack);
+        return;
+    }
+
+    preReachable[0] = true;
+    stack[top++] = 0;
+    while(top > 0){
+        block* b = allBlocks[stack[--top]];
+        for(int k=0 ; k<b->numCFGOut ; k++){
+            int succ = findIndexOfBlock(b->cfg_out[k]);
+            if(preReachable[succ]) continue;
+            preReachable[succ] = true;
+            stack[top++] = succ;
+        }
+    }
+
+    free(stack);
+}
+
+// EARLIEST(i,j) bit for expression word w (i == -1 means the virtual entry)
+static preWord preEarliestWord(int i , int j , int w){
+    if(i == -1) return preAntIn[j][w];
+
+    return preAntIn[j][w] & ~preAvailOut[i][w] & (preKill[i][w] | ~preAntOut[i][w]);
+}
+
+// LATER(i,j) for expression word w
+static preWord preLaterWord(int i , int j , int w){
+    if(i == -1) return preEarliestWord(-1 , j , w);
+
+    return preEarliestWord(i , j , w) | (preLaterIn[i][w] & ~preUE[i][w]);
+}
+
+static void preSolveDataflow(){
+    preWord* temp = preNewSet(false);
+    bool changed = true;
+
+    // availability (forward, intersection) - block 0 is entered from the virtual entry
+    for(int i=0 ; i<block_count ; i++) preAvailOut[i] = preNewSet(true);
+    while(changed){
+        changed = false;
+        for(int i=0 ; i<block_count ; i++){
+            if(!preReachable[i]) continue;
+
+            for(int w=0 ; w<preWords ; w++) temp[w] = (i == 0) ? 0ULL : ~0ULL;
+            for(int k=0 ; k<allBlocks[i]->numCFGIn ; k++){
+                int pred = findIndexOfBlock(allBlocks[i]->cfg_in[k]);
+                if(!preReachable[pred]) continue;
+                for(int w=0 ; w<preWords ; w++) temp[w] &= preAvailOut[pred][w];
+            }
+
+            // AVAILOUT = DE ∪ (AVAILIN - KILL)
+            for(int w=0 ; w<preWords ; w++) temp[w] = preDE[i][w] | (temp[w] & ~preKill[i][w]);
+            if(!preEqual(temp , preAvailOut[i])){
+                preCopy(preAvailOut[i] , temp);
+                changed = true;
+            }
+        }
+    }
+
+    // anticipability (backward, intersection) - a block falling off the end reaches the exit
+    for(int i=0 ; i<block_count ; i++){
+        preAntIn[i] = preNewSet(true);
+        preAntOut[i] = preNewSet(true);
+    }
+    changed = true;
+    while(changed){
+        changed = false;
+        for(int i=block_count-1 ; i>=0 ; i--){
+            if(!preReachable[i]) continue;
+
+            for(int w=0 ; w<preWords ; w++) temp[w] = (preFallsOffEnd[i] || allBlocks[i]->numCFGOut == 0) ? 0ULL : ~0ULL;
+            for(int k=0 ; k<allBlocks[i]->numCFGOut ; k++){
+                int succ = findIndexOfBlock(allBlocks[i]->cfg_out[k]);
+                for(int w=0 ; w<preWords ; w++) temp[w] &= preAntIn[succ][w];
+            }
+            preCopy(preAntOut[i] , temp);
+
+            // ANTIN = UE ∪ (ANTOUT - KILL)
+            for(int w=0 ; w<preWords ; w++) temp[w] = preUE[i][w] | (preAntOut[i][w] & ~preKill[i][w]);
+            if(!preEqual(temp , preAntIn[i])){
+                preCopy(preAntIn[i] , temp);
+                changed = true;
+            }
+        }
+    }
+
+    // later (forward, intersection over incoming edges)
+    for(int i=0 ; i<block_count ; i++) preLaterIn[i] = preNewSet(true);
+    changed = true;
+    while(changed){
+        changed = false;
+        for(int i=0 ; i<block_count ; i++){
+            if(!preReachable[i]) continue;
+
+            for(int w=0 ; w<preWords ; w++) temp[w] = (i == 0) ? preLaterWord(-1 , 0 , w) : ~0ULL;
+            for(int k=0 ; k<allBlocks[i]->numCFGIn ; k++){
+                int pred = findIndexOfBlock(allBlocks[i]->cfg_in[k]);
+                if(!preReachable[pred]) continue;
+                for(int w=0 ; w<preWords ; w++) temp[w] &= preLaterWord(pred , i , w);
+            }
+
+            if(!preEqual(temp , preLaterIn[i])){
+                preCopy(preLaterIn[i] , temp);
+                changed = true;
+            }
+        }
+    }
+
+    free(temp);
+}
+
+// ----- transformation -----
+
+// temporary that carries the value of expression e (created on first use)
+static char* preTempOf(int e){
+    if(preExprs[e].temp[0] == '\0'){
+        char* name = generateNewAddrResult();
+        strcpy(preExprs[e].temp , name);
+        free(name);
+    }
+    return preExprs[e].temp;
+}
+
+// build "h = arg1 op arg2" for expression e
+static address* preBuildComputation(int e){
+    preExpr* expr = &preExprs[e];
+    address* addr;
+
+    if(expr->isUnary){
+        addr = generateOptimizerAddress(ADDR_UNOP);
+        strcpy(addr->unop.result , preTempOf(e));
+        strcpy(addr->unop.op , expr->op);
+        strcpy(addr->unop.arg1 , expr->arg1);
+    } else{
+        addr = generateOptimizerAddress(ADDR_BINOP);
+        strcpy(addr->binop.result , preTempOf(e));
+        strcpy(addr->binop.arg1 , expr->arg1);
+        strcpy(addr->binop.op , expr->op);
+        strcpy(addr->binop.arg2 , expr->arg2);
+    }
+
+    return addr;
+}
+
+static address* preBuildCopy(char* result , char* arg1){
+    address* addr = generateOptimizerAddress(ADDR_ASSIGN);
+    strcpy(addr->assign.result , result);
+    strcpy(addr->assign.arg1 , arg1);
+    return addr;
+}
+
+static bool isJumpAddress(address* addr){
+    return addr->type == ADDR_GOTO || addr->type == ADDR_IF_F_GOTO || addr->type == ADDR_IF_T_GOTO;
+}
+
+// position after the leading labels of a block
+static int preStartPosition(block* b){
+    int pos = 0;
+    while(pos < b->numberOfAddressesInBlock && b->list[pos]->type == ADDR_LABEL) pos++;
+    return pos;
+}
+
+// position before the trailing jump of a block
+static int preEndPosition(block* b){
+    int pos = b->numberOfAddressesInBlock;
+    if(pos > 0 && isJumpAddress(b->list[pos-1])) pos--;
+    return pos;
+}
+
+// number of different successors of a block
+static int preDistinctSuccessors(block* b){
+    int count = 0;
+    for(int i=0 ; i<b->numCFGOut ; i++){
+        bool seen = false;
+        for(int k=0 ; k<i ; k++){
+            if(b->cfg_out[k] == b->cfg_out[i]) seen = true;
+        }
+        if(!seen) count++;
+    }
+    return count;
+}
+
+// label of a block (adds one when the block has none)
+static char* preLabelOf(block* b){
+    if(b->numberOfAddressesInBlock > 0 && b->list[0]->type == ADDR_LABEL) return b->list[0]->label.labelNumber;
+
+    address* label = generateOptimizerAddress(ADDR_LABEL);
+    char* name = generateNewAddrLabel();
+    strcpy(label->label.labelNumber , name);
+    free(name);
+    insertAddressIntoBlock(b , 0 , label);
+    return label->label.labelNumber;
+}
+
+// blocks placed after the program end need a jump over them for the fall-through exit
+static char preExitLabel[MAX_NAME];
+static block* preExitBlock = NULL;
+
+static block* preSplitEdge(block* from , block* to){
+    block* split = generateEmptyBlock();
+    int fromIndex = findIndexOfBlock(from);
+
+    if(fromIndex + 1 < block_count && allBlocks[fromIndex+1] == to && !(from->numberOfAddressesInBlock > 0 && from->list[from->numberOfAddressesInBlock-1]->type == ADDR_GOTO)){
+        // fall-through edge: the new block sits between the two blocks
+        insertBlockAt(fromIndex + 1 , split);
+        replaceCFGEdge(from , to , split);
+        addCFGEdge(split , to);
+        return split;
+    }
+
+    // jump edge: the new block is placed after the program end and jumps back to 'to'
+    if(preExitBlock == NULL){
+        block* last = allBlocks[block_count-1];
+        bool lastJumps = last->numberOfAddressesInBlock > 0 && last->list[last->numberOfAddressesInBlock-1]->type == ADDR_GOTO;
+
+        char* name = generateNewAddrLabel();
+        strcpy(preExitLabel , name);
+        free(name);
+
+        if(!lastJumps){
+            // the old last block now has to jump over the split blocks
+            block* jump = generateEmptyBlock();
+            address* go = generateOptimizerAddress(ADDR_GOTO);
+            strcpy(go->goto_stmt.target , preExitLabel);
+            insertAddressIntoBlock(jump , 0 , go);
+            insertBlockAt(block_count , jump);
+            addCFGEdge(last , jump);
+        }
+
+        preExitBlock = generateEmptyBlock();
+        address* label = generateOptimizerAddress(ADDR_LABEL);
+        strcpy(label->label.labelNumber , preExitLabel);
+        insertAddressIntoBlock(preExitBlock , 0 , label);
+        insertBlockAt(block_count , preExitBlock);
+
+        if(!lastJumps) addCFGEdge(allBlocks[block_count-2] , preExitBlock);
+    }
+
+    char* target = preLabelOf(to);
+    address* label = generateOptimizerAddress(ADDR_LABEL);
+    char* name = generateNewAddrLabel();
+    strcpy(label->label.labelNumber , name);
+    free(name);
+    insertAddressIntoBlock(split , 0 , label);
+
+    address* go = generateOptimizerAddress(ADDR_GOTO);
+    strcpy(go->goto_stmt.target , target);
+    insertAddressIntoBlock(split , 1 , go);
+
+    // retarget the jump of 'from'
+    address* jump = from->list[from->numberOfAddressesInBlock-1];
+    if(jump->type == ADDR_GOTO) strcpy(jump->goto_stmt.target , label->label.labelNumber);
+    else if(jump->type == ADDR_IF_F_GOTO) strcpy(jump->if_false.target , label->label.labelNumber);
+    else if(jump->type == ADDR_IF_T_GOTO) strcpy(jump->if_true.target , label->label.labelNumber);
+
+    insertBlockAt(findIndexOfBlock(preExitBlock) , split);
+    replaceCFGEdge(from , to , split);
+    addCFGEdge(split , to);
+    return split;
+}
+
+// insert the computations of 'set' on edge from->to (from == NULL is the virtual entry)
+static void preInsertOnEdge(block* from , block* to , preWord* set){
+    block* where;
+    int pos;
+
+    if(from != NULL && preDistinctSuccessors(from) == 1){
+        where = from;
+        pos = preEndPosition(from);
+    } else if(from != NULL && to->numCFGIn == 1){
+        where = to;
+        pos = preStartPosition(to);
+    } else if(from == NULL && to->numCFGIn == 0){
+        where = to;
+        pos = preStartPosition(to);
+    } else if(from == NULL){
+        // entry block is a loop header: add a fresh first block in front of it
+        where = generateEmptyBlock();
+        insertBlockAt(0 , where);
+        addCFGEdge(where , to);
+        pos = 0;
+    } else{
+        where = preSplitEdge(from , to);
+        pos = preStartPosition(where);
+    }
+
+    for(int e=0 ; e<preExprCount ; e++){
+        if(!preTestBit(set , e)) continue;
+
+        insertAddressIntoBlock(where , pos++ , preBuildComputation(e));
+        pre_inserted_count++;
+    }
+}
+
+static void preRewrite(){
+    int originalCount = block_count;
+    block** original = (block**)malloc((originalCount + 1) * sizeof(block*));
+    preWord** deleteSet = (preWord**)malloc((originalCount + 1) * sizeof(preWord*));
+    preWord* used = preNewSet(false);
+
+    for(int i=0 ; i<originalCount ; i++) original[i] = allBlocks[i];
+
+    // DELETE(b) = UE(b) - LATERIN(b)
+    for(int i=0 ; i<originalCount ; i++){
+        deleteSet[i] = preNewSet(false);
+        if(!preReachable[i]) continue;
+        for(int w=0 ; w<preWords ; w++){
+            deleteSet[i][w] = preUE[i][w] & ~preLaterIn[i][w];
+            used[w] |= deleteSet[i][w];
+        }
+    }
+
+    // each moved expression is one transformation of the optimization budget;
+    // an expression without fuel is left completely untouched (no insertion, no copy, no deletion)
+    for(int e=0 ; e<preExprCount ; e++){
+        if(!preTestBit(used , e)) continue;
+        if(hasOptimizationFuel()){
+            burnOptimizationFuel();
+            continue;
+        }
+        preClearBit(used , e);
+        for(int i=0 ; i<originalCount ; i++) preClearBit(deleteSet[i] , e);
+    }
+
+    // nothing is redundant: keep the program as it is
+    bool anything = false;
+    for(int w=0 ; w<preWords ; w++) if(used[w]) anything = true;
+    if(!anything){
+        for(int i=0 ; i<originalCount ; i++) free(deleteSet[i]);
+        free(deleteSet);
+        free(original);
+        free(used);
+        return;
+    }
+
+    // collect the edges that need insertions before the CFG is changed
+    int edgeCapacity = 1;
+    for(int i=0 ; i<originalCount ; i++) edgeCapacity += original[i]->numCFGOut;
+    block** edgeFrom = (block**)malloc(edgeCapacity * sizeof(block*));
+    block** edgeTo = (block**)malloc(edgeCapacity * sizeof(block*));
+    preWord** edgeSet = (preWord**)malloc(edgeCapacity * sizeof(preWord*));
+    int edgeCount = 0;
+
+    for(int j=0 ; j<originalCount ; j++){
+        if(!preReachable[j]) continue;
+
+        // incoming edges of j, plus the virtual entry edge for block 0
+        for(int k=(j == 0 ? -1 : 0) ; k<original[j]->numCFGIn ; k++){
+            int i = (k == -1) ? -1 : findIndexOfBlock(original[j]->cfg_in[k]);
+            if(i != -1 && !preReachable[i]) continue;
+
+            preWord* set = preNewSet(false);
+            bool any = false;
+            for(int w=0 ; w<preWords ; w++){
+                // INSERT(i,j) = LATER(i,j) - LATERIN(j), only for expressions that are deleted somewhere
+                set[w] = preLaterWord(i , j , w) & ~preLaterIn[j][w] & used[w];
+                if(set[w]) any = true;
+            }
+            if(!any){
+                free(set);
+                continue;
+            }
+
+            edgeFrom[edgeCount] = (i == -1) ? NULL : original[i];
+            edgeTo[edgeCount] = original[j];
+            edgeSet[edgeCount++] = set;
+        }
+    }
+
+    // rewrite the original computations
+    for(int i=0 ; i<originalCount ; i++){
+        block* b = original[i];
+        bool* deleted = (bool*)calloc(preExprCount + 1 , sizeof(bool));
+        preWord* killedAfter = preNewSet(false);
+
+        // the first upward exposed computation of a deleted expression reads h
+        preWord* killedBefore = preNewSet(false);
+        for(int j=0 ; j<b->numberOfAddressesInBlock ; j++){
+            address* addr = b->list[j];
+            int e = preExprIndexOf(addr);
+
+            if(e != -1 && !preTestBit(killedBefore , e) && preTestBit(deleteSet[i] , e) && !deleted[e]){
+                char result[MAX_NAME];
+                strcpy(result , getLeftSideOfKindOfAssign(addr));
+                addr->type = ADDR_ASSIGN;
+                strcpy(addr->assign.result , result);
+                strcpy(addr->assign.arg1 , preTempOf(e));
+                deleted[e] = true;
+                pre_replaced_count++;
+            }
+
+            preKillUsesOf(preDefinedName(addr) , killedBefore);
+        }
+
+        // every downward exposed computation that was kept also copies its value into h
+        for(int j=b->numberOfAddressesInBlock-1 ; j>=0 ; j--){
+            address* addr = b->list[j];
+            preKillUsesOf(preDefinedName(addr) , killedAfter);
+
+            int e = preExprIndexOf(addr);
+            if(e == -1 || preTestBit(killedAfter , e) || !preTestBit(used , e)) continue;
+
+            insertAddressIntoBlock(b , j + 1 , preBuildCopy(preTempOf(e) , getLeftSideOfKindOfAssign(addr)));
+        }
+
+        free(killedBefore);
+        free(killedAfter);
+        free(deleted);
+    }
+
+    // insert the computations on the edges
+    for(int k=0 ; k<edgeCount ; k++){
+        preInsertOnEdge(edgeFrom[k] , edgeTo[k] , edgeSet[k]);
+        free(edgeSet[k]);
+    }
+
+    for(int i=0 ; i<originalCount ; i++) free(deleteSet[i]);
+    free(deleteSet);
+    free(edgeFrom);
+    free(edgeTo);
+    free(edgeSet);
+    free(original);
+    free(used);
+
+    // the linear code follows the new block order
+    rebuildAddressListFromBlocks();
+}
+
+static void preRelease(int count){
+    for(int i=0 ; i<count ; i++){
+        free(preUE[i]);
+        free(preDE[i]);
+        free(preKill[i]);
+        free(preAvailOut[i]);
+        free(preAntIn[i]);
+        free(preAntOut[i]);
+        free(preLaterIn[i]);
+    }
+
+    free(preUE);
+    free(preDE);
+    free(preKill);
+    free(preAvailOut);
+    free(preAntIn);
+    free(preAntOut);
+    free(preLaterIn);
+    free(preReachable);
+    free(preFallsOffEnd);
+    free(preExprs);
+    free(preExprTable);
+    free(preOperands);
+    free(preUseNext);
+    free(preUseExpr);
+}
+
+// run lazy code motion over the whole CFG
+void startPartialRedundancyPhase(){
+    pre_replaced_count = 0;
+    pre_inserted_count = 0;
+    preExitBlock = NULL;
+
+    if(block_count == 0) return;
+
+    preCollectExpressions();
+
+    int count = block_count;
+    preUE = (preWord**)malloc(count * sizeof(preWord*));
+    preDE = (preWord**)malloc(count * sizeof(preWord*));
+    preKill = (preWord**)malloc(count * sizeof(preWord*));
+    preAvailOut = (preWord**)malloc(count * sizeof(preWord*));
+    preAntIn = (preWord**)malloc(count * sizeof(preWord*));
+    preAntOut = (preWord**)malloc(count * sizeof(preWord*));
+    preLaterIn = (preWord**)malloc(count * sizeof(preWord*));
+    preReachable = (bool*)malloc(count * sizeof(bool));
+    preFallsOffEnd = (bool*)calloc(count , sizeof(bool));
+
+    if(!preUE || !preDE || !preKill || !preAvailOut || !preAntIn || !preAntOut || !preLaterIn || !preReachable || !preFallsOffEnd){
+        printf("05 || Optimization error [05.11] -> Memory allocation failed for partial redundancy sets\n");
+        exit(5);
+    }
+
+    // the last block reaches the program exit unless it ends with an unconditional jump
+    block* last = allBlocks[count-1];
+    preFallsOffEnd[count-1] = !(last->numberOfAddressesInBlock > 0 && last->list[last->numberOfAddressesInBlock-1]->type == ADDR_GOTO);
+
+    preFindReachableBlocks();
+    preComputeLocalSets();
+    preSolveDataflow();
+    preRewrite();
+
+    preRelease(count);
+}
@@ -0,0 +1,363 @@
+/**
+ * 05_03_algebraicSimplification.c - Algebraic Simplification and Strength Reduction
+ *
+ * This module rewrites arithmetic and logical instructions using algebraic
+ * identities. The identities are kept in a rule table: each rule names the
+ * operator, what the left and right operands must look like, and what the
+ * instruction becomes. It runs inside the fixpoint loop of the reaching
+ * definition phase, so the constants found by propagation feed the rules.
+ *
+ * Features:
+ * - Identities: x+0, x-0, x*1, x/1, x*0, x-x, x==x, b&&true, b||false, ...
+ * - Boolean simplification: b==true -> b, b==false -> !b, !!b -> b
+ * - Strength reduction: x * 2^k -> x << k
+ * - Reassociation of constants: (x+c1)+c2 -> x+(c1+c2), (x*c1)*c2 -> x*(c1*c2)
+ * - Rules that are not exact for doubles are applied to int operands only
+ *
+ * Division by 2^k is strength reduced at instruction selection (06_01),
+ * because truncating signed division needs a rounding fix-up that TAC
+ * cannot express in a single instruction.
+ *
+ * Author: Ridham Khurana
+ */
+
+#include "database.h"
+
+// set by every optimization that changes an instruction (05_optimization.c)
+extern bool flag;
+
+// what an operand has to look like for a rule to match
+typedef enum {
+    PAT_ANY,        // any operand
+    PAT_ZERO,       // integer constant 0
+    PAT_ONE,        // integer constant 1
+    PAT_TRUE,       // true
+    PAT_FALSE,      // false
+    PAT_POW2,       // integer constant 2^k with k >= 1
+    PAT_INT_CONST   // any integer constant
+} operandPattern;
+
+// what the instruction becomes when a rule matches
+typedef enum {
+    ACT_COPY_LEFT,       // result = left
+    ACT_COPY_RIGHT,      // result = right
+    ACT_ZERO,            // result = 0
+    ACT_TRUE,            // result = true
+    ACT_FALSE,           // result = false
+    ACT_NOT_LEFT,        // result = ! left
+    ACT_NOT_RIGHT,       // result = ! right
+    ACT_SHIFT_LEFT,      // result = left << log2(right)
+    ACT_SHIFT_RIGHT,     // result = right << log2(left)
+    ACT_REASSOCIATE      // result = x op (c1 op' c2) when left is x op' c1
+} simplifyAction;
+
+// which operand types a rule is valid for
+typedef enum {
+    TYPES_ANY,           // exact for every type
+    TYPES_INT,           // both operands must be int
+    TYPES_INT_BOOL_CHAR, // not valid for doubles (NaN)
+    TYPES_BOOL           // both operands must be bool
+} operandTypes;
+
+typedef struct {
+    char* op;
+    operandPattern left;
+    operandPattern right;
+    bool sameOperands;   // left and right must be the same name
+    operandTypes types;
+    simplifyAction action;
+} simplifyRule;
+
+static const simplifyRule simplifyRules[] = {
+    // additive identities
+    { "+" , PAT_ANY , PAT_ZERO , false , TYPES_INT , ACT_COPY_LEFT },
+    { "+" , PAT_ZERO , PAT_ANY , false , TYPES_INT , ACT_COPY_RIGHT },
+    { "-" , PAT_ANY , PAT_ZERO , false , TYPES_ANY , ACT_COPY_LEFT },
+    { "-" , PAT_ANY , PAT_ANY , true , TYPES_INT , ACT_ZERO },
+
+    // multiplicative identities
+    { "*" , PAT_ANY , PAT_ONE , false , TYPES_ANY , ACT_COPY_LEFT },
+    { "*" , PAT_ONE , PAT_ANY , false , TYPES_ANY , ACT_COPY_RIGHT },
+    { "*" , PAT_ANY , PAT_ZERO , false , TYPES_INT , ACT_ZERO },
+    { "*" , PAT_ZERO , PAT_ANY , false , TYPES_INT , ACT_ZERO },
+    { "/" , PAT_ANY , PAT_ONE , false , TYPES_ANY , ACT_COPY_LEFT },
+
+    // constant reassociation (before strength reduction so x*2*4 becomes x*8 first)
+    { "+" , PAT_ANY , PAT_INT_CONST , false , TYPES_INT , ACT_REASSOCIATE },
+    { "-" , PAT_ANY , PAT_INT_CONST , false , TYPES_INT , ACT_REASSOCIATE },
+    { "*" , PAT_ANY , PAT_INT_CONST , false , TYPES_INT , ACT_REASSOCIATE },
+
+    // strength reduction
+    { "*" , PAT_ANY , PAT_POW2 , false , TYPES_INT , ACT_SHIFT_LEFT },
+    { "*" , PAT_POW2 , PAT_ANY , false , TYPES_INT , ACT_SHIFT_RIGHT },
+
+    // comparison of a value with itself
+    { "==" , PAT_ANY , PAT_ANY , true , TYPES_INT_BOOL_CHAR , ACT_TRUE },
+    { "<=" , PAT_ANY , PAT_ANY , true , TYPES_INT_BOOL_CHAR , ACT_TRUE },
+    { ">=" , PAT_ANY , PAT_ANY , true , TYPES_INT_BOOL_CHAR , ACT_TRUE },
+    { "!=" , PAT_ANY , PAT_ANY , true , TYPES_INT_BOOL_CHAR , ACT_FALSE },
+    { "<" , PAT_ANY , PAT_ANY , true , TYPES_INT_BOOL_CHAR , ACT_FALSE },
+    { ">" , PAT_ANY , PAT_ANY , true , TYPES_INT_BOOL_CHAR , ACT_FALSE },
+
+    // comparison of a bool with a bool constant
+    { "==" , PAT_ANY , PAT_TRUE , false , TYPES_BOOL , ACT_COPY_LEFT },
+    { "==" , PAT_TRUE , PAT_ANY , false , TYPES_BOOL , ACT_COPY_RIGHT },
+    { "==" , PAT_ANY , PAT_FALSE , false , TYPES_BOOL , ACT_NOT_LEFT },
+    { "==" , PAT_FALSE , PAT_ANY , false , TYPES_BOOL , ACT_NOT_RIGHT },
+    { "!=" , PAT_ANY , PAT_FALSE , false , TYPES_BOOL , ACT_COPY_LEFT },
+    { "!=" , PAT_FALSE , PAT_ANY , false , TYPES_BOOL , ACT_COPY_RIGHT },
+    { "!=" , PAT_ANY , PAT_TRUE , false , TYPES_BOOL , ACT_NOT_LEFT },
+    { "!=" , PAT_TRUE , PAT_ANY , false , TYPES_BOOL , ACT_NOT_RIGHT },
+
+    // logical identities
+    { "&&" , PAT_ANY , PAT_TRUE , false , TYPES_ANY , ACT_COPY_LEFT },
+    { "&&" , PAT_TRUE , PAT_ANY , false , TYPES_ANY , ACT_COPY_RIGHT },
+    { "&&" , PAT_ANY , PAT_FALSE , false , TYPES_ANY , ACT_FALSE },
+    { "&&" , PAT_FALSE , PAT_ANY , false , TYPES_ANY , ACT_FALSE },
+    { "&&" , PAT_ANY , PAT_ANY , true , TYPES_ANY , ACT_COPY_LEFT },
+    { "||" , PAT_ANY , PAT_FALSE , false , TYPES_ANY , ACT_COPY_LEFT },
+    { "||" , PAT_FALSE , PAT_ANY , false , TYPES_ANY , ACT_COPY_RIGHT },
+    { "||" , PAT_ANY , PAT_TRUE , false , TYPES_ANY , ACT_TRUE },
+    { "||" , PAT_TRUE , PAT_ANY , false , TYPES_ANY , ACT_TRUE },
+    { "||" , PAT_ANY , PAT_ANY , true , TYPES_ANY , ACT_COPY_LEFT },
+};
+
+static const int simplifyRuleCount = sizeof(simplifyRules) / sizeof(simplifyRules[0]);
+
+// log2 of a positive power of two, -1 if the constant is not one
+static int powerOfTwoExponent(char* str){
+    if(!isInteger(str)) return -1;
+
+    long long value = atoll(str);
+    if(value < 2 || (value & (value - 1)) != 0) return -1;
+
+    int exponent = 0;
+    while(value > 1){
+        value >>= 1;
+        exponent++;
+    }
+    return exponent;
+}
+
+static bool matchesPattern(char* operand , operandPattern pattern){
+    switch(pattern){
+        case PAT_ANY : return true;
+        case PAT_ZERO : return isInteger(operand) && atoll(operand) == 0;
+        case PAT_ONE : return isInteger(operand) && atoll(operand) == 1;
+        case PAT_TRUE : return isStringSame(operand , "true");
+        case PAT_FALSE : return isStringSame(operand , "false");
+        case PAT_POW2 : return powerOfTwoExponent(operand) != -1;
+        case PAT_INT_CONST : return isInteger(operand);
+    }
+    return false;
+}
+
+static bool matchesTypes(address* addr , operandTypes types){
+    switch(types){
+        case TYPES_ANY :
+            return true;
+
+        case TYPES_INT :
+            return getTypeOfOperand(addr->binop.arg1) == KEYWORD_INT && getTypeOfOperand(addr->binop.arg2) == KEYWORD_INT;
+
+        case TYPES_INT_BOOL_CHAR : {
+            tokenType type = getTypeOfOperand(addr->binop.arg1);
+            return type == KEYWORD_INT || type == KEYWORD_BOOL || type == KEYWORD_CHAR;
+        }
+
+        case TYPES_BOOL :
+            return getTypeOfOperand(addr->binop.arg1) == KEYWORD_BOOL && getTypeOfOperand(addr->binop.arg2) == KEYWORD_BOOL;
+    }
+    return false;
+}
+
+// index of the instruction before 'position' in the block that last defines 'name' (-1 if none)
+static int findLocalDefinition(block* currBlock , int position , char* name){
+    for(int k=position-1 ; k>=0 ; k--){
+        address* addr = currBlock->list[k];
+        if(addr->type == ADDR_ARRAY_WRITE) continue;
+
+        char* left = getLeftSideOfKindOfAssign(addr);
+        if(left && isStringSame(left , name)) return k;
+    }
+    return -1;
+}
+
+// true if 'name' is defined by an instruction between from (exclusive) and to (exclusive)
+static bool isRedefinedBetween(block* currBlock , int from , int to , char* name){
+    for(int k=from+1 ; k<to ; k++){
+        address* addr = currBlock->list[k];
+        if(addr->type == ADDR_ARRAY_WRITE) continue;
+
+        char* left = getLeftSideOfKindOfAssign(addr);
+        if(left && isStringSame(left , name)) return true;
+    }
+    return false;
+}
+
+static void rewriteToAssign(address* addr , char* value){
+    char result[MAX_NAME];
+    char arg1[MAX_NAME];
+    strcpy(result , addr->binop.result);
+    strcpy(arg1 , value);
+
+    addr->type = ADDR_ASSIGN;
+    strcpy(addr->assign.result , result);
+    strcpy(addr->assign.arg1 , arg1);
+}
+
+static void rewriteToNot(address* addr , char* value){
+    char result[MAX_NAME];
+    char arg1[MAX_NAME];
+    strcpy(result , addr->binop.result);
+    strcpy(arg1 , value);
+
+    addr->type = ADDR_UNOP;
+    strcpy(addr->unop.result , result);
+    strcpy(addr->unop.op , "!");
+    strcpy(addr->unop.arg1 , arg1);
+}
+
+static void rewriteToShift(address* addr , char* value , int exponent){
+    char arg1[MAX_NAME];
+    strcpy(arg1 , value);
+
+    strcpy(addr->binop.arg1 , arg1);
+    strcpy(addr->binop.op , "<<");
+    sprintf(addr->binop.arg2 , "%d" , exponent);
+}
+
+// (x op1 c1) op2 c2 -> x op c, where x op1 c1 is computed earlier in the same block
+static bool reassociateConstants(block* currBlock , int position){
+    address* addr = currBlock->list[position];
+    char* op2 = addr->binop.op;
+
+    int k = findLocalDefinition(currBlock , position , addr->binop.arg1);
+    if(k == -1 || currBlock->list[k]->type != ADDR_BINOP) return false;
+
+    address* inner = currBlock->list[k];
+    char* op1 = inner->binop.op;
+    if(!isInteger(inner->binop.arg2) || getTypeOfOperand(inner->binop.arg1) != KEYWORD_INT) return false;
+    if(isRedefinedBetween(currBlock , k , position , inner->binop.arg1)) return false;
+    if(isStringSame(inner->binop.arg1 , inner->binop.result)) return false;
+
+    long long c1 = atoll(inner->binop.arg2);
+    long long c2 = atoll(addr->binop.arg2);
+    long long c;
+    char op[MAX_NAME];
+
+    if((isStringSame(op1 , "+") || isStringSame(op1 , "-")) && (isStringSame(op2 , "+") || isStringSame(op2 , "-"))){
+        // x + c1 - c2 = x + (c1 - c2) ...
+        c = (isStringSame(op1 , "+") ? c1 : -c1) + (isStringSame(op2 , "+") ? c2 : -c2);
+        strcpy(op , c < 0 ? "-" : "+");
+        if(c < 0) c = -c;
+    } else if(isStringSame(op1 , "*") && isStringSame(op2 , "*")){
+        c = c1 * c2;
+        strcpy(op , "*");
+    } else if(isStringSame(op1 , "<<") && isStringSame(op2 , "*") && c1 >= 0 && c1 < 31){
+        // x << k was x * 2^k before strength reduction
+        c = (1LL << c1) * c2;
+        strcpy(op , "*");
+    } else{
+        return false;
+    }
+
+    // results are 32-bit ints in the front end, keep the folded constant in range
+    if(c > 2147483647LL || c < -2147483647LL) return false;
+
+    char x[MAX_NAME];
+    strcpy(x , inner->binop.arg1);
+    strcpy(addr->binop.arg1 , x);
+    strcpy(addr->binop.op , op);
+    sprintf(addr->binop.arg2 , "%lld" , c);
+    return true;
+}
+
+static bool applyRule(block* currBlock , int position , const simplifyRule* rule){
+    address* addr = currBlock->list[position];
+
+    switch(rule->action){
+        case ACT_COPY_LEFT : rewriteToAssign(addr , addr->binop.arg1); return true;
+        case ACT_COPY_RIGHT : rewriteToAssign(addr , addr->binop.arg2); return true;
+        case ACT_ZERO : rewriteToAssign(addr , "0"); return true;
+        case ACT_TRUE : rewriteToAssign(addr , "true"); return true;
+        case ACT_FALSE : rewriteToAssign(addr , "false"); return true;
+        case ACT_NOT_LEFT : rewriteToNot(addr , addr->binop.arg1); return true;
+        case ACT_NOT_RIGHT : rewriteToNot(addr , addr->binop.arg2); return true;
+        case ACT_SHIFT_LEFT : rewriteToShift(addr , addr->binop.arg1 , powerOfTwoExponent(addr->binop.arg2)); return true;
+        case ACT_SHIFT_RIGHT : rewriteToShift(addr , addr->binop.arg2 , powerOfTwoExponent(addr->binop.arg1)); return true;
+        case ACT_REASSOCIATE : return reassociateConstants(currBlock , position);
+    }
+    return false;
+}
+
+static bool simplifyBinOp(block* currBlock , int position){
+    address* addr = currBlock->list[position];
+
+    // leave constant-only instructions to constant folding
+    if(!isVariable(addr->binop.arg1) && !isVariable(addr->binop.arg2)) return false;
+
+    // the first rule that matches and applies wins
+    for(int r=0 ; r<simplifyRuleCount ; r++){
+        const simplifyRule* rule = &simplifyRules[r];
+
+        if(!isStringSame(addr->binop.op , rule->op)) continue;
+        if(!matchesPattern(addr->binop.arg1 , rule->left)) continue;
+        if(!matchesPattern(addr->binop.arg2 , rule->right)) continue;
+        if(rule->sameOperands && !isStringSame(addr->binop.arg1 , addr->binop.arg2)) continue;
+        if(!matchesTypes(addr , rule->types)) continue;
+
+        if(applyRule(currBlock , position , rule)) return true;
+    }
+
+    return false;
+}
+
+// !!b -> b when the inner ! is computed earlier in the same block
+static bool simplifyUnOp(block* currBlock , int position){
+    address* addr = currBlock->list[position];
+    if(!isStringSame(addr->unop.op , "!")) return false;
+
+    int k = findLocalDefinition(currBlock , position , addr->unop.arg1);
+    if(k == -1) return false;
+
+    address* inner = currBlock->list[k];
+    if(inner->type != ADDR_UNOP || !isStringSame(inner->unop.op , "!")) return false;
+    if(isRedefinedBetween(currBlock , k , position , inner->unop.arg1)) return false;
+    if(isStringSame(inner->unop.arg1 , inner->unop.result)) return false;
+
+    char result[MAX_NAME];
+    char value[MAX_NAME];
+    strcpy(result , addr->unop.result);
+    strcpy(value , inner->unop.arg1);
+
+    addr->type = ADDR_ASSIGN;
+    strcpy(addr->assign.result , result);
+    strcpy(addr->assign.arg1 , value);
+    return true;
+}
+
+void checkForAlgebraicSimplification(){
+    // loop through all blocks
+    for(int i=0 ; i<block_count ; i++){
+        // loop through all instructions of i(th) block
+        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
+            bool changed = false;
+
+            if(!hasOptimizationFuel()) return;
+
+            if(allBlocks[i]->list[j]->type == ADDR_BINOP){
+                changed = simplifyBinOp(allBlocks[i] , j);
+            } else if(allBlocks[i]->list[j]->type == ADDR_UNOP){
+                changed = simplifyUnOp(allBlocks[i] , j);
+            }
+
+            if(changed){
+                burnOptimizationFuel();
+                flag = true;
+            }
+        }
+    }
+
+    return;
+}
@@ -0,0 +1,525 @@
+/**
+ * 05_04_sparseConditionalConstProp.c - Sparse Conditional Constant Propagation
+ *
+ * This module implements the conditional constant propagation of Wegman and
+ * Zadeck over the CFG. Every variable gets a lattice value at the entry of
+ * every block, and only CFG edges that can actually be taken are followed.
+ * A branch on a constant condition therefore marks only one successor as
+ * executable, and values merging from never-executed paths are ignored.
+ *
+ * Lattice (per variable):
+ *   TOP      -> no value seen yet (optimistic)
+ *   constant -> same constant on every executable path
+ *   BOTTOM   -> not a constant
+ *
+ * Features:
+ * - Constants tracked through merges (loops, if/else) using executable edges only
+ * - Operands rewritten to constants, constant expressions rewritten to copies
+ * - "ifFalse true goto L" removed, "ifFalse false goto L" turned into "goto L"
+ * - Blocks that no executable edge reaches are removed from the CFG
+ *
+ * Example:
+ *   debug = false                 debug = false
+ *   ifFalse debug goto L1         goto L1
+ *   x = 1                  ==>    (block removed)
+ *   L1:                           L1:
+ *   y = x                         y = x
+ *
+ * Author: Ridham Khurana
+ */
+
+#include "database.h"
+
+#define SCCP_TOP -1
+#define SCCP_BOTTOM -2
+
+// statistics of the last run (printed with the phase statistics)
+int sccp_branches_pruned = 0;
+int sccp_blocks_removed = 0;
+
+// a constant branch was kept because the optimization budget ran out
+static bool sccp_branch_kept = false;
+
+// open-addressing table from a name to an index
+typedef struct {
+    char** keys;
+    int* values;
+    int capacity;
+    int count;
+} sccpTable;
+
+static sccpTable sccpVars;        // variable name -> variable index
+static sccpTable sccpConsts;      // constant text -> constant index
+static sccpTable sccpLabels;      // label name -> block index
+
+static char** sccpConstText = NULL;  // constant index -> constant text
+static int sccpConstLimit = 0;
+
+static int* sccpIn = NULL;        // lattice value of every variable at entry of every block
+static bool* sccpExecutable = NULL;  // block reached by an executable edge
+static bool* sccpInWorklist = NULL;
+static int* sccpWorklist = NULL;
+static int sccpWorklistCount = 0;
+
+static void sccpOutOfMemory(){
+    printf("05 || Optimization error [05.12] -> Memory allocation failed for constant propagation tables\n");
+    exit(5);
+}
+
+static void sccpTableInit(sccpTable* table , int n){
+    table->capacity = hashTableSize(n);
+    table->count = 0;
+    table->keys = (char**)calloc(table->capacity , sizeof(char*));
+    table->values = (int*)malloc(table->capacity * sizeof(int));
+    if(!table->keys || !table->values) sccpOutOfMemory();
+}
+
+static void sccpTableFree(sccpTable* table){
+    free(table->keys);
+    free(table->values);
+    table->keys = NULL;
+    table->values = NULL;
+}
+
+// slot holding the key, or the empty slot where it goes
+static int sccpTableSlot(sccpTable* table , char* key){
+    int mask = table->capacity - 1;
+    int slot = hashString(key) & mask;
+
+    while(table->keys[slot] && !isStringSame(table->keys[slot] , key)){
+        slot = (slot + 1) & mask; // linear probing
+    }
+
+    return slot;
+}
+
+// index of key (-1 if not present)
+static int sccpTableFind(sccpTable* table , char* key){
+    int slot = sccpTableSlot(table , key);
+    return table->keys[slot] ? table->values[slot] : -1;
+}
+
+// store key -> value (key must stay alive while the table is used)
+static void sccpTableSet(sccpTable* table , char* key , int value){
+    int slot = sccpTableSlot(table , key);
+    if(!table->keys[slot]){
+        table->keys[slot] = key;
+        table->count++;
+    }
+    table->values[slot] = value;
+}
+
+// collect the scalar name at an operand position
+static void sccpCollectName(char* name){
+    if(name[0] != '\0' && !isConstant(name) && isVariable(name)){
+        if(sccpTableFind(&sccpVars , name) == -1) sccpTableSet(&sccpVars , name , sccpVars.count);
+    }
+}
+
+// lattice value for a constant (constants are interned so equal text gives equal value)
+static int sccpConstantValue(char* text){
+    int slot = sccpTableSlot(&sccpConsts , text);
+    if(sccpConsts.keys[slot]) return sccpConsts.values[slot];
+
+    // pool full: give up on this value (never happens for sane inputs)
+    if(sccpConsts.count >= sccpConstLimit) return SCCP_BOTTOM;
+
+    // keep a private copy, the operand text may be rewritten later
+    char* copy = (char*)malloc(MAX_NAME * sizeof(char));
+    if(!copy) sccpOutOfMemory();
+    strcpy(copy , text);
+
+    sccpConstText[sccpConsts.count] = copy;
+    sccpConsts.keys[slot] = copy;
+    sccpConsts.values[slot] = sccpConsts.count;
+    return sccpConsts.count++;
+}
+
+// lattice value of an operand under env
+static int sccpValueOf(char* operand , int* env){
+    if(isConstant(operand)) return sccpConstantValue(operand);
+
+    int index = sccpTableFind(&sccpVars , operand);
+    if(index == -1) return SCCP_BOTTOM;
+
+    return env[index];
+}
+
+// meet of two lattice values
+static int sccpMeet(int a , int b){
+    if(a == SCCP_TOP) return b;
+    if(b == SCCP_TOP) return a;
+    if(a == b) return a;
+    return SCCP_BOTTOM;
+}
+
+// value stored into a variable (an int constant stored into a double variable becomes a double)
+static int sccpStoredValue(char* result , int value){
+    if(value < 0 || !isInteger(sccpConstText[value])) return value;
+    if(getTypeOfOperand(result) != KEYWORD_DOUBLE) return value;
+
+    char text[MAX_NAME];
+    formatDoubleConstant((double)stringToInt(sccpConstText[value]) , text);
+    return sccpConstantValue(text);
+}
+
+static void sccpDefine(char* result , int value , int* env){
+    int index = sccpTableFind(&sccpVars , result);
+    if(index != -1) env[index] = sccpStoredValue(result , value);
+}
+
+// value computed by an instruction (SCCP_BOTTOM for instructions that do not fold)
+static int sccpEvaluate(address* addr , int* env){
+    switch(addr->type){
+        case ADDR_ASSIGN :
+            return sccpValueOf(addr->assign.arg1 , env);
+
+        case ADDR_BINOP : {
+            int left = sccpValueOf(addr->binop.arg1 , env);
+            int right = sccpValueOf(addr->binop.arg2 , env);
+            if(left == SCCP_BOTTOM || right == SCCP_BOTTOM) return SCCP_BOTTOM;
+            if(left == SCCP_TOP || right == SCCP_TOP) return SCCP_TOP;
+
+            char* folded = foldConstantBinOp(addr->binop.op , sccpConstText[left] , sccpConstText[right]);
+            if(folded == NULL) return SCCP_BOTTOM;
+
+            int value = sccpConstantValue(folded);
+            free(folded);
+            return value;
+        }
+
+        case ADDR_UNOP : {
+            int operand = sccpValueOf(addr->unop.arg1 , env);
+            if(operand < 0) return operand;
+
+            char* folded = foldConstantUnOp(addr->unop.op , sccpConstText[operand]);
+            if(folded == NULL) return SCCP_BOTTOM;
+
+            int value = sccpConstantValue(folded);
+            free(folded);
+            return value;
+        }
+
+        default :
+            return SCCP_BOTTOM;
+    }
+}
+
+// update env with the effect of one instruction
+static void sccpTransfer(address* addr , int* env){
+    switch(addr->type){
+        case ADDR_ASSIGN :
+            sccpDefine(addr->assign.result , sccpEvaluate(addr , env) , env);
+            break;
+        case ADDR_BINOP :
+            sccpDefine(addr->binop.result , sccpEvaluate(addr , env) , env);
+            break;
+        case ADDR_UNOP :
+            sccpDefine(addr->unop.result , sccpEvaluate(addr , env) , env);
+            break;
+        case ADDR_ARRAY_READ :
+            sccpDefine(addr->array_read.result , SCCP_BOTTOM , env);
+            break;
+        default :
+            break;
+    }
+}
+
+// truth of a condition: 0 false, 1 true, -1 not known yet (TOP), 2 not a constant
+static int sccpTruthOf(int value){
+    if(value == SCCP_TOP) return -1;
+    if(value == SCCP_BOTTOM) return 2;
+
+    char* text = sccpConstText[value];
+    if(isStringSame(text , "true")) return 1;
+    if(isStringSame(text , "false")) return 0;
+    return getNumericValueOfConstant(text) != 0.0;
+}
+
+// which edges leave a block: *jump gets the block index of the jump target (-1 if no jump),
+// *fall gets the next block (-1 if control can not fall through); truth decides conditional jumps
+static void sccpSuccessors(int b , int truth , int* jump , int* fall){
+    block* currBlock = allBlocks[b];
+    address* last = currBlock->list[currBlock->numberOfAddressesInBlock-1];
+    int next = (b+1 < block_count) ? b+1 : -1;
+
+    *jump = -1;
+    *fall = -1;
+
+    if(last->type == ADDR_GOTO){
+        *jump = sccpTableFind(&sccpLabels , last->goto_stmt.target);
+    } else if(last->type == ADDR_IF_F_GOTO || last->type == ADDR_IF_T_GOTO){
+        char* target = (last->type == ADDR_IF_F_GOTO) ? last->if_false.target : last->if_true.target;
+        int jumpWhen = (last->type == ADDR_IF_F_GOTO) ? 0 : 1;
+
+        if(truth == 2 || truth == jumpWhen) *jump = sccpTableFind(&sccpLabels , target);
+        if(truth == 2 || truth == 1 - jumpWhen) *fall = next;
+    } else{
+        *fall = next;
+    }
+}
+
+// condition value at the end of block b (env is the value at the end of the block)
+static int sccpBranchTruth(int b , int* env){
+    block* currBlock = allBlocks[b];
+    address* last = currBlock->list[currBlock->numberOfAddressesInBlock-1];
+
+    if(last->type == ADDR_IF_F_GOTO) return sccpTruthOf(sccpValueOf(last->if_false.condition , env));
+    if(last->type == ADDR_IF_T_GOTO) return sccpTruthOf(sccpValueOf(last->if_true.condition , env));
+    return 2;
+}
+
+static void sccpPush(int b){
+    if(sccpInWorklist[b]) return;
+    sccpInWorklist[b] = true;
+    sccpWorklist[sccpWorklistCount++] = b;
+}
+
+// env flows along the executable edge into block 'to'
+static void sccpFlowInto(int to , int* env){
+    if(to < 0) return;
+
+    int* in = &sccpIn[(long)to * sccpVars.count];
+    bool changed = !sccpExecutable[to];
+    sccpExecutable[to] = true;
+
+    for(int v=0 ; v<sccpVars.count ; v++){
+        int merged = sccpMeet(in[v] , env[v]);
+        if(merged != in[v]){
+            in[v] = merged;
+            changed = true;
+        }
+    }
+
+    if(changed) sccpPush(to);
+}
+
+static void sccpAllocate(){
+    int n = countInstructionsInBlocks();
+
+    sccpTableInit(&sccpVars , 3*n + 4);
+    sccpTableInit(&sccpConsts , 4*n + 4);
+    sccpTableInit(&sccpLabels , block_count + 4);
+
+    // every instruction adds at most 3 operand constants and 1 folded constant
+    sccpConstLimit = 4*n + 4;
+    sccpConstText = (char**)malloc(sccpConstLimit * sizeof(char*));
+    if(!sccpConstText) sccpOutOfMemory();
+
+    // number every scalar variable and remember where every label starts
+    for(int i=0 ; i<block_count ; i++){
+        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
+            address* addr = allBlocks[i]->list[j];
+            switch(addr->type){
+                case ADDR_ASSIGN :
+                    sccpCollectName(addr->assign.result);
+                    sccpCollectName(addr->assign.arg1);
+                    break;
+                case ADDR_BINOP :
+                    sccpCollectName(addr->binop.result);
+                    sccpCollectName(addr->binop.arg1);
+                    sccpCollectName(addr->binop.arg2);
+                    break;
+                case ADDR_UNOP :
+                    sccpCollectName(addr->unop.result);
+                    sccpCollectName(addr->unop.arg1);
+                    break;
+                case ADDR_ARRAY_READ :
+                    sccpCollectName(addr->array_read.result);
+                    sccpCollectName(addr->array_read.index);
+                    break;
+                case ADDR_ARRAY_WRITE :
+                    sccpCollectName(addr->array_write.index);
+                    sccpCollectName(addr->array_write.value);
+                    break;
+                case ADDR_IF_F_GOTO :
+                    sccpCollectName(addr->if_false.condition);
+                    break;
+                case ADDR_IF_T_GOTO :
+                    sccpCollectName(addr->if_true.condition);
+                    break;
+                case ADDR_LABEL :
+                    sccpTableSet(&sccpLabels , addr->label.labelNumber , i);
+                    break;
+                default :
+                    break;
+            }
+        }
+    }
+
+    sccpIn = (int*)malloc(((long)block_count * sccpVars.count + 1) * sizeof(int));
+    sccpExecutable = (bool*)calloc(block_count + 1 , sizeof(bool));
+    sccpInWorklist = (bool*)calloc(block_count + 1 , sizeof(bool));
+    sccpWorklist = (int*)malloc((block_count + 1) * sizeof(int));
+    if(!sccpIn || !sccpExecutable || !sccpInWorklist || !sccpWorklist) sccpOutOfMemory();
+
+    for(long i=0 ; i<(long)block_count * sccpVars.count ; i++) sccpIn[i] = SCCP_TOP;
+    sccpWorklistCount = 0;
+}
+
+static void sccpRelease(){
+    for(int i=0 ; i<sccpConsts.count ; i++) free(sccpConstText[i]);
+    free(sccpConstText);
+    sccpConstText = NULL;
+
+    sccpTableFree(&sccpVars);
+    sccpTableFree(&sccpConsts);
+    sccpTableFree(&sccpLabels);
+
+    free(sccpIn);
+    free(sccpExecutable);
+    free(sccpInWorklist);
+    free(sccpWorklist);
+    sccpIn = NULL;
+    sccpExecutable = NULL;
+    sccpInWorklist = NULL;
+    sccpWorklist = NULL;
+}
+
+// propagate lattice values over executable edges until nothing changes
+static void sccpSolve(int* env){
+    // program entry: every variable holds an unknown value
+    for(int v=0 ; v<sccpVars.count ; v++) env[v] = SCCP_BOTTOM;
+    sccpFlowInto(0 , env);
+
+    while(sccpWorklistCount > 0){
+        int b = sccpWorklist[--sccpWorklistCount];
+        sccpInWorklist[b] = false;
+
+        memcpy(env , &sccpIn[(long)b * sccpVars.count] , sccpVars.count * sizeof(int));
+        for(int j=0 ; j<allBlocks[b]->numberOfAddressesInBlock ; j++){
+            sccpTransfer(allBlocks[b]->list[j] , env);
+        }
+
+        int jump , fall;
+        sccpSuccessors(b , sccpBranchTruth(b , env) , &jump , &fall);
+        sccpFlowInto(jump , env);
+        sccpFlowInto(fall , env);
+    }
+}
+
+// replace a use by its constant
+static void sccpRewriteUse(char* operand , int* env){
+    if(isConstant(operand)) return;
+
+    int value = sccpValueOf(operand , env);
+    if(value < 0 || !hasOptimizationFuel()) return;
+
+    strcpy(operand , sccpConstText[value]);
+    burnOptimizationFuel();
+}
+
+// rewrite an executable block with the solved lattice values
+static void sccpRewriteBlock(int b , int* env){
+    block* currBlock = allBlocks[b];
+    memcpy(env , &sccpIn[(long)b * sccpVars.count] , sccpVars.count * sizeof(int));
+
+    for(int j=0 ; j<currBlock->numberOfAddressesInBlock ; j++){
+        address* addr = currBlock->list[j];
+
+        switch(addr->type){
+            case ADDR_ASSIGN :
+                sccpRewriteUse(addr->assign.arg1 , env);
+                break;
+            case ADDR_BINOP :
+            case ADDR_UNOP : {
+                int value = sccpEvaluate(addr , env);
+                if(value >= 0 && hasOptimizationFuel()){
+                    // whole expression is constant: result = constant
+                    char result[MAX_NAME];
+                    strcpy(result , getLeftSideOfKindOfAssign(addr));
+                    addr->type = ADDR_ASSIGN;
+                    strcpy(addr->assign.result , result);
+                    strcpy(addr->assign.arg1 , sccpConstText[sccpStoredValue(result , value)]);
+                    burnOptimizationFuel();
+                } else if(addr->type == ADDR_BINOP){
+                    sccpRewriteUse(addr->binop.arg1 , env);
+                    sccpRewriteUse(addr->binop.arg2 , env);
+                } else{
+                    sccpRewriteUse(addr->unop.arg1 , env);
+                }
+                break;
+            }
+            case ADDR_ARRAY_READ :
+                sccpRewriteUse(addr->array_read.index , env);
+                break;
+            case ADDR_ARRAY_WRITE :
+                sccpRewriteUse(addr->array_write.index , env);
+                sccpRewriteUse(addr->array_write.value , env);
+                break;
+            default :
+                break;
+        }
+
+        sccpTransfer(addr , env);
+    }
+
+    // prune a conditional jump on a constant condition
+    address* last = currBlock->list[currBlock->numberOfAddressesInBlock-1];
+    int truth = sccpBranchTruth(b , env);
+    if((last->type != ADDR_IF_F_GOTO && last->type != ADDR_IF_T_GOTO) || truth == 2) return;
+
+    // without fuel the branch stays, so its never taken successor must stay as well
+    if(!hasOptimizationFuel()){
+        sccp_branch_kept = true;
+        return;
+    }
+    burnOptimizationFuel();
+
+    int jump , fall;
+    sccpSuccessors(b , truth , &jump , &fall);
+    int target = sccpTableFind(&sccpLabels , (last->type == ADDR_IF_F_GOTO) ? last->if_false.target : last->if_true.target);
+
+    if(jump != -1){
+        // always jumps: ifFalse false goto L ==> goto L
+        char label[MAX_NAME];
+        strcpy(label , (last->type == ADDR_IF_F_GOTO) ? last->if_false.target : last->if_true.target);
+        last->type = ADDR_GOTO;
+        strcpy(last->goto_stmt.target , label);
+        if(b+1 < block_count) removeCFGEdge(currBlock , allBlocks[b+1]);
+    } else{
+        // never jumps: drop the instruction (an emptied block is removed afterwards)
+        currBlock->numberOfAddressesInBlock--;
+        if(target != -1) removeCFGEdge(currBlock , allBlocks[target]);
+    }
+
+    sccp_branches_pruned++;
+}
+
+void startSparseConditionalConstPhase(){
+    sccp_branches_pruned = 0;
+    sccp_blocks_removed = 0;
+    if(block_count == 0) return;
+
+    sccpAllocate();
+
+    int* env = (int*)malloc((sccpVars.count + 1) * sizeof(int));
+    if(!env) sccpOutOfMemory();
+
+    sccpSolve(env);
+
+    sccp_branch_kept = false;
+    for(int b=0 ; b<block_count ; b++){
+        if(sccpExecutable[b]) sccpRewriteBlock(b , env);
+    }
+
+    // blocks never reached by an executable edge are dead
+    // (unless a constant branch was kept for lack of fuel: it may still jump there)
+    for(int b=block_count-1 ; b>=0 ; b--){
+        if(sccpExecutable[b] && allBlocks[b]->numberOfAddressesInBlock > 0) continue;
+        if(!sccpExecutable[b] && sccp_branch_kept) continue;
+
+        if(sccpExecutable[b] && b+1 < block_count){
+            // block held only a pruned branch: its predecessors fall through to the next block
+            while(allBlocks[b]->numCFGIn > 0) replaceCFGEdge(allBlocks[b]->cfg_in[0] , allBlocks[b] , allBlocks[b+1]);
+        }
+        removeBlockAt(b);
+        sccp_blocks_removed++;
+    }
+
+    free(env);
+    sccpRelease();
+
+    // keep the linear instruction list in sync with the blocks
+    rebuildAddressListFromBlocks();
+}
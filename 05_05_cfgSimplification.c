@@ -0,0 +1,326 @@
+/**
+ * 05_05_cfgSimplification.c - Control Flow Graph Simplification
+ *
+ * This module cleans up the jumps, labels and blocks left behind by the ICG
+ * and by the other optimization passes. It runs after every pass that
+ * changes the structure of the CFG and repeats its rules until none applies.
+ *
+ * Features:
+ * - Branches on constant conditions become jumps (or disappear)
+ * - Unreachable blocks (no path from the entry block) are removed
+ * - Jump threading: a jump to "L: goto M" (or to an empty block) is retargeted
+ * - Jumps to the block that follows anyway (fall-through) are removed
+ * - Labels no jump refers to are removed, empty blocks are removed
+ * - A block with a single successor is merged with that successor when the
+ *   successor has no other predecessor and directly follows it
+ * - Every rewrite uses one unit of the optimization budget (05_07)
+ *
+ * Example:
+ *   x = 1                         x = 1
+ *   goto L2                       y = 2
+ *   L2:              ==>          goto L4
+ *   y = 2
+ *   goto L3
+ *   L3:
+ *   goto L4
+ *
+ * Author: Ridham Khurana
+ */
+
+#include "database.h"
+
+// statistics of the last run (printed with the phase statistics)
+int cfg_jumps_threaded = 0;
+int cfg_jumps_removed = 0;
+int cfg_blocks_removed = 0;
+
+// jump target of the instruction (NULL if it is not a jump)
+static char* cfgJumpTarget(address* addr){
+    if(addr->type == ADDR_GOTO) return addr->goto_stmt.target;
+    if(addr->type == ADDR_IF_F_GOTO) return addr->if_false.target;
+    if(addr->type == ADDR_IF_T_GOTO) return addr->if_true.target;
+    return NULL;
+}
+
+static address* cfgLastInstruction(block* currBlock){
+    if(currBlock->numberOfAddressesInBlock == 0) return NULL;
+    return currBlock->list[currBlock->numberOfAddressesInBlock-1];
+}
+
+// index of the block that starts with the label (-1 if not found)
+static int cfgBlockOfLabel(char* label){
+    for(int i=0 ; i<block_count ; i++){
+        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock && allBlocks[i]->list[j]->type == ADDR_LABEL ; j++){
+            if(isStringSame(allBlocks[i]->list[j]->label.labelNumber , label)) return i;
+        }
+    }
+    return -1;
+}
+
+// number of jumps that refer to the label
+static int cfgLabelUses(char* label){
+    int uses = 0;
+    for(int i=0 ; i<block_count ; i++){
+        address* last = cfgLastInstruction(allBlocks[i]);
+        if(last && cfgJumpTarget(last) && isStringSame(cfgJumpTarget(last) , label)) uses++;
+    }
+    return uses;
+}
+
+// remove instruction at position from a block
+static void cfgRemoveInstruction(block* currBlock , int position){
+    for(int i=position ; i<currBlock->numberOfAddressesInBlock-1 ; i++){
+        currBlock->list[i] = currBlock->list[i+1];
+    }
+    currBlock->numberOfAddressesInBlock--;
+}
+
+// ifFalse/ifTrue on a constant condition: jump always or never
+static bool cfgFoldConstantBranches(){
+    bool changed = false;
+
+    for(int b=0 ; b<block_count ; b++){
+        address* last = cfgLastInstruction(allBlocks[b]);
+        if(!last || (last->type != ADDR_IF_F_GOTO && last->type != ADDR_IF_T_GOTO)) continue;
+
+        char* condition = (last->type == ADDR_IF_F_GOTO) ? last->if_false.condition : last->if_true.condition;
+        if(!isConstant(condition)) continue;
+
+        if(!hasOptimizationFuel()) return changed;
+        burnOptimizationFuel();
+
+        bool truth = isStringSame(condition , "true") || (!isStringSame(condition , "false") && getNumericValueOfConstant(condition) != 0.0);
+        bool jumps = (last->type == ADDR_IF_F_GOTO) ? !truth : truth;
+        int target = cfgBlockOfLabel(cfgJumpTarget(last));
+
+        if(jumps){
+            char label[MAX_NAME];
+            strcpy(label , cfgJumpTarget(last));
+            last->type = ADDR_GOTO;
+            strcpy(last->goto_stmt.target , label);
+            if(b+1 < block_count) removeCFGEdge(allBlocks[b] , allBlocks[b+1]);
+        } else{
+            cfgRemoveInstruction(allBlocks[b] , allBlocks[b]->numberOfAddressesInBlock-1);
+            if(target != -1) removeCFGEdge(allBlocks[b] , allBlocks[target]);
+        }
+
+        cfg_jumps_removed++;
+        changed = true;
+    }
+
+    return changed;
+}
+
+// remove blocks that can not be reached from the entry block
+static bool cfgRemoveUnreachableBlocks(){
+    if(block_count == 0) return false;
+
+    bool* reached = (bool*)calloc(block_count , sizeof(bool));
+    int* stack = (int*)malloc(block_count * sizeof(int));
+    if(!reached || !stack){
+        printf("05 || Optimization error [05.13] -> Memory allocation failed for CFG simplification\n");
+        exit(5);
+    }
+
+    // depth first search over the CFG edges
+    int top = 0;
+    stack[top++] = 0;
+    reached[0] = true;
+    while(top > 0){
+        block* currBlock = allBlocks[stack[--top]];
+        for(int i=0 ; i<currBlock->numCFGOut ; i++){
+            int next = findIndexOfBlock(currBlock->cfg_out[i]);
+            if(!reached[next]){
+                reached[next] = true;
+                stack[top++] = next;
+            }
+        }
+    }
+
+    bool changed = false;
+    for(int b=block_count-1 ; b>=0 && hasOptimizationFuel() ; b--){
+        if(reached[b]) continue;
+        burnOptimizationFuel();
+        removeBlockAt(b);
+        cfg_blocks_removed++;
+        changed = true;
+    }
+
+    free(reached);
+    free(stack);
+    return changed;
+}
+
+// label that control really reaches when jumping to the block at index
+// (skips blocks that only hold labels and a goto, or only labels; NULL if nothing to skip)
+static char* cfgFinalLabel(int index , int from){
+    char* label = NULL;
+
+    for(int steps=0 ; index != -1 ; steps++){
+        // a cycle of empty blocks (an endless loop) is left alone
+        if(steps == block_count) return NULL;
+
+        block* currBlock = allBlocks[index];
+        int labels = 0;
+        while(labels < currBlock->numberOfAddressesInBlock && currBlock->list[labels]->type == ADDR_LABEL) labels++;
+
+        int next = -1;
+        if(labels == currBlock->numberOfAddressesInBlock - 1 && currBlock->list[labels]->type == ADDR_GOTO){
+            // L: goto M
+            next = cfgBlockOfLabel(currBlock->list[labels]->goto_stmt.target);
+        } else if(labels == currBlock->numberOfAddressesInBlock && index+1 < block_count){
+            // L: (nothing) falls into the next block, usable if that block has a label
+            if(allBlocks[index+1]->numberOfAddressesInBlock > 0 && allBlocks[index+1]->list[0]->type == ADDR_LABEL) next = index+1;
+        }
+
+        // stop at real code, and never thread a block into itself
+        if(next == -1 || next == index || next == from) break;
+
+        label = allBlocks[next]->list[0]->label.labelNumber;
+        index = next;
+    }
+
+    return label;
+}
+
+// retarget jumps whose target only jumps on
+static bool cfgThreadJumps(){
+    bool changed = false;
+
+    for(int b=0 ; b<block_count ; b++){
+        address* last = cfgLastInstruction(allBlocks[b]);
+        if(!last || !cfgJumpTarget(last)) continue;
+
+        int target = cfgBlockOfLabel(cfgJumpTarget(last));
+        if(target == -1) continue;
+
+        char* label = cfgFinalLabel(target , b);
+        if(label == NULL) continue;
+        if(!hasOptimizationFuel()) return changed;
+        burnOptimizationFuel();
+
+        int newTarget = cfgBlockOfLabel(label);
+        strcpy(cfgJumpTarget(last) , label);
+        replaceCFGEdge(allBlocks[b] , allBlocks[target] , allBlocks[newTarget]);
+
+        cfg_jumps_threaded++;
+        changed = true;
+    }
+
+    return changed;
+}
+
+// remove jumps to the block that directly follows
+static bool cfgRemoveFallThroughJumps(){
+    bool changed = false;
+
+    for(int b=0 ; b+1<block_count ; b++){
+        address* last = cfgLastInstruction(allBlocks[b]);
+        if(!last || !cfgJumpTarget(last)) continue;
+        if(cfgBlockOfLabel(cfgJumpTarget(last)) != b+1) continue;
+        if(!hasOptimizationFuel()) return changed;
+        burnOptimizationFuel();
+
+        // conditional jump had two edges to the next block, keep one
+        if(last->type != ADDR_GOTO) removeCFGEdge(allBlocks[b] , allBlocks[b+1]);
+        cfgRemoveInstruction(allBlocks[b] , allBlocks[b]->numberOfAddressesInBlock-1);
+
+        cfg_jumps_removed++;
+        changed = true;
+    }
+
+    return changed;
+}
+
+// remove labels that no jump refers to, then blocks that became empty
+static bool cfgRemoveUnusedLabelsAndEmptyBlocks(){
+    bool changed = false;
+
+    for(int b=0 ; b<block_count ; b++){
+        for(int j=0 ; j<allBlocks[b]->numberOfAddressesInBlock && allBlocks[b]->list[j]->type == ADDR_LABEL ; j++){
+            if(cfgLabelUses(allBlocks[b]->list[j]->label.labelNumber) > 0) continue;
+            if(!hasOptimizationFuel()) return changed;
+            burnOptimizationFuel();
+            cfgRemoveInstruction(allBlocks[b] , j);
+            j--;
+            changed = true;
+        }
+    }
+
+    for(int b=block_count-1 ; b>=0 ; b--){
+        if(allBlocks[b]->numberOfAddressesInBlock > 0) continue;
+        if(!hasOptimizationFuel()) return changed;
+        burnOptimizationFuel();
+
+        // no label and no jump: every predecessor falls through into the next block
+        if(b+1 < block_count){
+            while(allBlocks[b]->numCFGIn > 0) replaceCFGEdge(allBlocks[b]->cfg_in[0] , allBlocks[b] , allBlocks[b+1]);
+        }
+        removeBlockAt(b);
+        cfg_blocks_removed++;
+        changed = true;
+    }
+
+    return changed;
+}
+
+// merge a block with the next block when control can only flow from one into the other
+static bool cfgMergeBlocks(){
+    bool changed = false;
+
+    for(int b=0 ; b+1<block_count ; b++){
+        block* first = allBlocks[b];
+        block* second = allBlocks[b+1];
+        address* last = cfgLastInstruction(first);
+
+        if(!last || cfgJumpTarget(last)) continue;
+        if(first->numCFGOut != 1 || first->cfg_out[0] != second) continue;
+        if(second->numCFGIn != 1 || second->numberOfAddressesInBlock == 0 || second->list[0]->type == ADDR_LABEL) continue;
+        if(first->numberOfAddressesInBlock + second->numberOfAddressesInBlock > MAX) continue;
+        if(!hasOptimizationFuel()) return changed;
+        burnOptimizationFuel();
+
+        for(int j=0 ; j<second->numberOfAddressesInBlock ; j++){
+            first->list[first->numberOfAddressesInBlock++] = second->list[j];
+        }
+
+        // successors of the second block now follow the first block
+        first->numCFGOut = 0;
+        for(int i=0 ; i<second->numCFGOut ; i++){
+            block* next = second->cfg_out[i];
+            first->cfg_out[first->numCFGOut++] = next;
+            for(int k=0 ; k<next->numCFGIn ; k++){
+                if(next->cfg_in[k] == second) next->cfg_in[k] = first;
+            }
+        }
+        second->numCFGIn = 0;
+        second->numCFGOut = 0;
+        removeBlockAt(b+1);
+
+        cfg_blocks_removed++;
+        changed = true;
+        b--; // the merged block may merge again
+    }
+
+    return changed;
+}
+
+void simplifyControlFlowGraph(){
+    cfg_jumps_threaded = 0;
+    cfg_jumps_removed = 0;
+    cfg_blocks_removed = 0;
+
+    bool changed = true;
+    while(changed && block_count > 0){
+        changed = false;
+        changed |= cfgFoldConstantBranches();
+        changed |= cfgRemoveUnreachableBlocks();
+        changed |= cfgThreadJumps();
+        changed |= cfgRemoveFallThroughJumps();
+        changed |= cfgRemoveUnusedLabelsAndEmptyBlocks();
+        changed |= cfgMergeBlocks();
+    }
+
+    // keep the linear instruction list in sync with the blocks
+    rebuildAddressListFromBlocks();
+}
@@ -0,0 +1,501 @@
+/**
+ * 05_06_definitionResolver.c - Memoised Definition Resolver (Constant & Copy Propagation)
+ *
+ * This module answers "what does this operand hold here?" for constant and
+ * copy propagation. Every analysis version (one call of a propagation pass)
+ * numbers all definitions, solves reaching definitions and available copies
+ * over the CFG until they stop changing (so loop back edges are included),
+ * and then rewrites the operands in one forward walk per block.
+ *
+ * What a definition resolves to is computed once and memoised:
+ *   x = 5      -> constant 5
+ *   x = y      -> whatever y holds at that point (constant, or unknown)
+ *   x = a + b  -> unknown (left to constant folding)
+ *
+ * Features:
+ * - Reaching definitions and available copies as bit-sets, solved to a fixpoint
+ * - A use is a constant when every reaching definition resolves to that constant
+ * - A use of x is replaced by y only while the copy "x = y" is available
+ *   (executed on every path, and neither x nor y changed since)
+ * - No recursion over the IN sets and no shared global counters
+ *
+ * Author: Ridham Khurana
+ */
+
+#include "database.h"
+
+// set by every optimization that changes an instruction (05_optimization.c)
+extern bool flag;
+
+typedef unsigned long long rdWord;
+
+// resolution state of a definition
+#define RD_UNRESOLVED 0
+#define RD_RESOLVING 1
+#define RD_RESOLVED 2
+
+static int rdWords = 0;
+
+// definitions (every instruction that defines a scalar)
+static int rdDefCount = 0;
+static address** rdDefAddr = NULL;
+static int* rdDefBlock = NULL;
+static int* rdDefVar = NULL;
+static int* rdDefSourceDef = NULL;   // copy x = y: definition of y seen earlier in the block (-1: from IN)
+static int* rdDefSourceVar = NULL;   // copy x = y: variable index of y (-1 if not a copy)
+static char (*rdDefValue)[MAX_NAME] = NULL;  // memoised constant ("" if not a constant)
+static char* rdDefState = NULL;
+
+// definition of every instruction (-1 if it defines nothing), indexed by rdBlockStart[b] + j
+static int* rdBlockStart = NULL;
+static int* rdInstrDef = NULL;
+
+// variables
+static char (*rdVarName)[MAX_NAME] = NULL;  // own copies, operands are rewritten in place
+static int rdVarCount = 0;
+static int* rdVarSlot = NULL;        // open-addressing table of variable indices
+static int rdVarSlotCount = 0;
+static rdWord** rdVarDefs = NULL;    // definitions of each variable
+static rdWord** rdVarCopies = NULL;  // copies that define or read each variable
+
+// per block sets
+static rdWord** rdGen = NULL;
+static rdWord** rdKill = NULL;
+static rdWord** rdIn = NULL;
+static rdWord** rdOut = NULL;
+static rdWord** rdCopyGen = NULL;
+static rdWord** rdCopyKill = NULL;
+static rdWord** rdCopyIn = NULL;
+static rdWord** rdCopyOut = NULL;
+
+// variable -> latest definition in the block being walked
+static int* rdLocalDef = NULL;
+
+// ----- small bit-set helpers -----
+
+static void rdOutOfMemory(){
+    printf("05 || Optimization error [05.14] -> Memory allocation failed for definition resolver\n");
+    exit(5);
+}
+
+static rdWord* rdNewSet(bool full){
+    rdWord* set = (rdWord*)malloc((rdWords > 0 ? rdWords : 1) * sizeof(rdWord));
+    if(set == NULL) rdOutOfMemory();
+    for(int i=0 ; i<rdWords ; i++) set[i] = full ? ~0ULL : 0ULL;
+    return set;
+}
+
+static rdWord** rdNewSets(int n , bool full){
+    rdWord** sets = (rdWord**)malloc((n > 0 ? n : 1) * sizeof(rdWord*));
+    if(sets == NULL) rdOutOfMemory();
+    for(int i=0 ; i<n ; i++) sets[i] = rdNewSet(full);
+    return sets;
+}
+
+static void rdFreeSets(rdWord** sets , int n){
+    if(sets == NULL) return;
+    for(int i=0 ; i<n ; i++) free(sets[i]);
+    free(sets);
+}
+
+static void rdSetBit(rdWord* set , int bit){
+    set[bit / 64] |= (1ULL << (bit % 64));
+}
+
+// ----- variables -----
+
+static int rdFindVarSlot(char* name){
+    int mask = rdVarSlotCount - 1;
+    int slot = hashString(name) & mask;
+
+    while(rdVarSlot[slot] != -1 && !isStringSame(rdVarName[rdVarSlot[slot]] , name)){
+        slot = (slot + 1) & mask; // linear probing
+    }
+
+    return slot;
+}
+
+// index of a scalar variable (-1 for constants and unknown names)
+static int rdVarIndex(char* name){
+    if(name[0] == '\0' || isConstant(name)) return -1;
+    return rdVarSlot[rdFindVarSlot(name)];
+}
+
+static int rdAddVar(char* name){
+    if(name[0] == '\0' || isConstant(name) || !isVariable(name)) return -1;
+
+    int slot = rdFindVarSlot(name);
+    if(rdVarSlot[slot] == -1){
+        strcpy(rdVarName[rdVarCount] , name);
+        rdVarSlot[slot] = rdVarCount++;
+    }
+    return rdVarSlot[slot];
+}
+
+// name defined by the instruction (scalar definitions only)
+static char* rdDefinedName(address* addr){
+    if(addr->type == ADDR_ARRAY_WRITE) return NULL;
+    return getLeftSideOfKindOfAssign(addr);
+}
+
+// operands read by the instruction, returns their number
+static int rdUsesOf(address* addr , char** uses){
+    switch(addr->type){
+        case ADDR_ASSIGN :
+            uses[0] = addr->assign.arg1;
+            return 1;
+        case ADDR_BINOP :
+            uses[0] = addr->binop.arg1;
+            uses[1] = addr->binop.arg2;
+            return 2;
+        case ADDR_UNOP :
+            uses[0] = addr->unop.arg1;
+            return 1;
+        case ADDR_ARRAY_READ :
+            uses[0] = addr->array_read.index;
+            return 1;
+        case ADDR_ARRAY_WRITE :
+            uses[0] = addr->array_write.index;
+            uses[1] = addr->array_write.value;
+            return 2;
+        case ADDR_IF_F_GOTO :
+            uses[0] = addr->if_false.condition;
+            return 1;
+        case ADDR_IF_T_GOTO :
+            uses[0] = addr->if_true.condition;
+            return 1;
+        default :
+            return 0;
+    }
+}
+
+// ----- building one analysis version -----
+
+static void rdNumberDefinitions(){
+    int n = countInstructionsInBlocks();
+
+    rdBlockStart = (int*)malloc((block_count + 1) * sizeof(int));
+    rdInstrDef = (int*)malloc((n + 1) * sizeof(int));
+    rdDefAddr = (address**)malloc((n + 1) * sizeof(address*));
+    rdDefBlock = (int*)malloc((n + 1) * sizeof(int));
+    rdDefVar = (int*)malloc((n + 1) * sizeof(int));
+    rdDefSourceDef = (int*)malloc((n + 1) * sizeof(int));
+    rdDefSourceVar = (int*)malloc((n + 1) * sizeof(int));
+    rdDefValue = malloc((n + 1) * sizeof(*rdDefValue));
+    rdDefState = (char*)calloc(n + 1 , sizeof(char));
+
+    // every instruction names at most 3 scalars
+    rdVarSlotCount = 16;
+    while(rdVarSlotCount < 6*n + 8) rdVarSlotCount *= 2;
+    rdVarSlot = (int*)malloc(rdVarSlotCount * sizeof(int));
+    rdVarName = malloc((3*n + 4) * sizeof(*rdVarName));
+
+    if(!rdBlockStart || !rdInstrDef || !rdDefAddr || !rdDefBlock || !rdDefVar || !rdDefSourceDef ||
+       !rdDefSourceVar || !rdDefValue || !rdDefState || !rdVarSlot || !rdVarName) rdOutOfMemory();
+
+    for(int i=0 ; i<rdVarSlotCount ; i++) rdVarSlot[i] = -1;
+    rdVarCount = 0;
+    rdDefCount = 0;
+
+    int k = 0;
+    for(int i=0 ; i<block_count ; i++){
+        rdBlockStart[i] = k;
+        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++ , k++){
+            address* addr = allBlocks[i]->list[j];
+            char* uses[2];
+            int useCount = rdUsesOf(addr , uses);
+            for(int u=0 ; u<useCount ; u++) rdAddVar(uses[u]);
+
+            rdInstrDef[k] = -1;
+            char* name = rdDefinedName(addr);
+            if(name == NULL) continue;
+
+            int var = rdAddVar(name);
+            if(var == -1) continue;
+
+            int d = rdDefCount++;
+            rdInstrDef[k] = d;
+            rdDefAddr[d] = addr;
+            rdDefBlock[d] = i;
+            rdDefVar[d] = var;
+            rdDefSourceVar[d] = -1;
+            rdDefSourceDef[d] = -1;
+
+            // x = y with y a different variable is a copy
+            if(addr->type == ADDR_ASSIGN && !isStringSame(addr->assign.arg1 , addr->assign.result)){
+                rdDefSourceVar[d] = rdAddVar(addr->assign.arg1);
+            }
+        }
+    }
+    rdBlockStart[block_count] = k;
+
+    rdWords = (rdDefCount + 63) / 64;
+}
+
+static void rdComputeLocalSets(){
+    rdVarDefs = rdNewSets(rdVarCount , false);
+    rdVarCopies = rdNewSets(rdVarCount , false);
+    for(int d=0 ; d<rdDefCount ; d++){
+        rdSetBit(rdVarDefs[rdDefVar[d]] , d);
+        if(rdDefSourceVar[d] != -1){
+            rdSetBit(rdVarCopies[rdDefVar[d]] , d);
+            rdSetBit(rdVarCopies[rdDefSourceVar[d]] , d);
+        }
+    }
+
+    rdGen = rdNewSets(block_count , false);
+    rdKill = rdNewSets(block_count , false);
+    rdCopyGen = rdNewSets(block_count , false);
+    rdCopyKill = rdNewSets(block_count , false);
+
+    rdLocalDef = (int*)malloc((rdVarCount + 1) * sizeof(int));
+    if(!rdLocalDef) rdOutOfMemory();
+    for(int v=0 ; v<rdVarCount ; v++) rdLocalDef[v] = -1;
+
+    for(int i=0 ; i<block_count ; i++){
+        for(int k=rdBlockStart[i] ; k<rdBlockStart[i+1] ; k++){
+            int d = rdInstrDef[k];
+            if(d == -1) continue;
+
+            // the copy source as seen at the copy
+            if(rdDefSourceVar[d] != -1) rdDefSourceDef[d] = rdLocalDef[rdDefSourceVar[d]];
+            rdLocalDef[rdDefVar[d]] = d;
+
+            // reaching definitions: d replaces every other definition of the same variable
+            for(int w=0 ; w<rdWords ; w++){
+                rdGen[i][w] &= ~rdVarDefs[rdDefVar[d]][w];
+                rdKill[i][w] |= rdVarDefs[rdDefVar[d]][w];
+                rdCopyGen[i][w] &= ~rdVarCopies[rdDefVar[d]][w];
+                rdCopyKill[i][w] |= rdVarCopies[rdDefVar[d]][w];
+            }
+            rdSetBit(rdGen[i] , d);
+            if(rdDefSourceVar[d] != -1) rdSetBit(rdCopyGen[i] , d);
+        }
+
+        // reset the local table for the next block
+        for(int k=rdBlockStart[i] ; k<rdBlockStart[i+1] ; k++){
+            if(rdInstrDef[k] != -1) rdLocalDef[rdDefVar[rdInstrDef[k]]] = -1;
+        }
+    }
+}
+
+// reaching definitions (union over predecessors) and available copies (intersection)
+static void rdSolveDataflow(){
+    rdIn = rdNewSets(block_count , false);
+    rdOut = rdNewSets(block_count , false);
+    rdCopyIn = rdNewSets(block_count , false);
+    rdCopyOut = rdNewSets(block_count , true);
+
+    for(int i=0 ; i<block_count ; i++){
+        for(int w=0 ; w<rdWords ; w++) rdOut[i][w] = rdGen[i][w];
+    }
+
+    bool changed = true;
+    while(changed){
+        changed = false;
+
+        for(int i=0 ; i<block_count ; i++){
+            block* currBlock = allBlocks[i];
+
+            for(int w=0 ; w<rdWords ; w++){
+                rdWord in = 0ULL;
+                rdWord copyIn = (i == 0 || currBlock->numCFGIn == 0) ? 0ULL : ~0ULL;
+
+                for(int p=0 ; p<currBlock->numCFGIn ; p++){
+                    int pred = findIndexOfBlock(currBlock->cfg_in[p]);
+                    in |= rdOut[pred][w];
+                    if(i != 0) copyIn &= rdCopyOut[pred][w];
+                }
+
+                rdWord out = rdGen[i][w] | (in & ~rdKill[i][w]);
+                rdWord copyOut = rdCopyGen[i][w] | (copyIn & ~rdCopyKill[i][w]);
+
+                if(out != rdOut[i][w] || copyOut != rdCopyOut[i][w]) changed = true;
+                rdIn[i][w] = in;
+                rdOut[i][w] = out;
+                rdCopyIn[i][w] = copyIn;
+                rdCopyOut[i][w] = copyOut;
+            }
+        }
+    }
+}
+
+static void buildDefinitionResolver(){
+    rdNumberDefinitions();
+    rdComputeLocalSets();
+    rdSolveDataflow();
+}
+
+static void releaseDefinitionResolver(){
+    rdFreeSets(rdVarDefs , rdVarCount);
+    rdFreeSets(rdVarCopies , rdVarCount);
+    rdFreeSets(rdGen , block_count);
+    rdFreeSets(rdKill , block_count);
+    rdFreeSets(rdIn , block_count);
+    rdFreeSets(rdOut , block_count);
+    rdFreeSets(rdCopyGen , block_count);
+    rdFreeSets(rdCopyKill , block_count);
+    rdFreeSets(rdCopyIn , block_count);
+    rdFreeSets(rdCopyOut , block_count);
+    rdVarDefs = rdVarCopies = rdGen = rdKill = rdIn = rdOut = NULL;
+    rdCopyGen = rdCopyKill = rdCopyIn = rdCopyOut = NULL;
+
+    free(rdBlockStart);
+    free(rdInstrDef);
+    free(rdDefAddr);
+    free(rdDefBlock);
+    free(rdDefVar);
+    free(rdDefSourceDef);
+    free(rdDefSourceVar);
+    free(rdDefValue);
+    free(rdDefState);
+    free(rdVarSlot);
+    free(rdVarName);
+    free(rdLocalDef);
+    rdBlockStart = rdInstrDef = rdDefBlock = rdDefVar = rdDefSourceDef = rdDefSourceVar = NULL;
+    rdVarSlot = rdLocalDef = NULL;
+    rdDefAddr = NULL;
+    rdDefValue = NULL;
+    rdDefState = NULL;
+    rdVarName = NULL;
+}
+
+// ----- resolving values -----
+
+static char* rdValueOfDefinition(int d);
+
+// constant that variable var holds on entry of block b (NULL if not one constant)
+static char* rdValueOnEntry(int b , int var){
+    char* value = NULL;
+
+    for(int w=0 ; w<rdWords ; w++){
+        rdWord reaching = rdIn[b][w] & rdVarDefs[var][w];
+        while(reaching){
+            int d = w*64 + __builtin_ctzll(reaching);
+            reaching &= reaching - 1;
+
+            char* current = rdValueOfDefinition(d);
+            if(current == NULL) return NULL;
+            if(value && !isStringSame(value , current)) return NULL;
+            value = current;
+        }
+    }
+
+    return value;
+}
+
+// constant the definition stores (NULL if not a constant), computed once per analysis version
+static char* rdValueOfDefinition(int d){
+    if(rdDefState[d] == RD_RESOLVED) return rdDefValue[d][0] ? rdDefValue[d] : NULL;
+
+    // a copy cycle (x = y ... y = x in a loop) never proves a constant
+    if(rdDefState[d] == RD_RESOLVING) return NULL;
+    rdDefState[d] = RD_RESOLVING;
+
+    address* addr = rdDefAddr[d];
+    char* value = NULL;
+
+    if(addr->type == ADDR_ASSIGN){
+        if(isConstant(addr->assign.arg1)){
+            value = addr->assign.arg1;
+        } else if(rdDefSourceVar[d] != -1){
+            value = (rdDefSourceDef[d] != -1) ? rdValueOfDefinition(rdDefSourceDef[d])
+                                              : rdValueOnEntry(rdDefBlock[d] , rdDefSourceVar[d]);
+        }
+    }
+
+    rdDefValue[d][0] = '\0';
+    if(value){
+        // an int stored into a double variable is a double
+        if(isInteger(value) && getTypeOfOperand(rdVarName[rdDefVar[d]]) == KEYWORD_DOUBLE){
+            formatDoubleConstant((double)stringToInt(value) , rdDefValue[d]);
+        } else{
+            strcpy(rdDefValue[d] , value);
+        }
+    }
+    rdDefState[d] = RD_RESOLVED;
+
+    return rdDefValue[d][0] ? rdDefValue[d] : NULL;
+}
+
+// ----- propagation passes -----
+
+// replace every variable operand by the constant it always holds at that point
+void checkForConstantPropagation(){
+    buildDefinitionResolver();
+
+    for(int i=0 ; i<block_count ; i++){
+        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
+            address* addr = allBlocks[i]->list[j];
+            char* uses[2];
+            int useCount = rdUsesOf(addr , uses);
+
+            for(int u=0 ; u<useCount ; u++){
+                int var = rdVarIndex(uses[u]);
+                if(var == -1) continue;
+
+                char* value = (rdLocalDef[var] != -1) ? rdValueOfDefinition(rdLocalDef[var]) : rdValueOnEntry(i , var);
+                if(value == NULL || !hasOptimizationFuel()) continue;
+
+                strcpy(uses[u] , value);
+                burnOptimizationFuel();
+                flag = true;
+            }
+
+            int d = rdInstrDef[rdBlockStart[i] + j];
+            if(d != -1) rdLocalDef[rdDefVar[d]] = d;
+        }
+
+        // reset the local table for the next block
+        for(int k=rdBlockStart[i] ; k<rdBlockStart[i+1] ; k++){
+            if(rdInstrDef[k] != -1) rdLocalDef[rdDefVar[rdInstrDef[k]]] = -1;
+        }
+    }
+
+    releaseDefinitionResolver();
+}
+
+// replace x by y where the copy x = y is available
+void checkForCopyPropagation(){
+    buildDefinitionResolver();
+
+    rdWord* available = rdNewSet(false);
+
+    for(int i=0 ; i<block_count ; i++){
+        for(int w=0 ; w<rdWords ; w++) available[w] = rdCopyIn[i][w];
+
+        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
+            address* addr = allBlocks[i]->list[j];
+            char* uses[2];
+            int useCount = rdUsesOf(addr , uses);
+
+            for(int u=0 ; u<useCount ; u++){
+                int var = rdVarIndex(uses[u]);
+                if(var == -1) continue;
+
+                // an available copy that defines var (at most one can be available)
+                for(int w=0 ; w<rdWords ; w++){
+                    rdWord copies = available[w] & rdVarCopies[var][w] & rdVarDefs[var][w];
+                    if(!copies) continue;
+
+                    int c = w*64 + __builtin_ctzll(copies);
+                    if(hasOptimizationFuel()){
+                        strcpy(uses[u] , rdVarName[rdDefSourceVar[c]]);
+                        burnOptimizationFuel();
+                    }
+                    break;
+                }
+            }
+
+            int d = rdInstrDef[rdBlockStart[i] + j];
+            if(d == -1) continue;
+
+            // defining x ends every copy into or out of x, a copy starts a new one
+            for(int w=0 ; w<rdWords ; w++) available[w] &= ~rdVarCopies[rdDefVar[d]][w];
+            if(rdDefSourceVar[d] != -1) rdSetBit(available , d);
+        }
+    }
+
+    free(available);
+    releaseDefinitionResolver();
+}
@@ -0,0 +1,421 @@
+/**
+ * 05_07_passManager.c - Optimization Pass Manager
+ *
+ * This module decides which optimization passes run, in which order and how
+ * often. Every pass is registered under a short name; a pipeline is a comma
+ * separated list of these names. A group in brackets followed by "*N" is
+ * repeated (at most N times) until one round changes nothing.
+ *
+ * Features:
+ * - Named, registrable passes (registerOptimizationPass)
+ * - Presets -O0 (no passes), -O1 (cheap local passes), -O2 (default), -O3
+ * - "--passes=" overrides the preset with any pipeline
+ * - Per step statistics: runs, wall time, instruction count before/after and
+ *   whether the pass changed the code (compared by a fingerprint of the blocks)
+ * - Optimization budget: "--opt-fuel=N" allows at most N transformations,
+ *   "--opt-time=MS" stops optimizing after MS milliseconds. Passes ask
+ *   hasOptimizationFuel() before every transformation and simply skip it when
+ *   the budget is gone, so the code stays valid; remaining steps are skipped.
+ *   (an analysis that already started, e.g. live variables, is finished first)
+ *
+ * Example:
+ *   --passes=sccp,cfg,(constprop,fold,copyprop)*3,dce,cfg
+ *
+ * Author: Ridham Khurana
+ */
+
+#include "database.h"
+#include <time.h>
+
+// pipelines of the -O levels
+static const char* pmPresets[4] = {
+    "",
+    "fold,algebraic,lvn,dce,cfg",
+    "sccp,cfg,(constprop,fold,algebraic,lvn,copyprop)*5,pre,cfg,dce,cfg",
+    "sccp,cfg,(constprop,fold,algebraic,lvn,copyprop)*10,pre,cfg,(constprop,fold,algebraic,lvn,copyprop)*10,dce,cfg"
+};
+
+// highest N of a group "(...)*N"
+#define PM_MAX_REPEAT 100
+
+// one step of the pipeline
+typedef struct pmStep{
+    int pass;       // index into the registered passes
+    int groupSize;  // >0 on the first step of a group: number of steps in the group
+    int repeat;     // maximum rounds of the group
+} pmStep;
+
+static optPass pmPasses[MAX_OPT_PASSES];
+static int pm_pass_count = 0;
+
+static pmStep pmSteps[MAX_STATEMENTS];
+static int pm_step_count = 0;
+
+int opt_level = 2;                      // -O level given on the command line
+char opt_pipeline_name[MAX_NAME] = "";  // "-O2" or "--passes" (shown in the statistics)
+
+long long opt_fuel_limit = -1;          // maximum transformations (-1 = unlimited)
+double opt_time_limit_ms = -1;          // maximum optimization time (-1 = unlimited)
+long long opt_fuel_used = 0;            // transformations done by the last pipeline
+bool opt_budget_exhausted = false;      // true once fuel or time ran out
+
+static double pm_budget_start = 0;      // time the pipeline started
+static int pm_fuel_checks = 0;          // calls since the clock was last read
+
+// ---------------- built-in passes ----------------
+
+static void pmRunSCCP(char* detail){
+    startSparseConditionalConstPhase();
+    snprintf(detail , MAX_NAME , "%d branches pruned, %d blocks removed" , sccp_branches_pruned , sccp_blocks_removed);
+}
+
+static void pmRunCFG(char* detail){
+    simplifyControlFlowGraph();
+    snprintf(detail , MAX_NAME , "%d threaded, %d jumps, %d blocks removed" , cfg_jumps_threaded , cfg_jumps_removed , cfg_blocks_removed);
+}
+
+static void pmRunConstProp(char* detail){
+    (void)detail;
+    checkForConstantPropagation();
+}
+
+static void pmRunFold(char* detail){
+    (void)detail;
+    checkForConstantFolding();
+}
+
+static void pmRunAlgebraic(char* detail){
+    (void)detail;
+    checkForAlgebraicSimplification();
+}
+
+static void pmRunLVN(char* detail){
+    (void)detail;
+    checkForLocalValueNumbering();
+}
+
+static void pmRunCopyProp(char* detail){
+    (void)detail;
+    checkForCopyPropagation();
+}
+
+static void pmRunPRE(char* detail){
+    startPartialRedundancyPhase();
+    snprintf(detail , MAX_NAME , "%d evaluations replaced, %d inserted" , pre_replaced_count , pre_inserted_count);
+}
+
+static void pmRunDCE(char* detail){
+    startLiveVaraiblePhase();
+    snprintf(detail , MAX_NAME , "%d removed, %d of %d blocks re-solved" , live_dead_removed , live_blocks_solved , live_blocks_seen);
+}
+
+static void pmRegisterBuiltinPasses(){
+    if(pm_pass_count > 0) return;
+
+    registerOptimizationPass("sccp" , "Sparse Cond. Const Prop" , pmRunSCCP);
+    registerOptimizationPass("cfg" , "CFG Simplification" , pmRunCFG);
+    registerOptimizationPass("constprop" , "Constant Propagation" , pmRunConstProp);
+    registerOptimizationPass("fold" , "Constant Folding" , pmRunFold);
+    registerOptimizationPass("algebraic" , "Algebraic Simplification" , pmRunAlgebraic);
+    registerOptimizationPass("lvn" , "Local Value Numbering" , pmRunLVN);
+    registerOptimizationPass("copyprop" , "Copy Propagation" , pmRunCopyProp);
+    registerOptimizationPass("pre" , "Partial Redundancy Elim" , pmRunPRE);
+    registerOptimizationPass("dce" , "Dead Code Elimination" , pmRunDCE);
+}
+
+void registerOptimizationPass(char* name , char* title , OptPassFunc run){
+    if(pm_pass_count >= MAX_OPT_PASSES){
+        printf("05 || Optimization error [05.15] -> Too many optimization passes registered\n");
+        exit(5);
+    }
+
+    optPass* pass = &pmPasses[pm_pass_count++];
+    strncpy(pass->name , name , MAX_NAME - 1);
+    pass->name[MAX_NAME - 1] = '\0';
+    strncpy(pass->title , title , MAX_NAME - 1);
+    pass->title[MAX_NAME - 1] = '\0';
+    pass->run = run;
+}
+
+static int pmFindPass(const char* name){
+    for(int i=0 ; i<pm_pass_count ; i++){
+        if(strcmp(pmPasses[i].name , name) == 0) return i;
+    }
+    return -1;
+}
+
+// ---------------- pipeline parsing ----------------
+
+// parse a pipeline like "sccp,cfg,(fold,lvn)*5,dce"
+// returns NULL on success, otherwise a message describing the problem
+static char* pmParsePipeline(const char* spec){
+    static char message[2 * MAX_NAME];
+    char name[MAX_NAME];
+    int groupStart = -1;
+
+    pmRegisterBuiltinPasses();
+    pm_step_count = 0;
+
+    const char* p = spec;
+    while(*p){
+        if(*p == ','){ p++; continue; }
+
+        // opening bracket starts a group
+        if(*p == '('){
+            if(groupStart != -1) return "Nested pass groups are not supported";
+            groupStart = pm_step_count;
+            p++;
+            if(*p == '(') return "Nested pass groups are not supported";
+        }
+
+        int len = 0;
+        while(*p && *p != ',' && *p != '(' && *p != ')' && len < MAX_NAME - 1) name[len++] = *p++;
+        name[len] = '\0';
+
+        if(len == 0){
+            snprintf(message , sizeof(message) , "Empty pass name in '%s'" , spec);
+            return message;
+        }
+
+        int pass = pmFindPass(name);
+        if(pass == -1){
+            snprintf(message , sizeof(message) , "Unknown optimization pass '%s'" , name);
+            return message;
+        }
+        if(pm_step_count >= MAX_STATEMENTS) return "Too many steps in the pass pipeline";
+
+        pmSteps[pm_step_count].pass = pass;
+        pmSteps[pm_step_count].groupSize = 0;
+        pmSteps[pm_step_count].repeat = 1;
+        pm_step_count++;
+
+        // closing bracket ends the group, optionally followed by *N
+        if(*p == ')'){
+            if(groupStart == -1) return "')' without matching '('";
+            p++;
+
+            int repeat = 1;
+            if(*p == '*'){
+                p++;
+                if(!isdigit((unsigned char)*p)) return "Expected a number after '*'";
+                repeat = 0;
+                while(isdigit((unsigned char)*p)){
+                    repeat = repeat * 10 + (*p++ - '0');
+                    if(repeat > PM_MAX_REPEAT) break;
+                }
+                if(repeat < 1) return "A pass group must repeat at least once ('*0')";
+                if(repeat > PM_MAX_REPEAT){
+                    snprintf(message , sizeof(message) , "A pass group repeats at most %d times" , PM_MAX_REPEAT);
+                    return message;
+                }
+            }
+
+            pmSteps[groupStart].groupSize = pm_step_count - groupStart;
+            pmSteps[groupStart].repeat = repeat;
+            groupStart = -1;
+        }
+
+        if(*p && *p != ',') {
+            snprintf(message , sizeof(message) , "Unexpected '%c' in '%s'" , *p , spec);
+            return message;
+        }
+    }
+
+    if(groupStart != -1) return "'(' without matching ')'";
+
+    return NULL;
+}
+
+// select the pipeline of an -O level (0 to 3)
+void setOptimizationLevel(int level){
+    if(level < 0) level = 0;
+    if(level > 3) level = 3;
+
+    opt_level = level;
+    snprintf(opt_pipeline_name , MAX_NAME , "-O%d" , level);
+    pmParsePipeline(pmPresets[level]);
+}
+
+// select a custom pipeline, returns NULL on success or the error message
+char* setOptimizationPipeline(const char* spec){
+    char* error = pmParsePipeline(spec);
+    if(error == NULL) snprintf(opt_pipeline_name , MAX_NAME , "--passes");
+    return error;
+}
+
+// names of all registered passes separated by ", " (for usage messages)
+void getOptimizationPassNames(char* out , int size){
+    pmRegisterBuiltinPasses();
+
+    out[0] = '\0';
+    for(int i=0 ; i<pm_pass_count ; i++){
+        if(i > 0) strncat(out , ", " , size - strlen(out) - 1);
+        strncat(out , pmPasses[i].name , size - strlen(out) - 1);
+    }
+}
+
+// ---------------- budget ----------------
+
+static double pmNowMs(){
+    struct timespec ts;
+    timespec_get(&ts , TIME_UTC);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// limit the next pipeline to 'fuel' transformations and 'timeMs' milliseconds (-1 = unlimited)
+void setOptimizationBudget(long long fuel , double timeMs){
+    opt_fuel_limit = fuel;
+    opt_time_limit_ms = timeMs;
+}
+
+// may the running pass do one more transformation?
+bool hasOptimizationFuel(){
+    if(opt_budget_exhausted) return false;
+
+    if(opt_fuel_limit >= 0 && opt_fuel_used >= opt_fuel_limit){
+        opt_budget_exhausted = true;
+        return false;
+    }
+
+    // reading the clock for every instruction is too slow, check every 64 calls
+    if(opt_time_limit_ms >= 0 && (pm_fuel_checks++ & 63) == 0){
+        if(pmNowMs() - pm_budget_start >= opt_time_limit_ms){
+            opt_budget_exhausted = true;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// count one transformation done by the running pass
+// (atomic: block-local passes may run on several threads, see 05_08)
+void burnOptimizationFuel(){
+    __atomic_fetch_add(&opt_fuel_used , 1 , __ATOMIC_RELAXED);
+}
+
+// true if a new step may start (the clock is always read here)
+static bool pmBudgetLeft(){
+    pm_fuel_checks = 0;
+    return hasOptimizationFuel();
+}
+
+// ---------------- running ----------------
+
+// fingerprint of all blocks: changes whenever an instruction, its order or a block boundary changes
+static unsigned long long pmFingerprint(){
+    unsigned long long hash = 14695981039346656037ULL;
+
+    for(int i=0 ; i<block_count ; i++){
+        hash ^= hashOfBlock(allBlocks[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+// run one step, add its numbers to the statistics row of the step; returns true if it changed the code
+static bool pmRunStep(int s){
+    optPass* pass = &pmPasses[pmSteps[s].pass];
+    optPhaseStat* stat = &optPhaseStats[s];
+    char detail[MAX_NAME] = "";
+
+    unsigned long long before = pmFingerprint();
+    double start = pmNowMs();
+
+    pass->run(detail);
+
+    stat->timeMs += pmNowMs() - start;
+    stat->instructionsAfter = countInstructionsInBlocks();
+    stat->runs++;
+
+    bool changed = (pmFingerprint() != before);
+    if(changed || stat->runs == 1){
+        strncpy(stat->detail , detail , MAX_NAME - 1);
+        stat->detail[MAX_NAME - 1] = '\0';
+    }
+    if(changed) stat->changed = true;
+    if(opt_budget_exhausted) stat->outOfBudget = true;
+
+    return changed;
+}
+
+// run the selected pipeline over allBlocks, one statistics row per step
+void runOptimizationPipeline(){
+    if(opt_pipeline_name[0] == '\0') setOptimizationLevel(opt_level);
+
+    opt_fuel_used = 0;
+    opt_budget_exhausted = false;
+    pm_budget_start = pmNowMs();
+
+    // one row per step, filled while the steps run
+    opt_phase_count = 0;
+    for(int s=0 ; s<pm_step_count ; s++){
+        recordOptPhaseStat(pmPasses[pmSteps[s].pass].title , 0 , 0 , "");
+        optPhaseStats[s].instructionsBefore = -1;
+    }
+
+    int s = 0;
+    while(s < pm_step_count){
+        int size = (pmSteps[s].groupSize > 0) ? pmSteps[s].groupSize : 1;
+
+        for(int round=0 ; round<pmSteps[s].repeat ; round++){
+            bool changed = false;
+            for(int k=s ; k<s+size ; k++){
+                if(optPhaseStats[k].instructionsBefore == -1) optPhaseStats[k].instructionsBefore = countInstructionsInBlocks();
+                if(!pmBudgetLeft()) break;
+                changed |= pmRunStep(k);
+            }
+            if(!changed || opt_budget_exhausted) break; // fixpoint of the group reached
+        }
+
+        s += size;
+    }
+
+    // steps that never ran because the budget was gone
+    for(int k=0 ; k<pm_step_count ; k++){
+        if(optPhaseStats[k].runs == 0 && opt_budget_exhausted) optPhaseStats[k].skipped = true;
+        if(optPhaseStats[k].instructionsBefore == -1) optPhaseStats[k].instructionsBefore = countInstructionsInBlocks();
+        if(optPhaseStats[k].runs == 0) optPhaseStats[k].instructionsAfter = optPhaseStats[k].instructionsBefore;
+    }
+
+    // keep the linear instruction list in sync with the blocks
+    rebuildAddressListFromBlocks();
+}
+
+// per-step statistics of the last pipeline to stdout
+void printOptimizationPassStats(){
+    printf("   Pass pipeline (%s): %d steps\n", opt_pipeline_name, opt_phase_count);
+
+    for(int i=0 ; i<opt_phase_count ; i++){
+        optPhaseStat* stat = &optPhaseStats[i];
+        if(stat->runs == 0 && !stat->skipped) continue;
+
+        printf("   %s %-24s x%-2d %8.3f ms  %4d -> %-4d  %s%s\n",
+               (i == opt_phase_count - 1) ? "└─" : "├─",
+               stat->name, stat->runs, stat->timeMs,
+               stat->instructionsBefore, stat->instructionsAfter,
+               stat->skipped ? "skipped" : (stat->changed ? "changed" : "no change"),
+               stat->outOfBudget ? " (ran out of budget)" : "");
+    }
+
+    if(opt_budget_exhausted){
+        printf("   ⚠ Optimization budget exhausted: %s\n", getOptimizationBudgetSummary());
+    }
+}
+
+// "fuel 120/120, 3.2 ms" style summary of the budget of the last pipeline
+char* getOptimizationBudgetSummary(){
+    static char summary[2 * MAX_NAME];
+    char fuel[MAX_NAME / 2];
+    char time[MAX_NAME / 2];
+
+    if(opt_fuel_limit >= 0) snprintf(fuel , sizeof(fuel) , "fuel %lld/%lld" , opt_fuel_used , opt_fuel_limit);
+    else snprintf(fuel , sizeof(fuel) , "fuel %lld (no limit)" , opt_fuel_used);
+
+    if(opt_time_limit_ms >= 0) snprintf(time , sizeof(time) , "time limit %.3f ms" , opt_time_limit_ms);
+    else snprintf(time , sizeof(time) , "no time limit");
+
+    snprintf(summary , sizeof(summary) , "%s, %s" , fuel , time);
+    return summary;
+}
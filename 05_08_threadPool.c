@@ -0,0 +1,130 @@
+/**
+ * 05_08_threadPool.c - Thread Pool for Block-Local Phases
+ *
+ * Several optimization phases look at one basic block at a time and change
+ * nothing but that block: constant folding, local value numbering, the
+ * GEN/KILL sets of both data flow analyses and the DCE sweep. This module
+ * runs such a phase on a fixed number of threads.
+ *
+ * Features:
+ * - Fixed-size pool ("--threads=N", default 1: tester/bench_threads.sh showed
+ *   no consistent speedup for the largest programs the token buffer holds);
+ *   the workers are started once and then wait for the next phase
+ * - Blocks are handed out in small chunks, the calling thread works as well
+ * - Deterministic: every block is processed exactly as in a sequential run
+ *   and the per-block results are added up, so the output never depends on N
+ * - Small programs, and runs with an optimization budget (the budget decides
+ *   which transformations happen in program order), run on the calling thread
+ *
+ * Example:
+ *   ./RMc4 prog.c compiler_output.txt --threads=4
+ *
+ * Author: Ridham Khurana
+ */
+
+#include "database.h"
+#include <pthread.h>
+
+#define POOL_CHUNK 16          // blocks a thread takes at a time
+#define POOL_MIN_BLOCKS 64     // fewer blocks are not worth waking the workers
+
+int opt_thread_count = 1;      // threads per phase incl. the calling one
+
+static pthread_t pool_threads[MAX_OPT_THREADS];
+static int pool_started = 0;   // workers running (the calling thread not counted)
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t pool_done = PTHREAD_COND_INITIALIZER;
+
+// the phase being run
+static BlockWorkFunc pool_work = NULL;
+static int pool_block_total = 0;
+static int pool_next_block = 0;          // start of the next chunk (atomic)
+static long long pool_result = 0;        // sum of the per-block results (atomic)
+static unsigned int pool_generation = 0; // counts the phases, wakes the workers
+static int pool_busy = 0;                // workers not yet done with the phase
+
+void setOptimizationThreads(int n){
+    if(n < 1) n = 1;
+    if(n > MAX_OPT_THREADS) n = MAX_OPT_THREADS;
+    opt_thread_count = n;
+}
+
+int getOptimizationThreads(){
+    return opt_thread_count;
+}
+
+// take chunks of blocks until none is left
+static void poolRunChunks(){
+    while(true){
+        int start = __atomic_fetch_add(&pool_next_block , POOL_CHUNK , __ATOMIC_RELAXED);
+        if(start >= pool_block_total) return;
+
+        int end = (start + POOL_CHUNK < pool_block_total) ? start + POOL_CHUNK : pool_block_total;
+        long long sum = 0;
+        for(int i=start ; i<end ; i++) sum += pool_work(i);
+
+        __atomic_fetch_add(&pool_result , sum , __ATOMIC_RELAXED);
+    }
+}
+
+static void* poolWorker(void* unused){
+    unsigned int seen = 0;
+    (void)unused;
+
+    while(true){
+        pthread_mutex_lock(&pool_lock);
+        while(pool_generation == seen) pthread_cond_wait(&pool_wake , &pool_lock);
+        seen = pool_generation;
+        pthread_mutex_unlock(&pool_lock);
+
+        poolRunChunks();
+
+        pthread_mutex_lock(&pool_lock);
+        if(--pool_busy == 0) pthread_cond_signal(&pool_done);
+        pthread_mutex_unlock(&pool_lock);
+    }
+
+    return NULL;
+}
+
+// start the workers once (if the system refuses a thread, the pool is simply smaller)
+static void poolStart(int workers){
+    while(pool_started < workers){
+        if(pthread_create(&pool_threads[pool_started] , NULL , poolWorker , NULL) != 0) break;
+        pool_started++;
+    }
+}
+
+// run work(i) for every block i, returns the sum of the results
+long long runOnAllBlocks(BlockWorkFunc work){
+    int threads = getOptimizationThreads();
+    bool budget = (opt_fuel_limit >= 0 || opt_time_limit_ms >= 0);
+
+    if(threads <= 1 || block_count < POOL_MIN_BLOCKS || budget){
+        long long sum = 0;
+        for(int i=0 ; i<block_count ; i++) sum += work(i);
+        return sum;
+    }
+
+    poolStart(threads - 1);
+
+    pthread_mutex_lock(&pool_lock);
+    pool_work = work;
+    pool_block_total = block_count;
+    pool_next_block = 0;
+    pool_result = 0;
+    pool_busy = pool_started;
+    pool_generation++;
+    pthread_cond_broadcast(&pool_wake);
+    pthread_mutex_unlock(&pool_lock);
+
+    poolRunChunks();
+
+    pthread_mutex_lock(&pool_lock);
+    while(pool_busy > 0) pthread_cond_wait(&pool_done , &pool_lock);
+    pthread_mutex_unlock(&pool_lock);
+
+    return pool_result;
+}
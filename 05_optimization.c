@@ -10,8 +10,12 @@
  * - Constant folding and propagation
  * - Dead code elimination (DCE)
  * - Copy propagation
- * - Common subexpression elimination
+ * - Common subexpression elimination (local value numbering, see 05_01)
+ * - Algebraic simplification and strength reduction (rule table, see 05_03)
  * - Data flow analysis (reaching definitions, live variable analysis)
+ * - Incremental live variables: only changed blocks and the blocks that can
+ *   reach them are solved again (worklist)
+ * - Block-local phases (folding, GEN/KILL, the DCE sweep) run on the thread pool (05_08)
  * - Loop optimization considerations
  * 
  * Author: Ridham Khurana
@@ -24,10 +28,6 @@ int BlockId = 0;
 
 bool flag = false;
 
-int incomingCount = 0;
-
-address* mark[MAX];
-int markCount = 0;
 
 int stringToInt(char* str) {
     return atoi(str);
@@ -74,63 +74,139 @@ char* calculateConstFoldResultForBool(char* op , char* arg1 , char* arg2){
     return NULL;
 }
 
+char* calculateConstFoldResultForComparison(char* op , int order , char* result);
+
 // Perform constant folding - evaluate operations on integer constants at compile time
 // This reduces runtime computation by pre-calculating results
+// (64-bit arithmetic, the same width the generated code computes with)
 char* calculateConstFoldResultForInt(char* op , char* arg1 , char* arg2){
     char* result = (char*) malloc(MAX_NAME * sizeof(char));
-    int num1 = stringToInt(arg1);
-    int num2 = stringToInt(arg2);
+    long long num1 = atoll(arg1);
+    long long num2 = atoll(arg2);
 
     if(isStringSame(op,"+")){
-        sprintf(result, "%d", num1 + num2);
+        sprintf(result, "%lld", num1 + num2);
         return result;
     } else if(isStringSame(op,"-")){
-        sprintf(result, "%d", num1 - num2);
+        sprintf(result, "%lld", num1 - num2);
         return result;
     } else if(isStringSame(op,"*")){
-        sprintf(result, "%d", num1 * num2);
+        sprintf(result, "%lld", num1 * num2);
         return result;
     } else if(isStringSame(op,"/")) {
         if(num2 == 0){
             return NULL;
         }
-        sprintf(result, "%d", num1 / num2);
+        sprintf(result, "%lld", num1 / num2);
         return result;
-    } else if(isStringSame(op,">")){
-        if(num1 > num2){
-            strcpy(result , "true");
-            return result;
-        } else {
-            strcpy(result , "false");
-            return result;
-        }
+    } else if(isStringSame(op,"<<")){
+        if(num2 < 0 || num2 > 62) return NULL;
+        sprintf(result, "%lld", num1 << num2);
+        return result;
+    }
+
+    // comparisons
+    return calculateConstFoldResultForComparison(op , (num1 > num2) - (num1 < num2) , result);
+}
+
+// fold a comparison from the sign of (left - right): -1 less, 0 equal, 1 greater
+char* calculateConstFoldResultForComparison(char* op , int order , char* result){
+    bool value;
+
+    if(isStringSame(op,">")){
+        value = order > 0;
     } else if(isStringSame(op,"<")){
-        if(num1 < num2){
-            strcpy(result , "true");
-            return result;
-        } else {
-            strcpy(result , "false");
-            return result;
-        }
+        value = order < 0;
     } else if(isStringSame(op,">=")){
-        if(num1 >= num2){
-            strcpy(result , "true");
-            return result;
-        } else {
-            strcpy(result , "false");
-            return result;
-        }
+        value = order >= 0;
     } else if(isStringSame(op,"<=")){
-        if(num1 <= num2){
-            strcpy(result , "true");
-            return result;
-        } else {
-            strcpy(result , "false");
-            return result;
-        }
+        value = order <= 0;
+    } else if(isStringSame(op,"==")){
+        value = order == 0;
+    } else if(isStringSame(op,"!=")){
+        value = order != 0;
+    } else{
+        free(result);
+        return NULL;
     }
 
-    return NULL;
+    strcpy(result , value ? "true" : "false");
+    return result;
+}
+
+// numeric value of a constant as the generated code sees it (bool -> 0/1, char -> its code)
+double getNumericValueOfConstant(char* str){
+    if(isStringSame(str , "true")) return 1.0;
+    if(isStringSame(str , "false")) return 0.0;
+    if(isCharConstant(str)) return (double)(unsigned char)charConstantValue(str);
+    return strtod(str , NULL);
+}
+
+// Fold operations where at least one side is a double (IEEE double arithmetic)
+// The other side may be int or bool; results keep every digit (see formatDoubleConstant)
+char* calculateConstFoldResultForDouble(char* op , char* arg1 , char* arg2){
+    char* result = (char*) malloc(MAX_NAME * sizeof(char));
+    double num1 = getNumericValueOfConstant(arg1);
+    double num2 = getNumericValueOfConstant(arg2);
+    double value;
+
+    if(isStringSame(op,"+")){
+        value = num1 + num2;
+    } else if(isStringSame(op,"-")){
+        value = num1 - num2;
+    } else if(isStringSame(op,"*")){
+        value = num1 * num2;
+    } else if(isStringSame(op,"/")){
+        value = num1 / num2;
+    } else{
+        // comparisons
+        return calculateConstFoldResultForComparison(op , (num1 > num2) - (num1 < num2) , result);
+    }
+
+    // inf/nan have no constant form, leave them to run time
+    if(!isfinite(value)){
+        free(result);
+        return NULL;
+    }
+
+    formatDoubleConstant(value , result);
+    return result;
+}
+
+// Fold comparisons between chars, and between mixed int/char/bool constants
+char* calculateConstFoldResultForMixed(char* op , char* arg1 , char* arg2){
+    char* result = (char*) malloc(MAX_NAME * sizeof(char));
+    double num1 = getNumericValueOfConstant(arg1);
+    double num2 = getNumericValueOfConstant(arg2);
+
+    return calculateConstFoldResultForComparison(op , (num1 > num2) - (num1 < num2) , result);
+}
+
+// fold "arg1 op arg2" for two constants, NULL if it can not be folded
+char* foldConstantBinOp(char* op , char* arg1 , char* arg2){
+    if(isInteger(arg1) && isInteger(arg2)){
+        // both int
+        return calculateConstFoldResultForInt(op , arg1 , arg2);
+    } else if(!isInteger(arg1) && !isInteger(arg2) && !isDouble(arg1) && !isDouble(arg2) && !isCharConstant(arg1) && !isCharConstant(arg2)){
+        // both are bool (true/false)
+        return calculateConstFoldResultForBool(op , arg1 , arg2);
+    } else if(isDouble(arg1) || isDouble(arg2)){
+        // double arithmetic and comparisons (other side int/double/bool)
+        return calculateConstFoldResultForDouble(op , arg1 , arg2);
+    }
+
+    // char comparisons and mixed int/char/bool comparisons
+    return calculateConstFoldResultForMixed(op , arg1 , arg2);
+}
+
+// fold "op arg1" for a constant, NULL if it can not be folded (only NOT operator exists)
+char* foldConstantUnOp(char* op , char* arg1){
+    if(!isStringSame(op , "!")) return NULL;
+    if(!isStringSame(arg1 , "true") && !isStringSame(arg1 , "false")) return NULL;
+
+    char* store = (char*) malloc(MAX_NAME * sizeof(char));
+    strcpy(store , isStringSame(arg1 , "true") ? "false" : "true");
+    return store;
 }
 
 bool isInteger(char* str) {
@@ -149,7 +225,7 @@ bool isInteger(char* str) {
 }
 
 // Check if a string represents a compile-time constant
-// Returns true for: integers, doubles, booleans (true/false), string literals
+// Returns true for: integers, doubles, chars ('a'), booleans (true/false)
 bool isConstant(char* str) {
     if (!str || !str[0]) {
         return false;
@@ -165,10 +241,16 @@ bool isConstant(char* str) {
         return true;
     }
     
+    // Check if it's a double or a quoted char
+    if (isDouble(str) || isCharConstant(str)) {
+        return true;
+    }
+    
     return false;
 }
 
 // Helper function to check if a string is a double constant
+// Accepts "3.14" and the exponent form written by formatDoubleConstant ("1e+20")
 bool isDouble(char* str) {
     if (!str || !str[0]) return false;
     
@@ -176,15 +258,30 @@ bool isDouble(char* str) {
     if (!str[i]) return false;  // just a sign
     
     bool hasDecimal = false;
-    while (str[i]) {
+    bool hasDigit = false;
+    while (str[i] && str[i] != 'e') {
         if (str[i] == '.') {
             if (hasDecimal) return false;  // multiple decimals
             hasDecimal = true;
         } else if (!isdigit(str[i])) {
             return false;
+        } else {
+            hasDigit = true;
         }
         i++;
     }
+    if (!hasDigit) return false;
+    
+    if (str[i] == 'e') {
+        i++;
+        if (str[i] == '-' || str[i] == '+') i++;
+        if (!str[i]) return false;  // missing exponent
+        while (str[i]) {
+            if (!isdigit(str[i])) return false;
+            i++;
+        }
+        return true;
+    }
     
     return hasDecimal;  // must have a decimal point to be a double
 }
@@ -292,6 +389,88 @@ bool isVariable(char* str){
     return false;
 }
 
+// find the type of a symbol-table variable (MISC_UNKNOWN when names with different types exist)
+static tokenType getTypeOfScalarSymbol(char* str){
+    tokenType type = MISC_UNKNOWN;
+
+    for(int i=0 ; i<symbol_count ; i++){
+        if(!symbolTable[i] || !isStringSame(symbolTable[i]->var_name , str)) continue;
+
+        if(type != MISC_UNKNOWN && type != symbolTable[i]->type) return MISC_UNKNOWN; // shadowed with other type
+        type = symbolTable[i]->type;
+    }
+
+    return type;
+}
+
+static tokenType getTypeOfOperandWithDepth(char* str , int depth);
+
+// type of the value computed by the instruction defining a temporary
+static tokenType getTypeOfDefinition(address* addr , int depth){
+    switch(addr->type){
+        case ADDR_ASSIGN:
+            return getTypeOfOperandWithDepth(addr->assign.arg1 , depth + 1);
+
+        case ADDR_ARRAY_READ:
+            return getTypeOfScalarSymbol(addr->array_read.array);
+
+        case ADDR_UNOP:
+            if(isStringSame(addr->unop.op , "!")) return KEYWORD_BOOL;
+            return getTypeOfOperandWithDepth(addr->unop.arg1 , depth + 1);
+
+        case ADDR_BINOP: {
+            char* op = addr->binop.op;
+
+            // comparisons and logical operators always give bool
+            if(isStringSame(op , "&&") || isStringSame(op , "||") ||
+               isStringSame(op , "==") || isStringSame(op , "!=") ||
+               isStringSame(op , "<") || isStringSame(op , ">") ||
+               isStringSame(op , "<=") || isStringSame(op , ">=")){
+                return KEYWORD_BOOL;
+            }
+
+            // arithmetic: int only when both sides are int, double when any side is double
+            tokenType left = getTypeOfOperandWithDepth(addr->binop.arg1 , depth + 1);
+            tokenType right = getTypeOfOperandWithDepth(addr->binop.arg2 , depth + 1);
+            if(left == KEYWORD_DOUBLE || right == KEYWORD_DOUBLE) return KEYWORD_DOUBLE;
+            if(left == KEYWORD_INT && right == KEYWORD_INT) return KEYWORD_INT;
+            return MISC_UNKNOWN;
+        }
+
+        default:
+            return MISC_UNKNOWN;
+    }
+}
+
+static tokenType getTypeOfOperandWithDepth(char* str , int depth){
+    if(!str || !str[0] || depth > 32) return MISC_UNKNOWN;
+
+    if(isInteger(str)) return KEYWORD_INT;
+    if(isDouble(str)) return KEYWORD_DOUBLE;
+    if(isCharConstant(str)) return KEYWORD_CHAR;
+    if(isStringSame(str , "true") || isStringSame(str , "false")) return KEYWORD_BOOL;
+
+    if(!isTemporaryVariable(str)) return getTypeOfScalarSymbol(str);
+
+    // temporary: the type comes from its (first) definition
+    for(int i=0 ; i<block_count ; i++){
+        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
+            address* addr = allBlocks[i]->list[j];
+            if(addr->type == ADDR_ARRAY_WRITE) continue;
+
+            char* left = getLeftSideOfKindOfAssign(addr);
+            if(left && isStringSame(left , str)) return getTypeOfDefinition(addr , depth);
+        }
+    }
+
+    return MISC_UNKNOWN;
+}
+
+// data type of an operand (constant, variable or temporary), MISC_UNKNOWN if it cannot be decided
+tokenType getTypeOfOperand(char* str){
+    return getTypeOfOperandWithDepth(str , 0);
+}
+
 bool isKindOfAssign(address* addr){
     // return if instruction is kind of some assignment
     switch(addr->type){
@@ -391,6 +570,237 @@ block* generateBlock(int init , int N){
     return temp;
 }
 
+// generate an empty block that is not yet placed in the block array
+block* generateEmptyBlock(){
+    block* temp = (block*)malloc(sizeof(block));
+    if(temp == NULL){
+        printf("05 || Optimization error [05.01] -> Memory allocation failed for basic block\n");
+        exit(5);
+    }
+
+    temp->blockID = BlockId++;
+    temp->numberOfAddressesInBlock = 0;
+    temp->numCFGIn = 0;
+    temp->numCFGOut = 0;
+
+    return temp;
+}
+
+// place a block at the given position of the block array (position decides fall-through order)
+void insertBlockAt(int position , block* newBlock){
+    if(block_count >= MAX){
+        printf("05 || Optimization error [05.02] -> Maximum limit of basic blocks reached\n");
+        exit(5);
+    }
+
+    // shift all later blocks one step right
+    for(int i=block_count ; i>position ; i--){
+        allBlocks[i] = allBlocks[i-1];
+    }
+    allBlocks[position] = newBlock;
+    block_count++;
+}
+
+// generate a new instruction owned by the optimizer (not added to allAddress)
+address* generateOptimizerAddress(addrType type){
+    address* temp = (address*)malloc(sizeof(address));
+    if(temp == NULL){
+        printf("05 || Optimization error [05.10] -> Memory allocation failed for optimizer instruction\n");
+        exit(5);
+    }
+    memset(temp , 0 , sizeof(address));
+    temp->type = type;
+
+    return temp;
+}
+
+// insert instruction into block at given position
+void insertAddressIntoBlock(block* currBlock , int position , address* addr){
+    if(currBlock->numberOfAddressesInBlock >= MAX){
+        printf("05 || Optimization error [05.07] -> Invalid block structure detected\n");
+        exit(5);
+    }
+
+    // shift all later instructions one step right
+    for(int i=currBlock->numberOfAddressesInBlock ; i>position ; i--){
+        currBlock->list[i] = currBlock->list[i-1];
+    }
+    currBlock->list[position] = addr;
+    currBlock->numberOfAddressesInBlock++;
+}
+
+// replace the CFG edge from->oldTo with from->newTo (both directions)
+void replaceCFGEdge(block* from , block* oldTo , block* newTo){
+    for(int i=0 ; i<from->numCFGOut ; i++){
+        if(from->cfg_out[i] == oldTo){
+            from->cfg_out[i] = newTo;
+            break;
+        }
+    }
+
+    for(int i=0 ; i<oldTo->numCFGIn ; i++){
+        if(oldTo->cfg_in[i] == from){
+            // remove 'from' from the predecessors of oldTo
+            for(int j=i ; j<oldTo->numCFGIn-1 ; j++){
+                oldTo->cfg_in[j] = oldTo->cfg_in[j+1];
+            }
+            oldTo->numCFGIn--;
+            break;
+        }
+    }
+
+    newTo->cfg_in[newTo->numCFGIn++] = from;
+}
+
+// add CFG edge from->to (both directions)
+void addCFGEdge(block* from , block* to){
+    from->cfg_out[from->numCFGOut++] = to;
+    to->cfg_in[to->numCFGIn++] = from;
+}
+
+// remove one CFG edge from->to (both directions)
+void removeCFGEdge(block* from , block* to){
+    for(int i=0 ; i<from->numCFGOut ; i++){
+        if(from->cfg_out[i] == to){
+            for(int j=i ; j<from->numCFGOut-1 ; j++) from->cfg_out[j] = from->cfg_out[j+1];
+            from->numCFGOut--;
+            break;
+        }
+    }
+
+    for(int i=0 ; i<to->numCFGIn ; i++){
+        if(to->cfg_in[i] == from){
+            for(int j=i ; j<to->numCFGIn-1 ; j++) to->cfg_in[j] = to->cfg_in[j+1];
+            to->numCFGIn--;
+            break;
+        }
+    }
+}
+
+// remove block at position from the block array together with all its CFG edges
+void removeBlockAt(int position){
+    block* dead = allBlocks[position];
+
+    while(dead->numCFGOut > 0) removeCFGEdge(dead , dead->cfg_out[0]);
+    while(dead->numCFGIn > 0) removeCFGEdge(dead->cfg_in[0] , dead);
+
+    for(int i=position ; i<block_count-1 ; i++){
+        allBlocks[i] = allBlocks[i+1];
+    }
+    block_count--;
+}
+
+// rebuild the linear instruction list from the blocks (after blocks or instructions were added)
+void rebuildAddressListFromBlocks(){
+    int n = 0;
+
+    // loop through all blocks in order, their instructions form the program
+    for(int i=0 ; i<block_count ; i++){
+        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
+            if(n >= MAX){
+                printf("04 || ICG error [04.05] -> Maximum limit of three-address code instructions reached\n");
+                exit(4);
+            }
+            allAddress[n++] = allBlocks[i]->list[j];
+        }
+    }
+
+    addr_count = n;
+}
+
+int countInstructionsInBlocks(){
+    int n = 0;
+    for(int i=0 ; i<block_count ; i++){
+        n += allBlocks[i]->numberOfAddressesInBlock;
+    }
+    return n;
+}
+
+// FNV-1a over the string, followed by a separator
+static unsigned long long hashAppendString(unsigned long long hash , const char* s){
+    while(*s){
+        hash ^= (unsigned char)*s++;
+        hash *= 1099511628211ULL;
+    }
+    hash ^= 0xff; // separator, so "ab"+"c" differs from "a"+"bc"
+    return hash * 1099511628211ULL;
+}
+
+// hash of the instructions of a block, in order (used to see which blocks a pass changed)
+unsigned long long hashOfBlock(block* currBlock){
+    unsigned long long hash = 14695981039346656037ULL;
+    char type[8];
+
+    for(int j=0 ; j<currBlock->numberOfAddressesInBlock ; j++){
+        address* addr = currBlock->list[j];
+        snprintf(type , sizeof(type) , "%d" , addr->type);
+        hash = hashAppendString(hash , type);
+
+        switch(addr->type){
+            case ADDR_ASSIGN:
+                hash = hashAppendString(hash , addr->assign.result);
+                hash = hashAppendString(hash , addr->assign.arg1);
+                break;
+            case ADDR_BINOP:
+                hash = hashAppendString(hash , addr->binop.op);
+                hash = hashAppendString(hash , addr->binop.result);
+                hash = hashAppendString(hash , addr->binop.arg1);
+                hash = hashAppendString(hash , addr->binop.arg2);
+                break;
+            case ADDR_UNOP:
+                hash = hashAppendString(hash , addr->unop.op);
+                hash = hashAppendString(hash , addr->unop.result);
+                hash = hashAppendString(hash , addr->unop.arg1);
+                break;
+            case ADDR_GOTO:
+                hash = hashAppendString(hash , addr->goto_stmt.target);
+                break;
+            case ADDR_IF_F_GOTO:
+                hash = hashAppendString(hash , addr->if_false.condition);
+                hash = hashAppendString(hash , addr->if_false.target);
+                break;
+            case ADDR_IF_T_GOTO:
+                hash = hashAppendString(hash , addr->if_true.condition);
+                hash = hashAppendString(hash , addr->if_true.target);
+                break;
+            case ADDR_LABEL:
+                hash = hashAppendString(hash , addr->label.labelNumber);
+                break;
+            case ADDR_ARRAY_READ:
+                hash = hashAppendString(hash , addr->array_read.result);
+                hash = hashAppendString(hash , addr->array_read.array);
+                hash = hashAppendString(hash , addr->array_read.index);
+                break;
+            case ADDR_ARRAY_WRITE:
+                hash = hashAppendString(hash , addr->array_write.array);
+                hash = hashAppendString(hash , addr->array_write.index);
+                hash = hashAppendString(hash , addr->array_write.value);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return hash;
+}
+
+void recordOptPhaseStat(char* name , int before , int after , char* detail){
+    if(opt_phase_count >= MAX_STATEMENTS) return;
+
+    optPhaseStat* stat = &optPhaseStats[opt_phase_count++];
+    strncpy(stat->name , name , MAX_NAME - 1);
+    stat->name[MAX_NAME - 1] = '\0';
+    stat->instructionsBefore = before;
+    stat->instructionsAfter = after;
+    strncpy(stat->detail , detail , MAX_NAME - 1);
+    stat->detail[MAX_NAME - 1] = '\0';
+    stat->timeMs = 0.0;
+    stat->runs = 0;
+    stat->changed = false;
+    stat->outOfBudget = false;
+    stat->skipped = false;
+}
+
 address** unionOfAddrAndReturnResult(int n1 , address** addr1 , int n2 , address** addr2){
     // allocate memory for array of address pointores
 
@@ -439,6 +849,9 @@ address** unionOfAddrAndReturnResult(int n1 , address** addr1 , int n2 , address
         }
         if(exist) continue; // addr2 instruction already exists in temp, no need to add again
 
+        // keep the NULL terminator (sets only shown in the report are cut at the limit)
+        if(n >= MAX_STATEMENTS - 1) break;
+
         // add addr2 instruction to temp
         temp[n++] = addr2[i];
     }
@@ -622,6 +1035,10 @@ blockProp* generateEmptyBlockProp(){
         printf("05 || Optimization error [05.03] -> Memory allocation failed for block properties\n");
         exit(5);
     }
+    temp->numGen = 0;
+    temp->numKill = 0;
+    temp->numIn = 0;
+    temp->numOut = 0;
     return temp;
 }
 
@@ -632,6 +1049,12 @@ blockPropLive* generateEmptyBlockLiveProp(){
         printf("05 || Optimization error [05.03] -> Memory allocation failed for block properties\n");
         exit(5);
     }
+    temp->numGenLive = 0;
+    temp->numKillLive = 0;
+    temp->numInLive = 0;
+    temp->numOutLive = 0;
+    temp->owner = NULL;
+    temp->hash = 0;
     return temp;
 }
 
@@ -680,8 +1103,8 @@ void calculateKILLForBlockAndStoreTo(block* currBlock , blockProp* currBlockProp
                 
                 // check if left of assign in curr block's ith instruction same as left of assign in j block's kth instruction
                 if(isStringSame(getLeftSideOfKindOfAssign(currBlock->list[i]) , getLeftSideOfKindOfAssign(allBlocks[j]->list[k]))){
-                    // add to kill if matched
-                    currBlockProp->kill[currBlockProp->numKill++] = allBlocks[j]->list[k];
+                    // add to kill if matched (the report only has room for MAX_STATEMENTS)
+                    if(currBlockProp->numKill < MAX_STATEMENTS - 1) currBlockProp->kill[currBlockProp->numKill++] = allBlocks[j]->list[k];
                 }
             }
         }
@@ -776,162 +1199,6 @@ void calculateOUTForBlockAndStoreTo(block* currBlock , blockProp* currBlockProp)
     return;
 }
 
-// declaration to avoid error
-char* returnConstIfVariableBeReducedToConst(char* varName , int indexOfBlock , int indexOfInstruction);
-
-// 
-char* canThisInstructionBeReducedToConstant(address* addr , int indexOfBlockOfAddr , int IndexOfInstructionOfAddr){
-    if(!isKindOfAssign(addr)) return NULL;
-    
-    char* helper1 = NULL;
-    char* helper2 = NULL;
-
-    if(addr->type == ADDR_UNOP){
-        helper1 = returnConstIfVariableBeReducedToConst(allBlocks[indexOfBlockOfAddr]->list[IndexOfInstructionOfAddr]->unop.arg1 , indexOfBlockOfAddr , IndexOfInstructionOfAddr);
-        if(helper1){
-            flag = true;
-            strcpy(addr->unop.arg1 , helper1);
-        } 
-
-        return NULL;
-    } else if(addr->type == ADDR_BINOP){
-        helper1 = returnConstIfVariableBeReducedToConst(allBlocks[indexOfBlockOfAddr]->list[IndexOfInstructionOfAddr]->binop.arg1 , indexOfBlockOfAddr , IndexOfInstructionOfAddr);
-        helper2 = returnConstIfVariableBeReducedToConst(allBlocks[indexOfBlockOfAddr]->list[IndexOfInstructionOfAddr]->binop.arg2 , indexOfBlockOfAddr , IndexOfInstructionOfAddr);
-        if(helper1){
-            flag = true;
-            strcpy(addr->binop.arg1 , helper1);
-        }
-        if(helper2){
-            flag = true;
-            strcpy(addr->binop.arg2 , helper2);
-        }        
-
-        return NULL;
-    }
-    
-    return NULL;
-}
-
-//
-char* returnConstIfVariableBeReducedToConst(char* varName , int indexOfBlock , int indexOfInstruction){
-
-    char* helper = NULL;            
-
-    // UPDATE instead of going through gen of current block, go through all the instructions of current block, till it reaches itself
-    for(int i=0 ; i<allBlocks[indexOfBlock]->numberOfAddressesInBlock ; i++){
-        if(i == indexOfInstruction) break;
-
-        if(!isProperSimpleAssign(allBlocks[indexOfBlock]->list[i])) continue;
-
-        if(isStringSame(getLeftSideOfKindOfAssign(allBlocks[indexOfBlock]->list[i]) , varName)){
-            if(isConstant(getRightSideOfProperAssign(allBlocks[indexOfBlock]->list[i]))){
-                return getRightSideOfProperAssign(allBlocks[indexOfBlock]->list[i]);
-            }
-
-            return returnConstIfVariableBeReducedToConst(getRightSideOfProperAssign(allBlocks[indexOfBlock]->list[i]) , indexOfBlock , i);
-        }
-    }
-
-    // loop throught IN of current blocks
-    incomingCount = 0;
-    for(int i=0 ; i<allBlockProps[indexOfBlock]->numIn ; i++){
-        if(!isProperSimpleAssign(allBlockProps[indexOfBlock]->in[i])) continue;
-        
-        if(isStringSame(getLeftSideOfKindOfAssign(allBlockProps[indexOfBlock]->in[i]) , varName)){
-            incomingCount++;
-            if(isConstant(getRightSideOfProperAssign(allBlockProps[indexOfBlock]->in[i]))){ // x = 10/true/false
-                helper = getRightSideOfProperAssign(allBlockProps[indexOfBlock]->in[i]);
-                continue;                
-            }
-
-            helper = returnConstIfVariableBeReducedToConst(getRightSideOfProperAssign(allBlockProps[indexOfBlock]->in[i]) , indexOfBlock , i);
-            continue;
-        }
-    }
-
-    
-
-    
-
-    if(helper && incomingCount <= 1) return helper;
-
-    return NULL;
-}
-
-
-char* returnReducesVariableIfOriginalVariableCanBeReduces(char* varName , int indexOfBlock , int indexOfInstruction);
-
-//
-char* callThisInstructionBeReducesToAnotherVariable(address* addr , int indexOfBlockOfAddr , int IndexOfInstructionOfAddr){
-    if(!isKindOfAssign(addr)) return NULL;
-
-    char* helper1 = NULL;
-    char* helper2 = NULL;
-
-    if(addr->type == ADDR_BINOP){
-        helper1 = returnReducesVariableIfOriginalVariableCanBeReduces(addr->binop.arg1 , indexOfBlockOfAddr , IndexOfInstructionOfAddr);
-        helper2 = returnReducesVariableIfOriginalVariableCanBeReduces(addr->binop.arg2 , indexOfBlockOfAddr , IndexOfInstructionOfAddr);
-
-        if(helper1){
-            flag = true;
-            strcpy(addr->binop.arg1 , helper1);
-        }
-        if(helper2){
-            flag = true;
-            strcpy(addr->binop.arg2 , helper2);
-        }        
-
-        return NULL;
-    } else if(addr->type == ADDR_UNOP){
-        helper1 = returnReducesVariableIfOriginalVariableCanBeReduces(addr->unop.arg1 , indexOfBlockOfAddr , IndexOfInstructionOfAddr);
-
-        if(helper1){
-            flag = true;
-            strcpy(addr->unop.arg1 , helper1);
-        } 
-
-        return NULL;
-    }
-    
-    return NULL;
-}
-
-//
-char* returnReducesVariableIfOriginalVariableCanBeReduces(char* varName , int indexOfBlock , int indexOfInstruction){
-    char* helper = NULL;
-
-    // loop through all instructions of current block till that instruction
-    for(int i=0 ; i<allBlocks[indexOfBlock]->numberOfAddressesInBlock ; i++){
-        if(i == indexOfInstruction) break;
-
-        if(!isProperSimpleAssign(allBlocks[indexOfBlock]->list[i])) continue;
-
-        if(isStringSame(varName , getLeftSideOfKindOfAssign(allBlocks[indexOfBlock]->list[i]))){
-            if(isConstant(getRightSideOfProperAssign(allBlocks[indexOfBlock]->list[i]))) continue;
-
-            return getRightSideOfProperAssign(allBlocks[indexOfBlock]->list[i]);
-        }
-    }
-
-    incomingCount = 0;
-    // loop through all instructions of IN of current block
-    for(int i=0 ; i<allBlockProps[indexOfBlock]->numIn ; i++){
-        if(!isProperSimpleAssign(allBlockProps[indexOfBlock]->in[i])) continue;
-
-        if(isStringSame(varName , getLeftSideOfKindOfAssign(allBlockProps[indexOfBlock]->in[i]))){
-            incomingCount++;
-            if(isConstant(getRightSideOfProperAssign(allBlockProps[indexOfBlock]->in[i]))) continue;
-
-            helper = getRightSideOfProperAssign(allBlockProps[indexOfBlock]->in[i]);
-            continue;
-        }
-    }
-
-    if(helper && incomingCount <= 1) return helper;
-
-    return NULL;
-}
-
 // check if next is leader
 bool isNextGoto(int index){
 
@@ -1103,6 +1370,12 @@ void generateAllBlocks(){
     return;
 }
 
+static int calculateGenKillOfBlock(int i){
+    calculateGENForBlockAndStoreTo(allBlocks[i] , allBlockProps[i]);
+    calculateKILLForBlockAndStoreTo(allBlocks[i] , allBlockProps[i]);
+    return 0;
+}
+
 void getPropertiesOfAllBlocks(){
     // STEP 1: Create all blockProp objects (only first time)
     if(allBlockProps[0] == NULL){
@@ -1112,203 +1385,139 @@ void getPropertiesOfAllBlocks(){
         }
     }
     
-    // STEP 2: Calculate GEN and KILL for all blocks
-    for(int i=0 ; i<block_count ; i++){
-        calculateGENForBlockAndStoreTo(allBlocks[i] , allBlockProps[i]);
-        calculateKILLForBlockAndStoreTo(allBlocks[i] , allBlockProps[i]);
-    }
+    // STEP 2: Calculate GEN and KILL for all blocks (each block only writes its own sets)
+    runOnAllBlocks(calculateGenKillOfBlock);
     
-    // STEP 3: Calculate IN and OUT (single pass)
-    for(int i=0 ; i<block_count ; i++){
-        calculateINForBlockAndStoreTo(allBlocks[i] , allBlockProps[i]);
-        calculateOUTForBlockAndStoreTo(allBlocks[i] , allBlockProps[i]);
-    }
-}
-
-void checkForConstantPropagation(){
-
-    char* temp = (char*) malloc(MAX_NAME * sizeof(char));
-
-    // loop throught all blocks
-    for(int i=0 ; i<block_count ; i++){
-        // loop through all instructions of that block
-        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
-            if(!isKindOfAssign(allBlocks[i]->list[j])) continue; // skip goto and labels            
-
-            if(allBlocks[i]->list[j]->type == ADDR_ASSIGN){
-                if(isConstant(allBlocks[i]->list[j]->assign.arg1)) continue;                
-
-                temp = NULL;
-                incomingCount = 0;
-                temp = returnConstIfVariableBeReducedToConst(allBlocks[i]->list[j]->assign.arg1 , i , j);
-                
-                if(temp && incomingCount <= 1){
-                    strcpy(allBlocks[i]->list[j]->assign.arg1,temp);
-                }
-            } else if(allBlocks[i]->list[j]->type == ADDR_BINOP){
-                temp = NULL;
-                temp = canThisInstructionBeReducedToConstant(allBlocks[i]->list[j] , i,j);
-                if(temp){
-                    flag = true;
-                }
-            } else if(allBlocks[i]->list[j]->type == ADDR_UNOP){
-                temp = NULL;
-                temp = canThisInstructionBeReducedToConstant(allBlocks[i]->list[j] , i,j);
-                if(temp){
-                    flag = true;
-                }
-            }            
-            
-            
+    // STEP 3: Calculate IN and OUT until they stop growing (loops need more than one pass)
+    bool changed = true;
+    while(changed){
+        changed = false;
+        for(int i=0 ; i<block_count ; i++){
+            int outBefore = allBlockProps[i]->numOut;
+            calculateINForBlockAndStoreTo(allBlocks[i] , allBlockProps[i]);
+            calculateOUTForBlockAndStoreTo(allBlocks[i] , allBlockProps[i]);
+            if(allBlockProps[i]->numOut != outBefore) changed = true;
         }
     }
-
-    return;
 }
 
-void checkForConstantFolding(){
+// fold the instructions of the block at index i, returns the number of folded instructions
+static int foldConstantsOfBlock(int i){
 
     char* store = NULL;
+    int folded = 0;
 
-    // loop through all blocks
-    for(int i=0 ; i<block_count ; i++){
-        // loop through all instruction of i(th) block
-        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
-            if(!isKindOfAssign(allBlocks[i]->list[j])) continue; // skip goto and labels
-            
-            if(allBlocks[i]->list[j]->type == ADDR_BINOP){
-                if(!isConstant(allBlocks[i]->list[j]->binop.arg1) || !isConstant(allBlocks[i]->list[j]->binop.arg2)) continue;
-
-                // atleast one of them is integer
-                if(isInteger(allBlocks[i]->list[j]->binop.arg1) || isInteger(allBlocks[i]->list[j]->binop.arg2)){
-                    if(!isInteger(allBlocks[i]->list[j]->binop.arg1) || !isInteger(allBlocks[i]->list[j]->binop.arg2)) continue;
-
-                    // both int
-                    store = NULL;
-                    store = calculateConstFoldResultForInt(allBlocks[i]->list[j]->binop.op , allBlocks[i]->list[j]->binop.arg1 , allBlocks[i]->list[j]->binop.arg2);
-
-                    if(store){
-                        // change the instruction to assignment
-                        char temp[MAX_NAME];
-                        strcpy(temp , allBlocks[i]->list[j]->binop.result);
-                        allBlocks[i]->list[j]->type = ADDR_ASSIGN;
-                        strcpy(allBlocks[i]->list[j]->assign.result , temp);
-                        strcpy(allBlocks[i]->list[j]->assign.arg1 , store);
-
-                        flag = true;
-                    }
-                }
-
-                // both are bool (true/false)
-                
-                store = NULL;
-                store = calculateConstFoldResultForBool(allBlocks[i]->list[j]->binop.op , allBlocks[i]->list[j]->binop.arg1 , allBlocks[i]->list[j]->binop.arg2);
-
-                if(store){
-                    // change the instruction to assignment
-                    char temp[MAX_NAME];
-                    strcpy(temp , allBlocks[i]->list[j]->binop.result);
-                    allBlocks[i]->list[j]->type = ADDR_ASSIGN;
-                    strcpy(allBlocks[i]->list[j]->assign.result , temp);
-                    strcpy(allBlocks[i]->list[j]->assign.arg1 , store);
-
-                    flag = true;
-                }
-
-                
+    // loop through all instruction of i(th) block
+    for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
+        if(!isKindOfAssign(allBlocks[i]->list[j])) continue; // skip goto and labels
+        
+        if(allBlocks[i]->list[j]->type == ADDR_BINOP){
+            char* arg1 = allBlocks[i]->list[j]->binop.arg1;
+            char* arg2 = allBlocks[i]->list[j]->binop.arg2;
+            char* op = allBlocks[i]->list[j]->binop.op;
+
+            if(!isConstant(arg1) || !isConstant(arg2)) continue;
+            if(!hasOptimizationFuel()) return folded;
+
+            store = foldConstantBinOp(op , arg1 , arg2);
+
+            if(store){
+                // change the instruction to assignment
+                char temp[MAX_NAME];
+                strcpy(temp , allBlocks[i]->list[j]->binop.result);
+                allBlocks[i]->list[j]->type = ADDR_ASSIGN;
+                strcpy(allBlocks[i]->list[j]->assign.result , temp);
+                strcpy(allBlocks[i]->list[j]->assign.arg1 , store);
+
+                burnOptimizationFuel();
+                folded++;
+            }
 
-            } else if(allBlocks[i]->list[j]->type == ADDR_UNOP){
-                // only NOT operator exists
-                if(!isConstant(allBlocks[i]->list[j]->unop.arg1)) continue;
-
-                store = NULL;
-                if(isStringSame(allBlocks[i]->list[j]->unop.op , "!")){
-                    if(isStringSame(allBlocks[i]->list[j]->unop.arg1 , "true")){
-                        store = (char*) malloc(MAX_NAME * sizeof(char));
-                        strcpy(store , "false");
-                    } else if(isStringSame(allBlocks[i]->list[j]->unop.arg1 , "false")){
-                        store = (char*) malloc(MAX_NAME * sizeof(char));
-                        strcpy(store , "true");
-                    }
-                }
-                if(store){
-                    // change the instruction to assignment
-                    char temp[MAX_NAME];
-                    strcpy(temp , allBlocks[i]->list[j]->unop.result);
-                    allBlocks[i]->list[j]->type = ADDR_ASSIGN;
-                    strcpy(allBlocks[i]->list[j]->assign.result , temp);
-                    strcpy(allBlocks[i]->list[j]->assign.arg1 , store);
-
-                    flag = true;
-                }
+        } else if(allBlocks[i]->list[j]->type == ADDR_UNOP){
+            // only NOT operator exists
+            if(!isConstant(allBlocks[i]->list[j]->unop.arg1)) continue;
+            if(!hasOptimizationFuel()) return folded;
+
+            store = foldConstantUnOp(allBlocks[i]->list[j]->unop.op , allBlocks[i]->list[j]->unop.arg1);
+            if(store){
+                // change the instruction to assignment
+                char temp[MAX_NAME];
+                strcpy(temp , allBlocks[i]->list[j]->unop.result);
+                allBlocks[i]->list[j]->type = ADDR_ASSIGN;
+                strcpy(allBlocks[i]->list[j]->assign.result , temp);
+                strcpy(allBlocks[i]->list[j]->assign.arg1 , store);
+
+                burnOptimizationFuel();
+                folded++;
             }
-            
         }
+        
     }
-}
-
-void checkForCopyPropagation(){
-    char* temp = NULL;
 
-    // loop through all blocks
-    for(int i=0 ; i<block_count ; i++){
-        // loop through all instructions of that block
-        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
-            if(!isKindOfAssign(allBlocks[i]->list[j])) continue;
+    return folded;
+}
 
-            if(allBlocks[i]->list[j]->type == ADDR_ASSIGN){
-                if(isConstant(allBlocks[i]->list[j]->assign.arg1)) continue;
-                
-                incomingCount = 0;
-                temp = returnReducesVariableIfOriginalVariableCanBeReduces(getRightSideOfProperAssign(allBlocks[i]->list[j]) , i , j);
-                
-                if(temp && incomingCount <= 1 && !isStringSame(temp , getRightSideOfProperAssign(allBlocks[i]->list[j]))){
-                    strcpy(allBlocks[i]->list[j]->assign.arg1 , temp);
-                    // flag = true;
-                }
-            } else if(allBlocks[i]->list[j]->type == ADDR_BINOP){
-                temp = NULL;
-                temp = callThisInstructionBeReducesToAnotherVariable(allBlocks[i]->list[j] , i , j);
-                if(temp && !isStringSame(temp , getRightSideOfProperAssign(allBlocks[i]->list[j]))){
-                    // flag = true;
-                }
-            } else if(allBlocks[i]->list[j]->type == ADDR_UNOP){
-                temp = NULL;
-                temp = callThisInstructionBeReducesToAnotherVariable(allBlocks[i]->list[j] , i , j);
-                if(temp && !isStringSame(temp , getRightSideOfProperAssign(allBlocks[i]->list[j]))){
-                    // flag = true;
-                }
-            }
+void checkForConstantFolding(){
+    // blocks are folded independently (in parallel, see 05_08)
+    if(runOnAllBlocks(foldConstantsOfBlock) > 0) flag = true;
+}
 
-            
-        }
-    }
+// ---------------- live variable analysis (incremental) ----------------
+// every blockPropLive remembers the block it was solved for (owner) and a hash of that block;
+// after local transformations only blocks whose hash changed get new GEN/KILL, and IN/OUT are
+// solved again only for the blocks that can reach a changed block (the others can not see it)
+
+int live_dead_removed = 0;     // instructions removed by the last DCE run
+int live_blocks_solved = 0;    // blocks solved again by the last DCE run
+int live_blocks_seen = 0;      // blocks a full solve would have visited in the last DCE run
+
+static bool live_in_region[MAX];           // block was solved again by the last update
+static blockPropLive* live_aligned[MAX];   // properties in block order while aligning
+static blockPropLive* live_spare[MAX];     // properties whose block is gone (reused)
+static bool live_taken[MAX];
+static int live_work[MAX];
+static bool live_queued[MAX];
+
+// block -> position map (open addressing, at most MAX entries in 2*MAX slots)
+#define LIVE_MAP_SIZE (2 * MAX)
+static block* live_map_key[LIVE_MAP_SIZE];
+static int live_map_value[LIVE_MAP_SIZE];
+
+static int liveMapSlot(block* key){
+    unsigned long long h = (unsigned long long)(uintptr_t)key * 11400714819323198485ULL;
+    int slot = (int)((h >> 32) % LIVE_MAP_SIZE);
+    while(live_map_key[slot] != NULL && live_map_key[slot] != key) slot = (slot + 1) % LIVE_MAP_SIZE;
+    return slot;
+}
 
-    return;
+static void liveMapPut(block* key , int value){
+    int slot = liveMapSlot(key);
+    live_map_key[slot] = key;
+    live_map_value[slot] = value;
 }
 
-void attachBlockLivePropWithAllBlocks(){    
-    // Reset to reuse block properties for fresh analysis after DCE
-    block_prop_live_count = 0;
+static int liveMapGet(block* key){
+    int slot = liveMapSlot(key);
+    return (live_map_key[slot] == key) ? live_map_value[slot] : -1;
+}
 
-    for(int i=0 ; i<block_count ; i++){
-        allBlockPropsLive[block_prop_live_count] = generateEmptyBlockLiveProp();
-        allBlockPropsLive[block_prop_live_count]->numGenLive = 0;
-        allBlockPropsLive[block_prop_live_count]->numKillLive = 0;
-        allBlockPropsLive[block_prop_live_count]->numInLive = 0;
-        allBlockPropsLive[block_prop_live_count++]->numOutLive = 0;
+// hash that decides if the properties of a block are still valid: its code and its successors
+static unsigned long long liveHashOfBlock(block* currBlock){
+    unsigned long long hash = hashOfBlock(currBlock);
+    for(int i=0 ; i<currBlock->numCFGOut ; i++){
+        hash ^= (unsigned long long)(uintptr_t)currBlock->cfg_out[i];
+        hash *= 1099511628211ULL;
     }
-
-    return;
+    return hash;
 }
 
 // total variables used in given 3-addr instruction
+// (the names are stored in a buffer of the calling thread, valid until its next call)
 char** getAllVariablesUsed(int* n , address* addr){    
-    // char temp[MAX_NAME][MAX_NAME];
-    char** temp = (char**)malloc(MAX_NAME * sizeof(char*));
-    for(int i = 0; i < MAX_NAME; i++){
-        temp[i] = (char*)malloc(MAX_NAME * sizeof(char));
-    }
+    static _Thread_local char names[2][MAX_NAME];
+    static _Thread_local char* temp[2];
+    temp[0] = names[0];
+    temp[1] = names[1];
 
     *n = 0;
 
@@ -1352,132 +1561,59 @@ char** getAllVariablesUsed(int* n , address* addr){
     return temp;
 }
 
-void calculateLiveGenKill(){
+static bool liveSetHas(char set[][MAX_STATEMENTS] , int count , char* name){
+    for(int i=0 ; i<count ; i++){
+        if(isStringSame(set[i] , name)) return true;
+    }
+    return false;
+}
+
+void calculateLiveGenKillOfBlock(block* currBlock , blockPropLive* prop){
     char* temp;
-    bool found;
     int n = 0;
     char** temp_array;
 
-    // loop through all the blocks
-    for(int i=0 ; i<block_count ; i++){
-        // CRITICAL: Reset GEN and KILL for fresh calculation
-        allBlockPropsLive[i]->numGenLive = 0;
-        allBlockPropsLive[i]->numKillLive = 0;
-        
-        // loop through all instructions of that block from the end to start
-        for(int j=allBlocks[i]->numberOfAddressesInBlock-1 ; j>=0 ; j--){
-        // for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
-            
-            // gen starts
-            n = 0;
-            temp_array = getAllVariablesUsed(&n , allBlocks[i]->list[j]);               
-
-            // loop through all the variable names in temp_array
-            for(int k=0 ; k<n ; k++){
-                flag = false;
-                // loop through all the variable names in KILL_LIVE
-                for(int l=0 ; l<allBlockPropsLive[i]->numKillLive ; l++){
-                    if(isStringSame(temp_array[k] , allBlockPropsLive[i]->killLive[l])){
-                        flag = true;
-                        break;
-                    }
-                }
-                if(flag) continue; // var was defined before using
+    // CRITICAL: Reset GEN and KILL for fresh calculation
+    prop->numGenLive = 0;
+    prop->numKillLive = 0;
 
-                // check if word already exists in gen
-                for(int l=0 ; l<allBlockPropsLive[i]->numGenLive ; l++){
-                    if(isStringSame(temp_array[k] , allBlockPropsLive[i]->genLive[l])){
-                        flag = true;
-                        break;  
-                    }
-                }
-
-                if(flag) continue; // var already in gen
-
-                // add to gen
-                flag = true;
-                strcpy(allBlockPropsLive[i]->genLive[allBlockPropsLive[i]->numGenLive++] , temp_array[k]);
-            }
-
-
-            
-            // kill starts
-            if(allBlocks[i]->list[j]->type == ADDR_ARRAY_WRITE) continue; // skip array write - doesn't kill scalar variables
-            if(!isKindOfAssign(allBlocks[i]->list[j])) continue; // skip goto and labels
-
-            temp = getLeftSideOfKindOfAssign(allBlocks[i]->list[j]); // get left side varibale name
-            // loop through all varibales in the OUT of current block live property
-            found = false;
-            for(int k=0 ; k<allBlockPropsLive[i]->numKillLive ; k++){
-                if(isStringSame(temp,allBlockPropsLive[i]->killLive[k])){
-                    found = true;
-                    break; // variable lhs name already in live_KILL     
-                }            
-            }
-            if(found) continue; // variable lhs name already in live_KILL, dont do anything, just check next isntruction now
+    // loop through all instructions of that block from the end to start
+    // (walking backwards: the definition of an instruction is handled before its uses,
+    //  so "y = y + 1" keeps y in GEN and a later definition never hides an earlier use)
+    for(int j=currBlock->numberOfAddressesInBlock-1 ; j>=0 ; j--){
+        
+        // kill starts
+        if(currBlock->list[j]->type != ADDR_ARRAY_WRITE && isKindOfAssign(currBlock->list[j])){ // array write doesn't kill scalar variables
+            temp = getLeftSideOfKindOfAssign(currBlock->list[j]); // get left side varibale name
 
-            
-            // if the same variable exists in gen, remove it
-            for(int k=0 ; k<allBlockPropsLive[i]->numGenLive ; k++){
-                if(isStringSame(temp , allBlockPropsLive[i]->genLive[k])){
+            // the variable is defined here, so it is not used before this point (yet)
+            for(int k=0 ; k<prop->numGenLive ; k++){
+                if(isStringSame(temp , prop->genLive[k])){
                     // remove that from the genLive
-                    for(int l=k ; l<allBlockPropsLive[i]->numGenLive-1 ; l++){
-                        strcpy(allBlockPropsLive[i]->genLive[l] , allBlockPropsLive[i]->genLive[l+1]);                    
+                    for(int l=k ; l<prop->numGenLive-1 ; l++){
+                        strcpy(prop->genLive[l] , prop->genLive[l+1]);                    
                     }
-                    allBlockPropsLive[i]->numGenLive--;
+                    prop->numGenLive--;
                     break;
                 }
             }
 
-            // add variable to kill
-            flag = true;
-            strcpy(allBlockPropsLive[i]->killLive[allBlockPropsLive[i]->numKillLive++] , temp);    
-            
+            if(!liveSetHas(prop->killLive , prop->numKillLive , temp) && prop->numKillLive < MAX_STATEMENTS){
+                strcpy(prop->killLive[prop->numKillLive++] , temp);    
+            }
         }
-        
-    }    
 
-    return;
-}
+        // gen starts
+        n = 0;
+        temp_array = getAllVariablesUsed(&n , currBlock->list[j]);               
 
-void calculateLiveIn(){
-    
-    // loop through all blocks
-    for(int i=0 ; i<block_count ; i++){
-        // Clear current IN
-        allBlockPropsLive[i]->numInLive = 0;
-        
-        // First, add all GEN variables
-        for(int j=0 ; j<allBlockPropsLive[i]->numGenLive ; j++){
-            strcpy(allBlockPropsLive[i]->inLive[allBlockPropsLive[i]->numInLive] , allBlockPropsLive[i]->genLive[j]);
-            allBlockPropsLive[i]->numInLive++;
-        }
-        
-        // Then, add variables from (OUT - KILL)
-        for(int j=0 ; j<allBlockPropsLive[i]->numOutLive ; j++){
-            // Check if this OUT variable is in KILL
-            bool in_kill = false;
-            for(int k=0 ; k<allBlockPropsLive[i]->numKillLive ; k++){
-                if(isStringSame(allBlockPropsLive[i]->outLive[j] , allBlockPropsLive[i]->killLive[k])){
-                    in_kill = true;
-                    break;
-                }
-            }
-            
-            if(in_kill) continue; // Skip if in KILL
-            
-            // Check if already in IN (from GEN)
-            bool already_in = false;
-            for(int k=0 ; k<allBlockPropsLive[i]->numInLive ; k++){
-                if(isStringSame(allBlockPropsLive[i]->outLive[j] , allBlockPropsLive[i]->inLive[k])){
-                    already_in = true;
-                    break;
-                }
-            }
-            
-            if(!already_in){
-                strcpy(allBlockPropsLive[i]->inLive[allBlockPropsLive[i]->numInLive] , allBlockPropsLive[i]->outLive[j]);
-                allBlockPropsLive[i]->numInLive++;
+        // loop through all the variable names in temp_array
+        for(int k=0 ; k<n ; k++){
+            if(liveSetHas(prop->genLive , prop->numGenLive , temp_array[k])) continue; // var already in gen
+
+            // add to gen
+            if(prop->numGenLive < MAX_STATEMENTS){
+                strcpy(prop->genLive[prop->numGenLive++] , temp_array[k]);
             }
         }
     }
@@ -1485,229 +1621,292 @@ void calculateLiveIn(){
     return;
 }
 
-void calculateLiveOut(){    
-    
-    int index;
+// OUT = condition of the last jump + IN of all successors, then IN = GEN + (OUT - KILL)
+// returns true if IN grew (the predecessors have to be solved again)
+static bool liveSolveBlock(int i){
+    blockPropLive* prop = allBlockPropsLive[i];
+    int inBefore = prop->numInLive;
 
-    // loop through all blocks
-    for(int i=0 ; i<block_count ; i++){
-        // Clear current OUT
-        allBlockPropsLive[i]->numOutLive = 0;
-        
-        if(allBlocks[i]->numberOfAddressesInBlock > 0){
-            int lastIdx = allBlocks[i]->numberOfAddressesInBlock - 1;
-            address* lastInstr = allBlocks[i]->list[lastIdx];
+    if(allBlocks[i]->numberOfAddressesInBlock > 0){
+        address* lastInstr = allBlocks[i]->list[allBlocks[i]->numberOfAddressesInBlock - 1];
+
+        if(lastInstr->type == ADDR_IF_T_GOTO || lastInstr->type == ADDR_IF_F_GOTO){
+            char* cond = (lastInstr->type == ADDR_IF_T_GOTO) ? 
+                        lastInstr->if_true.condition : lastInstr->if_false.condition;
             
-            if(lastInstr->type == ADDR_IF_T_GOTO || lastInstr->type == ADDR_IF_F_GOTO){
-                char* cond = (lastInstr->type == ADDR_IF_T_GOTO) ? 
-                            lastInstr->if_true.condition : lastInstr->if_false.condition;
-                
-                if(isVariable(cond)){
-                    strcpy(allBlockPropsLive[i]->outLive[allBlockPropsLive[i]->numOutLive], cond);
-                    allBlockPropsLive[i]->numOutLive++;
-                }
+            if(isVariable(cond) && !liveSetHas(prop->outLive , prop->numOutLive , cond) && prop->numOutLive < MAX_STATEMENTS){
+                strcpy(prop->outLive[prop->numOutLive++], cond);
             }
         }
-        
-        // For each successor
-        for(int j=0 ; j<allBlocks[i]->numCFGOut ; j++){            
-            index = findIndexOfBlock(allBlocks[i]->cfg_out[j]); 
-
-            // Add all variables from successor's IN to this block's OUT (union)
-            for(int k=0 ; k<allBlockPropsLive[index]->numInLive ; k++){
-                // Check if already in OUT
-                bool found = false;
-                for(int l=0 ; l<allBlockPropsLive[i]->numOutLive ; l++){
-                    if(isStringSame(allBlockPropsLive[index]->inLive[k] , allBlockPropsLive[i]->outLive[l])){
-                        found = true;
-                        break;
-                    }
-                }
-                
-                // Add if not found
-                if(!found){
-                    strcpy(allBlockPropsLive[i]->outLive[allBlockPropsLive[i]->numOutLive] , allBlockPropsLive[index]->inLive[k]);
-                    allBlockPropsLive[i]->numOutLive++;
-                }
-            }
+    }
+
+    // For each successor: union of its IN
+    for(int j=0 ; j<allBlocks[i]->numCFGOut ; j++){
+        int index = liveMapGet(allBlocks[i]->cfg_out[j]);
+        if(index == -1) continue;
+        blockPropLive* next = allBlockPropsLive[index];
+        for(int k=0 ; k<next->numInLive ; k++){
+            if(liveSetHas(prop->outLive , prop->numOutLive , next->inLive[k])) continue;
+            if(prop->numOutLive < MAX_STATEMENTS) strcpy(prop->outLive[prop->numOutLive++] , next->inLive[k]);
         }
     }
 
-    return;
+    // IN only grows while solving, so only new names have to be added
+    for(int j=0 ; j<prop->numGenLive ; j++){
+        if(liveSetHas(prop->inLive , prop->numInLive , prop->genLive[j])) continue;
+        if(prop->numInLive < MAX_STATEMENTS) strcpy(prop->inLive[prop->numInLive++] , prop->genLive[j]);
+    }
+    for(int j=0 ; j<prop->numOutLive ; j++){
+        if(liveSetHas(prop->killLive , prop->numKillLive , prop->outLive[j])) continue; // Skip if in KILL
+        if(liveSetHas(prop->inLive , prop->numInLive , prop->outLive[j])) continue;
+        if(prop->numInLive < MAX_STATEMENTS) strcpy(prop->inLive[prop->numInLive++] , prop->outLive[j]);
+    }
+
+    return prop->numInLive != inBefore;
 }
 
-void startReachingDefiniionOptPhase(){
-    int iteration = 0;
-    int maxIterations = 5;  // Safety limit
-    
-    do {
-        flag = false;  // Reset flag at start of each iteration
-        iteration++;
-        
-        // Apply all three optimizations in sequence
-        checkForConstantPropagation();
-        checkForConstantFolding();
-        checkForCopyPropagation();
-        
-        
-    } while (flag && iteration < maxIterations);
+// new GEN/KILL for the block at index i if its code or successors changed since the last solve
+static int liveRefreshBlock(int i){
+    blockPropLive* prop = allBlockPropsLive[i];
+    unsigned long long hash = liveHashOfBlock(allBlocks[i]);
 
-    return;
+    live_in_region[i] = false;
+    if(prop->owner == allBlocks[i] && prop->hash == hash) return 0;
+
+    calculateLiveGenKillOfBlock(allBlocks[i] , prop);
+    prop->owner = allBlocks[i];
+    prop->hash = hash;
+    live_in_region[i] = true;
+    return 1;
 }
 
-void startDCE(){
-    char* temp;
-    char** used_vars;
-    int num_used;
-    bool isExist = false;
-    bool usedInBlock = false;
+// bring the live variable properties up to date with the blocks; returns the number of blocks solved again
+static int updateLiveVariables(){
+    int total = 0;
 
-    // reset mark array
-    for(int i=0 ; i<MAX ; i++) mark[i] = NULL;
-    markCount = 0;
+    // 1. the properties follow their block (blocks may have been inserted, removed or moved)
+    memset(live_map_key , 0 , sizeof(live_map_key));
+    while(total < MAX && allBlockPropsLive[total] != NULL){
+        live_taken[total] = false;
+        if(allBlockPropsLive[total]->owner != NULL) liveMapPut(allBlockPropsLive[total]->owner , total);
+        total++;
+    }
 
-    // loop through all the blocks
     for(int i=0 ; i<block_count ; i++){
-        // loop through all the instructions of this block
-        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
-            if(!isKindOfAssign(allBlocks[i]->list[j])) continue;
-            
-            // CRITICAL: Never eliminate array writes - they have side effects!
-            if(allBlocks[i]->list[j]->type == ADDR_ARRAY_WRITE) continue;
-            if(allBlocks[i]->list[j]->type == ADDR_ARRAY_READ) continue; // Array reads can have side effects via indexing
+        int old = liveMapGet(allBlocks[i]);
+        live_aligned[i] = NULL;
+        if(old != -1 && !live_taken[old]){
+            live_aligned[i] = allBlockPropsLive[old];
+            live_taken[old] = true;
+        }
+    }
 
+    int spareCount = 0;
+    for(int i=0 ; i<total ; i++){
+        if(!live_taken[i]) live_spare[spareCount++] = allBlockPropsLive[i];
+    }
 
-            temp = getLeftSideOfKindOfAssign(allBlocks[i]->list[j]);
+    int spareUsed = 0;
+    for(int i=0 ; i<block_count ; i++){
+        if(live_aligned[i] != NULL) continue;
+        live_aligned[i] = (spareUsed < spareCount) ? live_spare[spareUsed++] : generateEmptyBlockLiveProp();
+        live_aligned[i]->owner = NULL;
+    }
 
-            isExist = false;
-            
-            // Check if variable is live-OUT
-            for(int k=0 ; k<allBlockPropsLive[i]->numOutLive ; k++){
-                if(isStringSame(temp , allBlockPropsLive[i]->outLive[k])){
-                    isExist = true;
-                    break;
-                }
-            }
-            
-            // Also check if variable is live-IN (used by control flow in this block)
-            if(!isExist){
-                for(int k=0 ; k<allBlockPropsLive[i]->numInLive ; k++){
-                    if(isStringSame(temp , allBlockPropsLive[i]->inLive[k])){
-                        isExist = true;
-                        break;
-                    }
-                }
-            }
-            
-            // CRITICAL: Check if this variable is used by any later instruction in same block
-            // This handles intra-block dependencies (e.g., T15=a followed by arr[x]=T15)
-            if(!isExist){
-                usedInBlock = false;
-                for(int k=j+1 ; k<allBlocks[i]->numberOfAddressesInBlock ; k++){
-                    num_used = 0;
-                    used_vars = getAllVariablesUsed(&num_used , allBlocks[i]->list[k]);
-                    for(int l=0 ; l<num_used ; l++){
-                        if(isStringSame(temp , used_vars[l])){
-                            usedInBlock = true;
-                            break;
-                        }
-                    }
-                    if(usedInBlock) break;
-                }
-                if(usedInBlock) isExist = true;
-            }
+    for(int i=0 ; i<block_count ; i++) allBlockPropsLive[i] = live_aligned[i];
+    int next = block_count;
+    while(spareUsed < spareCount){
+        allBlockPropsLive[next] = live_spare[spareUsed++];
+        allBlockPropsLive[next++]->owner = NULL;
+    }
+    block_prop_live_count = block_count;
+
+    // 2. new GEN/KILL for changed blocks (in parallel), and the position of every block
+    runOnAllBlocks(liveRefreshBlock);
+
+    int top = 0;
+    memset(live_map_key , 0 , sizeof(live_map_key));
+    for(int i=0 ; i<block_count ; i++){
+        liveMapPut(allBlocks[i] , i);
+        if(live_in_region[i]) live_work[top++] = i;
+    }
+
+    // 3. region: the changed blocks and every block that can reach one of them
+    int regionCount = 0;
+    for(int i=0 ; i<top ; i++){
+        block* currBlock = allBlocks[live_work[i]];
+        for(int j=0 ; j<currBlock->numCFGIn ; j++){
+            int prev = liveMapGet(currBlock->cfg_in[j]);
+            if(prev == -1 || live_in_region[prev]) continue;
+            live_in_region[prev] = true;
+            live_work[top++] = prev;
+        }
+    }
 
-            if(isExist) continue; // skip if the variable is live
+    // 4. solve the region again, blocks outside it keep their (still valid) IN/OUT
+    top = 0;
+    for(int i=block_count-1 ; i>=0 ; i--){
+        live_queued[i] = live_in_region[i];
+        if(!live_in_region[i]) continue;
+        allBlockPropsLive[i]->numInLive = 0;
+        allBlockPropsLive[i]->numOutLive = 0;
+        live_work[top++] = i;
+        regionCount++;
+    }
 
+    // worklist used as a stack: a block is solved again only if the IN of a successor grew
+    while(top > 0){
+        int i = live_work[--top];
+        live_queued[i] = false;
 
-            // mark that instruction to be removed
-            mark[markCount++] = allBlocks[i]->list[j];
+        if(!liveSolveBlock(i)) continue;
 
+        for(int j=0 ; j<allBlocks[i]->numCFGIn ; j++){
+            int prev = liveMapGet(allBlocks[i]->cfg_in[j]);
+            if(prev == -1 || live_queued[prev]) continue;
+            live_queued[prev] = true;
+            live_work[top++] = prev;
         }
     }
+
+    return regionCount;
 }
 
-void removeMarkedInstructions(){
-    if(markCount <= 0) return;
+// live variable IN/OUT of all blocks (blocks unchanged since the last solve are reused)
+void calculateLiveVariables(){
+    updateLiveVariables();
+}
 
-    // loop through all blocks
-    for(int i=0 ; i<block_count ; i++){
-        // loop through all the instrutctions
-        for(int j=0 ; j<allBlocks[i]->numberOfAddressesInBlock ; j++){
-            // loop through all instructions in mark
-            for(int k=0 ; k<markCount ; k++){
-                if(allBlocks[i]->list[j] == mark[k]){
-                    // Double-check: never remove array writes
-                    if(mark[k]->type == ADDR_ARRAY_WRITE || mark[k]->type == ADDR_ARRAY_READ){
-                        continue;
-                    }
-                    // remove the instruction from block
-                    for(int l=j ; l<allBlocks[i]->numberOfAddressesInBlock ; l++){
-                        allBlocks[i]->list[l] = allBlocks[i]->list[l+1];
-                    }
-                    allBlocks[i]->numberOfAddressesInBlock--;
-                    allBlocks[i]->list[allBlocks[i]->numberOfAddressesInBlock] = NULL;
-                    j--; // Adjust index since we removed an element
-                    break;
-                }
-            }
+// variables used later in the block being swept by DCE (hash set, names stored in live_used_names)
+// one set per thread, blocks are swept in parallel (05_08)
+#define LIVE_USED_SIZE (2 * MAX)
+static _Thread_local char (*live_used_names)[MAX_NAME] = NULL;
+static _Thread_local int* live_used_slot = NULL;   // index into live_used_names, -1 = empty
+static _Thread_local int* live_used_at = NULL;     // slot of every stored name (to clear only those)
+static _Thread_local int live_used_count = 0;
+static _Thread_local bool live_used_full = false;  // set overflowed: every variable counts as used
+
+static void liveUsedReset(){
+    if(live_used_names == NULL){
+        live_used_names = malloc(MAX * sizeof(*live_used_names));
+        live_used_slot = (int*)malloc(LIVE_USED_SIZE * sizeof(int));
+        live_used_at = (int*)malloc(MAX * sizeof(int));
+        if(!live_used_names || !live_used_slot || !live_used_at){
+            printf("05 || Optimization error [05.03] -> Memory allocation failed for block properties\n");
+            exit(5);
         }
+        for(int i=0 ; i<LIVE_USED_SIZE ; i++) live_used_slot[i] = -1;
     }
+    for(int i=0 ; i<live_used_count ; i++) live_used_slot[live_used_at[i]] = -1;
+    live_used_count = 0;
+    live_used_full = false;
+}
 
-    // loop through all instructions
-    for(int i=0 ; i<addr_count ; i++){
-        // loop through all instructions in mark
-        for(int j=0 ; j<markCount ; j++){
-            if(allAddress[i] == mark[j]){
-                // Double-check: never remove array writes
-                if(mark[j]->type == ADDR_ARRAY_WRITE || mark[j]->type == ADDR_ARRAY_READ){
-                    continue;
-                }
-                // remove the instruction from the array
-                for(int k=i ; k<addr_count ; k++){
-                    allAddress[k] = allAddress[k+1];
-                }
-                addr_count--;
-                allAddress[addr_count] = NULL;
-                i--; // Adjust index since we removed an element
-                break;
+static int liveUsedFind(char* name){
+    int slot = hashString(name) % LIVE_USED_SIZE;
+    while(live_used_slot[slot] != -1 && !isStringSame(live_used_names[live_used_slot[slot]] , name)){
+        slot = (slot + 1) % LIVE_USED_SIZE;
+    }
+    return slot;
+}
+
+static bool liveUsedHas(char* name){
+    return live_used_full || live_used_slot[liveUsedFind(name)] != -1;
+}
+
+static void liveUsedAdd(char* name){
+    int slot = liveUsedFind(name);
+    if(live_used_slot[slot] != -1) return;
+    if(live_used_count >= MAX){
+        live_used_full = true;
+        return;
+    }
+    strcpy(live_used_names[live_used_count] , name);
+    live_used_at[live_used_count] = slot;
+    live_used_slot[slot] = live_used_count++;
+}
+
+// remove dead definitions of one block; returns the number of removed instructions
+// a definition is dead if its variable is not live at block entry/exit and no later instruction of the block uses it
+static int liveRemoveDeadCodeOfBlock(int i){
+    block* currBlock = allBlocks[i];
+    blockPropLive* prop = allBlockPropsLive[i];
+    char** used_vars;
+    int num_used;
+    int removed = 0;
+
+    // walk backwards, collecting the variables used by the instructions that stay
+    liveUsedReset();
+
+    for(int j=currBlock->numberOfAddressesInBlock-1 ; j>=0 ; j--){
+        address* addr = currBlock->list[j];
+
+        // CRITICAL: Never eliminate array writes - they have side effects!
+        // Array reads can have side effects via indexing
+        if(isKindOfAssign(addr) && addr->type != ADDR_ARRAY_WRITE && addr->type != ADDR_ARRAY_READ){
+            char* temp = getLeftSideOfKindOfAssign(addr);
+            bool isLive = liveSetHas(prop->outLive , prop->numOutLive , temp)
+                       || liveSetHas(prop->inLive , prop->numInLive , temp)
+                       || liveUsedHas(temp);
+
+            // optimization budget used up: keep the remaining dead instructions
+            if(!isLive && hasOptimizationFuel()){
+                burnOptimizationFuel();
+                currBlock->list[j] = NULL;
+                removed++;
+                continue;
             }
         }
+
+        num_used = 0;
+        used_vars = getAllVariablesUsed(&num_used , addr);
+        for(int l=0 ; l<num_used ; l++) liveUsedAdd(used_vars[l]);
     }
-}
 
-void startLiveVaraiblePhase(){    
-    int max_iteration = 5;
-    int iteration_count = 0;
+    if(removed == 0) return 0;
 
-    attachBlockLivePropWithAllBlocks();    
+    // close the gaps
+    int n = 0;
+    for(int j=0 ; j<currBlock->numberOfAddressesInBlock ; j++){
+        if(currBlock->list[j] != NULL) currBlock->list[n++] = currBlock->list[j];
+    }
+    for(int j=n ; j<currBlock->numberOfAddressesInBlock ; j++) currBlock->list[j] = NULL;
+    currBlock->numberOfAddressesInBlock = n;
 
-    again : 
-    iteration_count = 0;
+    return removed;
+}
 
-    do{
-        flag = false;
+static bool live_sweep_all = true;   // sweep every block, not only the re-solved ones
 
-        calculateLiveGenKill();
-        calculateLiveIn();
-        calculateLiveOut();        
+static int liveSweepBlock(int i){
+    if(!live_sweep_all && !live_in_region[i]) return 0;
+    return liveRemoveDeadCodeOfBlock(i);
+}
 
-        iteration_count++;
-    } while(flag && iteration_count < max_iteration);
+void startLiveVaraiblePhase(){    
 
+    live_dead_removed = 0;
+    live_blocks_solved = 0;
+    live_blocks_seen = 0;
+    live_sweep_all = true;
 
-    
-    startDCE();
+    // removing a dead instruction can make others dead: repeat, but only look again at
+    // the blocks whose live sets were solved again
+    while(true){
+        live_blocks_solved += updateLiveVariables();
+        live_blocks_seen += block_count;
 
+        int removed = (int)runOnAllBlocks(liveSweepBlock);
+        live_sweep_all = false;
 
-    if(markCount > 0){
-        removeMarkedInstructions();
-        goto again;
+        if(removed == 0) break;
+        live_dead_removed += removed;
     }
 
-    return;
+    // keep the linear instruction list in sync with the blocks
+    if(live_dead_removed > 0) rebuildAddressListFromBlocks();
 
-    
+    return;
 }
 
 void startOptimization(){    
@@ -1721,6 +1920,7 @@ void startOptimization(){
     for(int i=0 ; i<MAX ; i++){
         allBlocks[i] = NULL;
         allBlockProps[i] = NULL;
+        if(allBlockPropsLive[i] != NULL) allBlockPropsLive[i]->owner = NULL; // live sets must be solved again
     }
     
     // generate all blocks
@@ -1735,14 +1935,15 @@ void startOptimization(){
     // print cfg only (without gen/kill/in/out)
     printCFGOnlyToFile();
 
-    // generate GEN/KILL/IN/OUT
-    getPropertiesOfAllBlocks();
-
-    // start reaching definition optimization phase
-    startReachingDefiniionOptPhase();
+    // run the passes selected by -O / --passes= (05_07)
+    runOptimizationPipeline();
 
-    // start live variables analysis
-    startLiveVaraiblePhase();
+    // data flow sets of the final blocks, shown in the report
+    // (skipped at -O0 and when the optimization budget is used up, to compile fast)
+    if(opt_phase_count > 0 && !opt_budget_exhausted){
+        getPropertiesOfAllBlocks();
+        calculateLiveVariables();
+    }
 
     // print blocks AFTER optimization
     printBlocksToFile();
@@ -6,12 +6,26 @@
  * to create an executable program.
  * 
  * Features:
- * - Register allocation and management
+ * - Register allocation and management (linear scan in 06_03_registerAllocator.c,
+ *   %rax, %rcx and %rdx are the scratch registers of the instruction patterns)
  * - Stack frame setup and management
- * - Variable-to-stack-offset mapping
- * - x86-64 instruction generation
+ * - Variable-to-stack-offset mapping (slots shared by 06_02_stackSlots.c)
+ * - x86-64 instruction generation (a comparison feeding only the next branch
+ *   becomes one cmpq and a conditional jump)
  * - Function prologue and epilogue
- * - Memory addressing modes
+ * - Memory addressing modes (array elements as one label+index*size+disp operand)
+ * - Arrays in static storage: constant initializers as .data/.rodata images,
+ *   arrays without one in .bss (no stack space, no initializer stores)
+ * - Loop idioms: counted fill and copy loops become straight stores or one
+ *   rep stos / rep movs (not at -O0)
+ * - char and bool arrays packed one byte per element (movb / movzbl), int and
+ *   double elements 8 bytes
+ * - Division by a constant: shifts for powers of two, multiply-high with a magic
+ *   number (Granlund-Montgomery) for any other divisor
+ * - Doubles on SSE2: addsd/subsd/mulsd/divsd/ucomisd on the %xmm registers of 06_03
+ *   (%xmm0/%xmm1 as scratch), ints converted with cvtsi2sdq, double constants in a
+ *   .rodata pool (.LC<n>)
+ * - Lines formatted straight into a growable chunked text buffer (no line limit)
  * 
  * Author: Ridham Khurana
  */
@@ -21,6 +35,7 @@
 #pragma GCC diagnostic ignored "-Wformat-overflow"
 
 #include "database.h"
+#include <stdarg.h>
 
 // structure to map variables to stack offsets
 typedef struct {
@@ -28,10 +43,19 @@ typedef struct {
     int stack_offset;       // offset from %rbp (negative for local vars)
     bool is_array;
     int array_size;         // number of elements for arrays
+    char reg[8];            // register holding the name ("" = lives on the stack), see 06_03
 } VarStackMap;
 
-// storage for generated real assembly code
-AsmInstruction* realAsmCode[MAX];
+// storage for generated real assembly code: the lines are packed one after another into
+// chunks of REAL_ASM_CHUNK bytes (a chunk is never moved, so the line pointers stay valid)
+#define REAL_ASM_CHUNK 65536
+static char** realAsmChunks = NULL;
+static int real_asm_chunk_count = 0;
+static int real_asm_chunk_capacity = 0;
+static int real_asm_chunk_used = REAL_ASM_CHUNK;   // bytes used in the last chunk (full = no chunk yet)
+static int real_asm_chunk_size = REAL_ASM_CHUNK;   // size of the last chunk
+static char** realAsmLines = NULL;
+static int real_asm_line_capacity = 0;
 int real_asm_count = 0;
 
 // variable to stack offset mapping table
@@ -39,28 +63,132 @@ VarStackMap varStackMap[MAX];
 int var_map_count = 0;
 int current_stack_offset = -8; // start at -8(%rbp)
 
-// add real assembly instruction to output array
-void addRealAsmInstruction(const char* instr) {
-    if (real_asm_count >= MAX) {
-        printf("06_01 || Real Target Code Generation error [06_01.01] -> Real assembly buffer is full - maximum instruction limit reached\n");
+// open-addressing hash tables (linear probing) from a name to its index in varStackMap,
+// realDoubleNames and symbolTable; -1 = empty slot; at most half full
+#define REAL_NAME_SLOTS (2 * MAX)
+static int varStackSlot[REAL_NAME_SLOTS];
+static int realDoubleSlot[REAL_NAME_SLOTS];
+static int realSymbolSlot[REAL_NAME_SLOTS];
+
+// arrays live in static storage (one function, main, runs once): the constant stores of their
+// initializer become the initial image in .data (.rodata if never written again), arrays
+// without one go to .bss
+typedef struct {
+    const char* name;
+    int size;                  // elements
+    int element_size;          // bytes per element
+    long long* image;          // initial element values, bit patterns for doubles (NULL = all zero)
+    bool blocked;              // accessed at run time before a constant store (no more folding)
+    bool written;              // written at run time (.data instead of .rodata)
+} RealStaticArray;
+static RealStaticArray realStaticArrays[MAX];
+static int real_static_array_count = 0;
+static int realStaticArrayOf[MAX];         // static array of a symbol index (-1 = none)
+static bool realInitFolded[MAX];           // TAC array write folded into an initial image
+
+// fill/copy loops up to this many bytes become straight stores, longer ones rep stos / rep movs
+#define REAL_INLINE_IDIOM_BYTES 64
+int real_loop_idioms = 0;
+
+// local labels of the NaN check of double conditions (LP<n>)
+static int real_parity_labels = 0;
+
+// loops over int / double arrays run 2 (SSE2, %xmm) or 4 (AVX2, %ymm) iterations at a time
+VectorIsa real_vector_isa = VECTOR_SSE2;
+int real_loops_vectorized = 0;
+
+// double constants of the .rodata pool, label .LC<n> for entry n
+static double realDoublePool[MAX];
+static int real_double_pool_count = 0;
+
+// names holding a double: double variables and arrays, and the temps computed from them
+static const char* realDoubleNames[MAX];
+static int real_double_name_count = 0;
+
+// grow an array of pointers to at least needed entries
+static char** growRealAsmArray(char** array, int* capacity, int needed) {
+    if (needed <= *capacity) return array;
+    int grown = *capacity ? *capacity * 2 : 1024;
+    while (grown < needed) grown *= 2;
+    char** bigger = (char**)realloc(array, grown * sizeof(char*));
+    if (bigger == NULL) {
+        printf("06_01 || Real Target Code Generation error [06_01.02] -> Memory allocation failed for real assembly buffer\n");
         exit(6);
     }
-    
-    realAsmCode[real_asm_count] = (AsmInstruction*)malloc(sizeof(AsmInstruction));
-    if (realAsmCode[real_asm_count] == NULL) {
-        printf("06_01 || Real Target Code Generation error [06_01.02] -> Memory allocation failed for real assembly instruction\n");
-        exit(6);
+    *capacity = grown;
+    return bigger;
+}
+
+// room for a line of length bytes (plus '\0') at the end of the last chunk
+static char* reserveRealAsmLine(int length) {
+    if (real_asm_chunk_used + length + 1 > real_asm_chunk_size) {
+        realAsmChunks = growRealAsmArray(realAsmChunks, &real_asm_chunk_capacity, real_asm_chunk_count + 1);
+        real_asm_chunk_size = (length + 1 > REAL_ASM_CHUNK) ? length + 1 : REAL_ASM_CHUNK;
+        realAsmChunks[real_asm_chunk_count] = (char*)malloc(real_asm_chunk_size);
+        if (realAsmChunks[real_asm_chunk_count] == NULL) {
+            printf("06_01 || Real Target Code Generation error [06_01.02] -> Memory allocation failed for real assembly buffer\n");
+            exit(6);
+        }
+        real_asm_chunk_count++;
+        real_asm_chunk_used = 0;
     }
-    
-    strncpy(realAsmCode[real_asm_count]->instruction, instr, 255);
-    realAsmCode[real_asm_count]->instruction[255] = '\0';
-    real_asm_count++;
+    return realAsmChunks[real_asm_chunk_count - 1] + real_asm_chunk_used;
+}
+
+// the line just written at the end of the last chunk becomes line real_asm_count
+static void commitRealAsmLine(int length) {
+    realAsmLines = growRealAsmArray(realAsmLines, &real_asm_line_capacity, real_asm_count + 1);
+    realAsmLines[real_asm_count++] = realAsmChunks[real_asm_chunk_count - 1] + real_asm_chunk_used;
+    real_asm_chunk_used += length + 1;
+}
+
+// add real assembly instruction to output array
+void addRealAsmInstruction(const char* instr) {
+    int length = strlen(instr);
+    memcpy(reserveRealAsmLine(length), instr, length + 1);
+    commitRealAsmLine(length);
+}
+
+// add a printf-formatted line of real assembly, formatted straight into the chunk
+void emitRealAsm(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int room = real_asm_chunk_size - real_asm_chunk_used;
+    char* line = (room > 0) ? realAsmChunks[real_asm_chunk_count - 1] + real_asm_chunk_used : NULL;
+    int length = vsnprintf(line, room > 0 ? room : 0, format, args);
+    va_end(args);
+
+    if (length >= room) {
+        // did not fit: format again into a new chunk
+        line = reserveRealAsmLine(length);
+        va_start(args, format);
+        vsnprintf(line, length + 1, format, args);
+        va_end(args);
+    }
+    commitRealAsmLine(length);
+}
+
+// line index of the real assembly
+const char* getRealAsmLine(int index) {
+    return realAsmLines[index];
+}
+
+// drop every line of the real assembly (and its memory)
+void clearRealAsm() {
+    for (int i = 0; i < real_asm_chunk_count; i++) free(realAsmChunks[i]);
+    real_asm_chunk_count = 0;
+    real_asm_chunk_used = REAL_ASM_CHUNK;
+    real_asm_chunk_size = REAL_ASM_CHUNK;
+    real_asm_count = 0;
 }
 
 // check if string is a numeric value (immediate operand)
 bool isRealNumber(const char* str) {
     if (str == NULL || *str == '\0') return false;
     
+    // double constant in exponent form ("1e+20")
+    if (isDouble((char*)str)) return true;
+    
     // check for boolean literals
     if (strcmp(str, "true") == 0 || strcmp(str, "false") == 0) return false;
     
@@ -105,18 +233,43 @@ bool isRealLabel(const char* str) {
     return true;
 }
 
-// Get or allocate stack offset for a variable
-// Variables are stored on the stack with negative offsets from %rbp
-// Arrays get space for all elements (8 bytes each)
-int getStackOffset(const char* var_name) {
-    // check if already mapped
-    for (int i = 0; i < var_map_count; i++) {
-        if (strcmp(varStackMap[i].var_name, var_name) == 0) {
-            return varStackMap[i].stack_offset;
-        }
-    }
+static const char* varStackMapName(int index) {
+    return varStackMap[index].var_name;
+}
+
+static const char* realDoubleNameAt(int index) {
+    return realDoubleNames[index];
+}
+
+static const char* realSymbolName(int index) {
+    return symbolTable[index]->var_name;
+}
+
+// slot of a name in one of the hash tables: the slot holding its index, or the empty slot to put it in
+static int findRealNameSlot(const int* slots, const char* name, const char* (*nameAt)(int)) {
+    int mask = REAL_NAME_SLOTS - 1;
+    int slot = hashString(name) & mask;
     
-    // not found, create new mapping
+    while (slots[slot] != -1 && strcmp(nameAt(slots[slot]), name) != 0) {
+        slot = (slot + 1) & mask; // linear probing
+    }
+    return slot;
+}
+
+// empty the stack map and its hash table
+static void clearVarStackMap() {
+    var_map_count = 0;
+    memset(varStackSlot, -1, sizeof(varStackSlot));
+}
+
+// find the mapping of a name (NULL if it has none yet)
+static VarStackMap* findVarStackMap(const char* var_name) {
+    int index = varStackSlot[findRealNameSlot(varStackSlot, var_name, varStackMapName)];
+    return (index == -1) ? NULL : &varStackMap[index];
+}
+
+// new mapping at the end of the stack map (the first mapping of a name is the one found)
+static VarStackMap* addVarStackMap(const char* var_name) {
     if (var_map_count >= MAX) {
         printf("06_01 || Real Target Code Generation error [06_01.03] -> Variable stack map is full - maximum variable limit reached\n");
         exit(6);
@@ -127,49 +280,388 @@ int getStackOffset(const char* var_name) {
     map->var_name[MAX_NAME - 1] = '\0';
     map->is_array = false;
     map->array_size = 0;
+    map->reg[0] = '\0';
     
-    // check if it's an array in symbol table
+    int slot = findRealNameSlot(varStackSlot, map->var_name, varStackMapName);
+    if (varStackSlot[slot] == -1) varStackSlot[slot] = var_map_count;
+    var_map_count++;
+    return map;
+}
+
+// index the symbol table by name (the first symbol of a name wins)
+static void buildRealSymbolIndex() {
+    memset(realSymbolSlot, -1, sizeof(realSymbolSlot));
     for (int i = 0; i < symbol_count; i++) {
-        if (strcmp(symbolTable[i]->var_name, var_name) == 0 && symbolTable[i]->isArray) {
-            map->is_array = true;
-            int arr_size = atoi(symbolTable[i]->arraySize);
-            map->array_size = arr_size;
-            // allocate space for entire array (8 bytes per element)
-            map->stack_offset = current_stack_offset;
-            current_stack_offset -= (arr_size * 8);
-            var_map_count++;
-            return map->stack_offset;
-        }
+        int slot = findRealNameSlot(realSymbolSlot, symbolTable[i]->var_name, realSymbolName);
+        if (realSymbolSlot[slot] == -1) realSymbolSlot[slot] = i;
+    }
+}
+
+// symbol table index of a name (-1 for temps)
+static int findRealSymbolIndex(const char* name) {
+    return realSymbolSlot[findRealNameSlot(realSymbolSlot, name, realSymbolName)];
+}
+
+// symbol of a name (NULL for temps)
+static symbol* findRealSymbol(const char* name) {
+    int index = findRealSymbolIndex(name);
+    return (index == -1) ? NULL : symbolTable[index];
+}
+
+// true if the name is an array of the symbol table
+bool isRealArrayName(const char* name) {
+    symbol* sym = findRealSymbol(name);
+    return sym != NULL && sym->isArray;
+}
+
+// bytes of an array element: 1 for char and bool, 8 for double and int
+// (int arithmetic runs on 64-bit registers, so a computed int can need all 8 bytes)
+static int getRealElementSize(const char* array) {
+    symbol* sym = findRealSymbol(array);
+    if (sym != NULL && (sym->type == KEYWORD_CHAR || sym->type == KEYWORD_BOOL)) return 1;
+    return 8;
+}
+
+// mapping of an array: no stack space, its elements live in static storage (see realStaticArrays)
+static void allocateRealArray(VarStackMap* map, symbol* sym) {
+    map->is_array = true;
+    map->array_size = atoi(sym->arraySize);
+    map->stack_offset = 0;
+}
+
+// Get or allocate stack offset for a variable
+// Variables are stored on the stack with negative offsets from %rbp
+// Arrays get space for all elements (8 bytes each)
+int getStackOffset(const char* var_name) {
+    // check if already mapped
+    VarStackMap* found = findVarStackMap(var_name);
+    if (found != NULL) {
+        return found->stack_offset;
+    }
+    
+    // not found, create new mapping
+    VarStackMap* map = addVarStackMap(var_name);
+    
+    // check if it's an array in symbol table
+    symbol* sym = findRealSymbol(var_name);
+    if (sym != NULL && sym->isArray) {
+        allocateRealArray(map, sym);
+        return map->stack_offset;
     }
     
     // regular variable - allocate 8 bytes
     map->stack_offset = current_stack_offset;
     current_stack_offset -= 8;
-    var_map_count++;
     
     return map->stack_offset;
 }
 
+// Place a name at a given stack offset (used by the slot sharing of 06_02)
+// Several names may get the same offset when they are never alive at the same time
+void setStackOffset(const char* var_name, int offset) {
+    VarStackMap* map = addVarStackMap(var_name);
+    map->stack_offset = offset;
+}
+
+// Keep a name in a register instead of a stack slot (used by the register allocator of 06_03)
+void setRealRegister(const char* var_name, const char* reg) {
+    setStackOffset(var_name, 0);
+    strncpy(varStackMap[var_map_count - 1].reg, reg, sizeof(varStackMap[0].reg) - 1);
+    varStackMap[var_map_count - 1].reg[sizeof(varStackMap[0].reg) - 1] = '\0';
+}
+
+// log2 of an integer constant that is a power of two (>= 2), -1 otherwise
+int getPowerOfTwoExponent(const char* str) {
+    if (!isInteger((char*)str)) return -1;
+
+    long long value = atoll(str);
+    if (value < 2 || (value & (value - 1)) != 0) return -1;
+
+    int exponent = 0;
+    while (value > 1) {
+        value >>= 1;
+        exponent++;
+    }
+    return exponent;
+}
+
+// memory operand of a double constant in the .rodata pool (added on its first use)
+static void getRealDoubleConstant(double value, char* output) {
+    int index = 0;
+    while (index < real_double_pool_count && memcmp(&realDoublePool[index], &value, sizeof(double)) != 0) {
+        index++;
+    }
+    
+    if (index == real_double_pool_count) {
+        if (real_double_pool_count >= MAX) {
+            printf("06_01 || Real Target Code Generation error [06_01.04] -> Double constant pool is full - maximum constant limit reached\n");
+            exit(6);
+        }
+        realDoublePool[real_double_pool_count++] = value;
+    }
+    
+    sprintf(output, ".LC%d(%%rip)", index);
+}
+
+// true if a division by d uses a magic number (not 0, +-1, the most negative value or a power of two > 0)
+static bool isRealMagicDivisor(long long d) {
+    return d != INT64_MIN && (d >= 2 || d <= -2);
+}
+
+// magic multiplier and shift of a signed 64-bit division by the constant d (|d| >= 2)
+// Granlund-Montgomery / Hacker's Delight 10-1: n / d == (high64(n * magic) [+/- n]) >> shift, +1 if negative
+static void getRealDivisionMagic(long long d, long long* magic, int* shift) {
+    const unsigned long long two63 = 1ULL << 63;
+    unsigned long long ad = (d < 0) ? -(unsigned long long)d : (unsigned long long)d;
+    unsigned long long t = two63 + ((unsigned long long)d >> 63);
+    unsigned long long anc = t - 1 - t % ad;    // |nc|, the largest dividend with n % d == d - 1
+    unsigned long long q1 = two63 / anc, r1 = two63 - q1 * anc;
+    unsigned long long q2 = two63 / ad, r2 = two63 - q2 * ad;
+    unsigned long long delta;
+    int p = 63;
+    
+    do {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad) {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+    
+    *magic = (long long)(q2 + 1);
+    if (d < 0) *magic = -*magic;
+    *shift = p - 64;
+}
+
 // convert operand to proper x86-64 addressing format
 void getRealOperand(const char* operand, char* output) {
-    if (isRealNumber(operand)) {
+    if (isDouble((char*)operand)) {
+        getRealDoubleConstant(strtod(operand, NULL), output); // double constant from the pool
+    } else if (isRealNumber(operand)) {
         sprintf(output, "$%s", operand); // immediate value
     } else if (strcmp(operand, "true") == 0) {
         sprintf(output, "$1"); // boolean true as 1
     } else if (strcmp(operand, "false") == 0) {
         sprintf(output, "$0"); // boolean false as 0
+    } else if (isCharConstant((char*)operand)) {
+        sprintf(output, "$%d", (unsigned char)charConstantValue(operand)); // char as its code
     } else if (isRealLabel(operand)) {
         sprintf(output, "%s", operand); // label reference
     } else {
-        // variable or temp - use stack offset
-        int offset = getStackOffset(operand);
-        sprintf(output, "%d(%%rbp)", offset);
+        // variable or temp - register if it got one, stack offset otherwise
+        VarStackMap* map = findVarStackMap(operand);
+        if (map != NULL && map->reg[0] != '\0') {
+            sprintf(output, "%s", map->reg);
+        } else {
+            int offset = getStackOffset(operand);
+            sprintf(output, "%d(%%rbp)", offset);
+        }
+    }
+}
+
+// true if the name holds a double
+bool isRealDoubleName(const char* name) {
+    return realDoubleSlot[findRealNameSlot(realDoubleSlot, name, realDoubleNameAt)] != -1;
+}
+
+// true if the operand is a double constant or a name holding a double
+static bool isRealDoubleValue(const char* operand) {
+    return isDouble((char*)operand) || isRealDoubleName(operand);
+}
+
+static void addRealDoubleName(const char* name) {
+    int slot = findRealNameSlot(realDoubleSlot, name, realDoubleNameAt);
+    if (realDoubleSlot[slot] != -1) return;
+    if (real_double_name_count >= MAX) {
+        printf("06_01 || Real Target Code Generation error [06_01.03] -> Variable stack map is full - maximum variable limit reached\n");
+        exit(6);
+    }
+    realDoubleSlot[slot] = real_double_name_count;
+    realDoubleNames[real_double_name_count++] = name;
+}
+
+// find the names holding a double: the double variables and arrays of the symbol table, then
+// every name defined from a double (repeated until nothing changes, a loop can use a temp above its definition)
+static void findRealDoubleNames() {
+    real_double_name_count = 0;
+    memset(realDoubleSlot, -1, sizeof(realDoubleSlot));
+    for (int i = 0; i < symbol_count; i++) {
+        if (symbolTable[i]->type == KEYWORD_DOUBLE) addRealDoubleName(symbolTable[i]->var_name);
+    }
+    
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < addr_count; i++) {
+            address* addr = allAddress[i];
+            const char* result = NULL;
+            
+            if (addr->type == ADDR_ASSIGN && isRealDoubleValue(addr->assign.arg1)) {
+                result = addr->assign.result;
+            } else if (addr->type == ADDR_BINOP && strchr("+-*/", addr->binop.op[0]) != NULL && addr->binop.op[1] == '\0' &&
+                       (isRealDoubleValue(addr->binop.arg1) || isRealDoubleValue(addr->binop.arg2))) {
+                result = addr->binop.result;
+            } else if (addr->type == ADDR_UNOP && strcmp(addr->unop.op, "-") == 0 && isRealDoubleValue(addr->unop.arg1)) {
+                result = addr->unop.result;
+            } else if (addr->type == ADDR_ARRAY_READ && isRealDoubleName(addr->array_read.array)) {
+                result = addr->array_read.result;
+            }
+            
+            if (result != NULL && !isRealDoubleName(result)) {
+                addRealDoubleName(result);
+                changed = true;
+            }
+        }
+    }
+}
+
+// operand of a value used as a double; constants of any type come from the pool
+// returns false if the value is an int (or bool) that still needs a cvtsi2sdq
+static bool getRealDoubleOperand(const char* operand, char* output) {
+    getRealOperand(operand, output);
+    if (output[0] == '$') {
+        getRealDoubleConstant((double)atoll(output + 1), output);
+        return true;
+    }
+    return isRealDoubleValue(operand);
+}
+
+// true if the operand is an xmm register (a double of the register allocator or a scratch one)
+static bool isRealXmmRegister(const char* operand) {
+    return strncmp(operand, "%xmm", 4) == 0;
+}
+
+// load a value into an xmm register as a double (nothing if it is there already)
+static void loadRealDouble(const char* operand, const char* xmm) {
+    char source[128];
+    
+    if (!getRealDoubleOperand(operand, source)) {
+        emitRealAsm("    cvtsi2sdq %s, %s", source, xmm);
+    } else if (strcmp(source, xmm) == 0) {
+        return;
+    } else if (isRealXmmRegister(source)) {
+        emitRealAsm("    movapd  %s, %s", source, xmm);
+    } else if (source[0] == '%') {
+        emitRealAsm("    movq    %s, %s", source, xmm);
+    } else {
+        emitRealAsm("    movsd   %s, %s", source, xmm);
+    }
+}
+
+// source operand of an SSE instruction: a double in memory or in an xmm register is used directly,
+// anything else is loaded into xmm first
+static void getRealDoubleSource(const char* operand, const char* xmm, char* output) {
+    if (getRealDoubleOperand(operand, output) && (output[0] != '%' || isRealXmmRegister(output))) return;
+    loadRealDouble(operand, xmm);
+    strcpy(output, xmm);
+}
+
+// store %xmm0 to the result of a double operation
+static void storeRealDouble(const char* result) {
+    if (isRealXmmRegister(result)) {
+        emitRealAsm("    movapd  %%xmm0, %s", result);
+    } else {
+        emitRealAsm("    %-8s%%xmm0, %s", result[0] == '%' ? "movq" : "movsd", result);
+    }
+}
+
+// true if the binary operation computes or compares doubles
+static bool isRealDoubleBinOp(address* addr) {
+    return isRealDoubleValue(addr->binop.arg1) || isRealDoubleValue(addr->binop.arg2);
+}
+
+// ucomisd of a double comparison; "<" and "<=" swap their operands so that only the "above"
+// conditions are needed, which are false when an operand is NaN (unordered)
+// returns the condition: "a" (>), "ae" (>=), "e" (==) or "ne" (!=)
+static const char* generateRealDoubleCompare(address* compare) {
+    char source[128];
+    const char* op = compare->binop.op;
+    bool swapped = (strcmp(op, "<") == 0 || strcmp(op, "<=") == 0);
+    const char* first = swapped ? compare->binop.arg2 : compare->binop.arg1;
+    const char* second = swapped ? compare->binop.arg1 : compare->binop.arg2;
+    
+    // the first operand stays where it is when it is in an xmm register
+    char target[128];
+    if (!getRealDoubleOperand(first, target) || !isRealXmmRegister(target)) {
+        loadRealDouble(first, "%xmm0");
+        strcpy(target, "%xmm0");
+    }
+    getRealDoubleSource(second, "%xmm1", source);
+    emitRealAsm("    ucomisd %s, %s", source, target);
+    
+    if (strcmp(op, "==") == 0) return "e";
+    if (strcmp(op, "!=") == 0) return "ne";
+    return (strcmp(op, "<") == 0 || strcmp(op, ">") == 0) ? "a" : "ae";
+}
+
+// result = arg1 op arg2 on doubles (SSE2 scalar instructions)
+static void generateRealDoubleBinOp(address* addr, const char* result) {
+    char source[128];
+    const char* op = addr->binop.op;
+    const char* sse = NULL;
+    
+    if (strcmp(op, "+") == 0) sse = "addsd";
+    else if (strcmp(op, "-") == 0) sse = "subsd";
+    else if (strcmp(op, "*") == 0) sse = "mulsd";
+    else if (strcmp(op, "/") == 0) sse = "divsd";
+    
+    if (sse != NULL) {
+        // result in an xmm register: result = arg1; result op= arg2 (through %xmm0 if the result is arg2)
+        char arg2[128];
+        bool commutative = (sse[0] == 'a' || sse[0] == 'm');
+        const char* first = addr->binop.arg1;
+        const char* second = addr->binop.arg2;
+        getRealDoubleOperand(second, arg2);
+        if (commutative && strcmp(result, arg2) == 0) {
+            // result already holds arg2: result op= arg1
+            first = addr->binop.arg2;
+            second = addr->binop.arg1;
+            getRealDoubleOperand(second, arg2);
+        }
+        bool direct = isRealXmmRegister(result) && strcmp(result, arg2) != 0;
+        const char* target = direct ? result : "%xmm0";
+        
+        loadRealDouble(first, target);
+        getRealDoubleSource(second, "%xmm1", source);
+        emitRealAsm("    %-8s%s, %s", sse, source, target);
+        if (!direct) storeRealDouble(result);
+        return;
+    }
+    
+    // comparison: the flags of ucomisd to 0/1, == and != also look at the parity flag (NaN)
+    const char* condition = generateRealDoubleCompare(addr);
+    if (strcmp(condition, "e") == 0) {
+        addRealAsmInstruction("    sete    %al");
+        addRealAsmInstruction("    setnp   %cl");
+        addRealAsmInstruction("    andb    %cl, %al");
+    } else if (strcmp(condition, "ne") == 0) {
+        addRealAsmInstruction("    setne   %al");
+        addRealAsmInstruction("    setp    %cl");
+        addRealAsmInstruction("    orb     %cl, %al");
+    } else {
+        emitRealAsm("    set%-5s%%al", condition);
+    }
+    
+    if (result[0] == '%') {
+        emitRealAsm("    movzbq  %%al, %s", result);
+    } else {
+        addRealAsmInstruction("    movzbq  %al, %rax");
+        emitRealAsm("    movq    %%rax, %s", result);
     }
 }
 
 // build variable stack map from symbol table
 void buildVariableStackMap() {
-    var_map_count = 0;
+    clearVarStackMap();
     current_stack_offset = -8;
     
     // first pass: allocate all user variables from symbol table
@@ -177,36 +669,25 @@ void buildVariableStackMap() {
         symbol* sym = symbolTable[i];
         
         // check if already mapped
-        bool already_mapped = false;
-        for (int j = 0; j < var_map_count; j++) {
-            if (strcmp(varStackMap[j].var_name, sym->var_name) == 0) {
-                already_mapped = true;
-                break;
-            }
-        }
-        
-        if (!already_mapped) {
-            VarStackMap* map = &varStackMap[var_map_count];
-            strncpy(map->var_name, sym->var_name, MAX_NAME - 1);
-            map->var_name[MAX_NAME - 1] = '\0';
-            map->is_array = sym->isArray;
+        if (findVarStackMap(sym->var_name) == NULL) {
+            VarStackMap* map = addVarStackMap(sym->var_name);
             
             if (sym->isArray) {
-                int arr_size = atoi(sym->arraySize);
-                map->array_size = arr_size;
-                map->stack_offset = current_stack_offset;
-                current_stack_offset -= (arr_size * 8);
+                allocateRealArray(map, sym);
             } else {
-                map->array_size = 0;
                 map->stack_offset = current_stack_offset;
                 current_stack_offset -= 8;
             }
-            
-            var_map_count++;
         }
     }
 }
 
+// frame size (bytes) the prologue reserves for the current stack map
+static int getRealFrameSize() {
+    int total_stack = (-current_stack_offset) + 16; // add padding
+    return ((total_stack + 15) / 16) * 16;          // align to 16 bytes
+}
+
 // generate x86-64 function prologue with correct stack allocation
 void generateRealPrologue() {
     addRealAsmInstruction("    .section .text");
@@ -218,12 +699,8 @@ void generateRealPrologue() {
     addRealAsmInstruction("    movq    %rsp, %rbp");
     
     // calculate total stack space needed
-    int total_stack = (-current_stack_offset) + 16; // add padding
-    total_stack = ((total_stack + 15) / 16) * 16;   // align to 16 bytes
-    
-    char instr[256];
-    sprintf(instr, "    subq    $%d, %%rsp    # Allocate stack space", total_stack);
-    addRealAsmInstruction(instr);
+    emitRealAsm("    subq    $%d, %%rsp    # Allocate stack space", getRealFrameSize());
+    generateRegisterSaves();
     addRealAsmInstruction(""); 
 }
 
@@ -231,310 +708,1455 @@ void generateRealPrologue() {
 void generateRealEpilogue() {
     addRealAsmInstruction("");
     addRealAsmInstruction("    # Function epilogue");
+    generateRegisterRestores();
     addRealAsmInstruction("    movq    $0, %rax");
     addRealAsmInstruction("    leave");
     addRealAsmInstruction("    ret");
 }
 
+// label of the static storage of an array ("a" -> "a.arr", apart from the L<n> and .LC<n> labels)
+static void getRealStaticArrayLabel(const char* array, char* output) {
+    sprintf(output, "%s.arr", array);
+}
+
+// static array of an array name (NULL if the name is none)
+static RealStaticArray* findRealStaticArray(const char* name) {
+    int index = findRealSymbolIndex(name);
+    if (index == -1 || realStaticArrayOf[index] == -1) return NULL;
+    return &realStaticArrays[realStaticArrayOf[index]];
+}
+
+// value of a constant operand as element bits (false if the operand is no constant)
+static bool getRealConstantBits(const char* operand, bool is_double, long long* bits) {
+    double value;
+    if (isInteger((char*)operand)) {
+        if (!is_double) {
+            *bits = atoll(operand);
+            return true;
+        }
+        value = (double)atoll(operand);
+    } else if (isDouble((char*)operand)) {
+        value = strtod(operand, NULL);
+    } else if (isCharConstant((char*)operand)) {
+        *bits = (unsigned char)charConstantValue(operand);
+        return !is_double;
+    } else if (strcmp(operand, "true") == 0 || strcmp(operand, "false") == 0) {
+        *bits = (operand[0] == 't');
+        return !is_double;
+    } else {
+        return false;
+    }
+    if (!is_double) return false;
+    memcpy(bits, &value, sizeof(value));
+    return true;
+}
+
+// one static array per array name (sized for the largest declaration of the name); the constant stores at the start of main (before the first
+// label or jump, so they run exactly once and in order) become the initial image of the array
+// as long as nothing else touched the array before them
+static void findRealStaticArrays() {
+    for (int i = 0; i < real_static_array_count; i++) free(realStaticArrays[i].image);
+    real_static_array_count = 0;
+    
+    for (int i = 0; i < symbol_count; i++) {
+        realStaticArrayOf[i] = -1;
+        if (!symbolTable[i]->isArray || findRealSymbolIndex(symbolTable[i]->var_name) != i) continue;
+        
+        RealStaticArray* array = &realStaticArrays[real_static_array_count];
+        array->name = symbolTable[i]->var_name;
+        array->size = atoi(symbolTable[i]->arraySize);
+        array->element_size = getRealElementSize(array->name);
+        array->image = NULL;
+        array->blocked = false;
+        array->written = false;
+        realStaticArrayOf[i] = real_static_array_count++;
+    }
+    
+    // arrays of the same name in different scopes share the label: it gets the largest size
+    for (int i = 0; i < symbol_count; i++) {
+        if (!symbolTable[i]->isArray) continue;
+        RealStaticArray* array = findRealStaticArray(symbolTable[i]->var_name);
+        if (array != NULL && atoi(symbolTable[i]->arraySize) > array->size) array->size = atoi(symbolTable[i]->arraySize);
+    }
+    
+    memset(realInitFolded, 0, sizeof(realInitFolded));
+    for (int i = 0; i < addr_count; i++) {
+        address* addr = allAddress[i];
+        if (addr->type == ADDR_LABEL || addr->type == ADDR_GOTO ||
+            addr->type == ADDR_IF_F_GOTO || addr->type == ADDR_IF_T_GOTO) break;
+        
+        if (addr->type == ADDR_ARRAY_READ) {
+            RealStaticArray* array = findRealStaticArray(addr->array_read.array);
+            if (array != NULL) array->blocked = true;
+        }
+        if (addr->type != ADDR_ARRAY_WRITE) continue;
+        
+        RealStaticArray* array = findRealStaticArray(addr->array_write.array);
+        if (array == NULL || array->blocked) continue;
+        
+        long long bits;
+        bool is_double = isRealDoubleName(array->name);
+        long long index = isInteger(addr->array_write.index) ? atoll(addr->array_write.index) : -1;
+        if (index < 0 || index >= array->size || !getRealConstantBits(addr->array_write.value, is_double, &bits)) {
+            array->blocked = true;
+            continue;
+        }
+        
+        if (array->image == NULL) {
+            array->image = (long long*)calloc(array->size, sizeof(long long));
+            if (array->image == NULL) {
+                printf("06_01 || Real Target Code Generation error [06_01.02] -> Memory allocation failed for static array image\n");
+                exit(6);
+            }
+        }
+        array->image[index] = bits;
+        realInitFolded[i] = true;
+    }
+    
+    // stores left at run time
+    for (int i = 0; i < addr_count; i++) {
+        if (allAddress[i]->type != ADDR_ARRAY_WRITE || realInitFolded[i]) continue;
+        RealStaticArray* array = findRealStaticArray(allAddress[i]->array_write.array);
+        if (array != NULL) array->written = true;
+    }
+}
+
+// emit the static arrays of one section: 1 = .data, 2 = .rodata, 3 = .bss
+static void generateRealStaticSection(int section) {
+    static const char* directives[] = {"", "    .section .data", "    .section .rodata", "    .section .bss"};
+    char label[MAX_NAME + 8], text[MAX_NAME];
+    bool started = false;
+    
+    for (int a = 0; a < real_static_array_count; a++) {
+        RealStaticArray* array = &realStaticArrays[a];
+        int kind = (array->image == NULL) ? 3 : (array->written ? 1 : 2);
+        if (kind != section) continue;
+        
+        if (!started) {
+            addRealAsmInstruction("");
+            addRealAsmInstruction(directives[section]);
+            started = true;
+        }
+        getRealStaticArrayLabel(array->name, label);
+        addRealAsmInstruction("    .align 8");
+        emitRealAsm("%s:", label);
+        
+        int bytes = array->size * array->element_size;
+        int padded = (bytes + 7) / 8 * 8;
+        if (array->image == NULL) {
+            emitRealAsm("    .zero   %d", padded);
+            continue;
+        }
+        
+        // the elements up to the last one that is not zero, then zeros
+        int used = array->size;
+        while (used > 0 && array->image[used - 1] == 0) used--;
+        bool is_double = isRealDoubleName(array->name);
+        int per_line = (array->element_size == 1) ? 16 : 8;
+        for (int i = 0; i < used; i += (is_double ? 1 : per_line)) {
+            if (is_double) {
+                double value;
+                memcpy(&value, &array->image[i], sizeof(value));
+                formatDoubleConstant(value, text);
+                emitRealAsm("    .quad   0x%016llx    # %s", (unsigned long long)array->image[i], text);
+                continue;
+            }
+            char line[256];
+            int length = sprintf(line, "    %-7s ", array->element_size == 1 ? ".byte" : ".quad");
+            for (int k = i; k < used && k < i + per_line; k++) {
+                long long value = (array->element_size == 1) ? (unsigned char)array->image[k] : array->image[k];
+                length += sprintf(line + length, (k == i) ? "%lld" : ", %lld", value);
+            }
+            addRealAsmInstruction(line);
+        }
+        if (padded > used * array->element_size) {
+            emitRealAsm("    .zero   %d", padded - used * array->element_size);
+        }
+    }
+}
+
+// static storage of the arrays, after the code
+void generateRealStaticArrays() {
+    generateRealStaticSection(1);
+    generateRealStaticSection(2);
+    generateRealStaticSection(3);
+}
+
+// generate the .rodata pool of the double constants (raw bits, the value as comment)
+void generateRealDoublePool() {
+    char text[MAX_NAME];
+    if (real_double_pool_count == 0) return;
+    
+    addRealAsmInstruction("");
+    addRealAsmInstruction("    .section .rodata");
+    addRealAsmInstruction("    .align 8");
+    for (int i = 0; i < real_double_pool_count; i++) {
+        unsigned long long bits;
+        memcpy(&bits, &realDoublePool[i], sizeof(bits));
+        formatDoubleConstant(realDoublePool[i], text);
+        emitRealAsm(".LC%d:", i);
+        emitRealAsm("    .quad   0x%016llx    # %s", bits, text);
+    }
+}
+
 // generate assembly for simple assignment: result = arg1
+// true if an immediate operand ("$n") fits the 32-bit immediate of an instruction
+static bool isRealImmediate32(const char* operand) {
+    if (operand[0] != '$' || isRealLabel(operand + 1)) return false;
+    if (strchr(operand, '.') != NULL) return false;
+    long long value = atoll(operand + 1);
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+// true if the operand is a constant that only fits a movabsq
+static bool isRealWideImmediate(const char* operand) {
+    return operand[0] == '$' && !isRealLabel(operand + 1) && strchr(operand, '.') == NULL && !isRealImmediate32(operand);
+}
+
+// copy a value into a register (movabsq for a constant beyond 32 bits)
+static void loadRealRegister(const char* operand, const char* reg) {
+    emitRealAsm(isRealWideImmediate(operand) ? "    movabsq %s, %s" : "    movq    %s, %s", operand, reg);
+}
+
 void generateRealAssign(address* addr) {
-    char instr[256];
     char src[128], dst[128];
     
     getRealOperand(addr->assign.arg1, src);
     getRealOperand(addr->assign.result, dst);
+    if (isRealDoubleName(addr->assign.result)) {
+        getRealDoubleOperand(addr->assign.arg1, src); // an int constant becomes a double constant
+    }
+    
+    // coalesced copy: both names live in the same stack slot
+    if (strcmp(src, dst) == 0) {
+        emitRealAsm("    # %s = %s (same slot)", addr->assign.result, addr->assign.arg1);
+        return;
+    }
+    
+    // one move when a register is involved
+    if (dst[0] == '%' || (src[0] == '%' && !isRealWideImmediate(src))) {
+        emitRealAsm("    %-8s%s, %s    # %s = %s", isRealWideImmediate(src) ? "movabsq" : "movq",
+                src, dst, addr->assign.result, addr->assign.arg1);
+        return;
+    }
     
     // load source to %rax
-    sprintf(instr, "    movq    %s, %%rax    # %s = %s", 
+    emitRealAsm("    %-8s%s, %%rax    # %s = %s", isRealWideImmediate(src) ? "movabsq" : "movq",
             src, addr->assign.result, addr->assign.arg1);
-    addRealAsmInstruction(instr);
     
     // store to destination
-    sprintf(instr, "    movq    %%rax, %s", dst);
-    addRealAsmInstruction(instr);
+    emitRealAsm("    movq    %%rax, %s", dst);
 }
 
-// generate assembly for binary operation: result = arg1 op arg2
-void generateRealBinOp(address* addr) {
-    char instr[256];
-    char arg1[128], arg2[128], result[128];
-    
-    getRealOperand(addr->binop.arg1, arg1);
-    getRealOperand(addr->binop.arg2, arg2);
-    getRealOperand(addr->binop.result, result);
-    
-    // comment showing the operation
-    sprintf(instr, "    # %s = %s %s %s", 
-            addr->binop.result, addr->binop.arg1, addr->binop.op, addr->binop.arg2);
-    addRealAsmInstruction(instr);
+// instruction of an operator that works on any register ("" if it needs %rax)
+static const char* getRealRegisterInstruction(const char* op) {
+    if (strcmp(op, "+") == 0) return "addq    ";
+    if (strcmp(op, "-") == 0) return "subq    ";
+    if (strcmp(op, "*") == 0) return "imulq   ";
+    if (strcmp(op, "&&") == 0) return "andq    ";
+    if (strcmp(op, "||") == 0) return "orq     ";
+    return "";
+}
+
+// set instruction of a comparison operator ("" if the operator is no comparison)
+static const char* getRealSetInstruction(const char* op) {
+    if (strcmp(op, "<") == 0) return "setl    %al";
+    if (strcmp(op, ">") == 0) return "setg    %al";
+    if (strcmp(op, "<=") == 0) return "setle   %al";
+    if (strcmp(op, ">=") == 0) return "setge   %al";
+    if (strcmp(op, "==") == 0) return "sete    %al";
+    if (strcmp(op, "!=") == 0) return "setne   %al";
+    return "";
+}
+
+// result = arg1 op arg2 without %rax when the values are in registers (false if not possible)
+static bool generateRealRegisterBinOp(address* addr, const char* arg1, const char* arg2, const char* result) {
+    const char* op = addr->binop.op;
+    const char* regInstr = getRealRegisterInstruction(op);
+    const char* setInstr = getRealSetInstruction(op);
+    
+    if (result[0] == '%' && regInstr[0] != '\0') {
+        bool commutative = (strcmp(op, "-") != 0);
+        if (strcmp(result, arg2) != 0) {
+            // result = arg1; result op= arg2
+            if (strcmp(result, arg1) != 0) {
+                loadRealRegister(arg1, result);
+            }
+            emitRealAsm("    %s%s, %s", regInstr, arg2, result);
+        } else if (commutative && !isRealWideImmediate(arg1)) {
+            // result already holds arg2: result op= arg1
+            emitRealAsm("    %s%s, %s", regInstr, arg1, result);
+        } else {
+            return false;
+        }
+        return true;
+    }
+    
+    if (arg1[0] == '%' && setInstr[0] != '\0') {
+        emitRealAsm("    cmpq    %s, %s", arg2, arg1);
+        emitRealAsm("    %s", setInstr);
+        if (result[0] == '%') {
+            emitRealAsm("    movzbq  %%al, %s", result);
+        } else {
+            addRealAsmInstruction("    movzbq  %al, %rax");
+            emitRealAsm("    movq    %%rax, %s", result);
+        }
+        return true;
+    }
+    
+    return false;
+}
+
+// generate assembly for binary operation: result = arg1 op arg2
+void generateRealBinOp(address* addr) {
+    char arg1[128], arg2[128], result[128];
+    
+    getRealOperand(addr->binop.arg1, arg1);
+    getRealOperand(addr->binop.arg2, arg2);
+    getRealOperand(addr->binop.result, result);
+    
+    // comment showing the operation
+    emitRealAsm("    # %s = %s %s %s", 
+            addr->binop.result, addr->binop.arg1, addr->binop.op, addr->binop.arg2);
+    
+    // doubles: SSE2 in %xmm0 and %xmm1
+    if (isRealDoubleBinOp(addr)) {
+        generateRealDoubleBinOp(addr, result);
+        return;
+    }
+    
+    // a constant beyond 32 bits is no immediate: %rcx holds it (divisions use the constant itself)
+    if (isRealWideImmediate(arg2) && strcmp(addr->binop.op, "/") != 0) {
+        loadRealRegister(arg2, "%rcx");
+        strcpy(arg2, "%rcx");
+    }
+    
+    // values in registers: no detour through %rax
+    if (generateRealRegisterBinOp(addr, arg1, arg2, result)) {
+        return;
+    }
     
     // load first operand to %rax
-    sprintf(instr, "    movq    %s, %%rax", arg1);
-    addRealAsmInstruction(instr);
+    loadRealRegister(arg1, "%rax");
     
     // perform operation
     if (strcmp(addr->binop.op, "+") == 0) {
-        sprintf(instr, "    addq    %s, %%rax", arg2);
-        addRealAsmInstruction(instr);
+        emitRealAsm("    addq    %s, %%rax", arg2);
     } else if (strcmp(addr->binop.op, "-") == 0) {
-        sprintf(instr, "    subq    %s, %%rax", arg2);
-        addRealAsmInstruction(instr);
+        emitRealAsm("    subq    %s, %%rax", arg2);
     } else if (strcmp(addr->binop.op, "*") == 0) {
-        sprintf(instr, "    movq    %s, %%rbx", arg2);
-        addRealAsmInstruction(instr);
-        sprintf(instr, "    imulq   %%rbx, %%rax");
-        addRealAsmInstruction(instr);
+        if (strcmp(arg2, "%rcx") != 0) emitRealAsm("    movq    %s, %%rcx", arg2);
+        emitRealAsm("    imulq   %%rcx, %%rax");
+    } else if (strcmp(addr->binop.op, "<<") == 0) {
+        emitRealAsm("    salq    %s, %%rax", arg2);
+    } else if (strcmp(addr->binop.op, "/") == 0 && isInteger(addr->binop.arg2) &&
+               getPowerOfTwoExponent(addr->binop.arg2) == -1 && isRealMagicDivisor(atoll(addr->binop.arg2))) {
+        // signed division by a constant: multiply-high with the magic number instead of idivq
+        long long d = atoll(addr->binop.arg2);
+        long long magic;
+        int shift;
+        getRealDivisionMagic(d, &magic, &shift);
+        
+        // the dividend is needed again when the magic number has the other sign than d
+        bool fixup = (d > 0 && magic < 0) || (d < 0 && magic > 0);
+        const char* dividend = (arg1[0] == '%') ? arg1 : "%rcx";
+        if (fixup && arg1[0] != '%') addRealAsmInstruction("    movq    %rax, %rcx");
+        emitRealAsm("    movabsq $%lld, %%rdx", magic);
+        addRealAsmInstruction("    imulq   %rdx");           // %rdx = high 64 bits of n * magic
+        if (fixup) {
+            emitRealAsm("    %s    %s, %%rdx", d > 0 ? "addq" : "subq", dividend);
+        }
+        if (shift > 0) {
+            emitRealAsm("    sarq    $%d, %%rdx", shift);
+        }
+        addRealAsmInstruction("    movq    %rdx, %rax");     // round toward zero: +1 if the quotient is negative
+        addRealAsmInstruction("    shrq    $63, %rax");
+        addRealAsmInstruction("    addq    %rdx, %rax");
+    } else if (strcmp(addr->binop.op, "/") == 0 && getPowerOfTwoExponent(addr->binop.arg2) > 0) {
+        // signed division by 2^k: add 2^k - 1 to negative dividends so the shift rounds toward zero
+        int k = getPowerOfTwoExponent(addr->binop.arg2);
+        addRealAsmInstruction("    movq    %rax, %rdx");
+        addRealAsmInstruction("    sarq    $63, %rdx");
+        emitRealAsm("    shrq    $%d, %%rdx", 64 - k);
+        addRealAsmInstruction("    addq    %rdx, %rax");
+        emitRealAsm("    sarq    $%d, %%rax", k);
     } else if (strcmp(addr->binop.op, "/") == 0) {
-        sprintf(instr, "    cqto");
-        addRealAsmInstruction(instr);
-        sprintf(instr, "    movq    %s, %%rbx", arg2);
-        addRealAsmInstruction(instr);
-        sprintf(instr, "    idivq   %%rbx");
-        addRealAsmInstruction(instr);
+        emitRealAsm("    cqto");
+        loadRealRegister(arg2, "%rcx");
+        emitRealAsm("    idivq   %%rcx");
     } else if (strcmp(addr->binop.op, "<") == 0 || strcmp(addr->binop.op, ">") == 0 || 
                strcmp(addr->binop.op, "<=") == 0 || strcmp(addr->binop.op, ">=") == 0 ||
                strcmp(addr->binop.op, "==") == 0 || strcmp(addr->binop.op, "!=") == 0) {
-        sprintf(instr, "    cmpq    %s, %%rax", arg2);
-        addRealAsmInstruction(instr);
+        emitRealAsm("    cmpq    %s, %%rax", arg2);
         
-        if (strcmp(addr->binop.op, "<") == 0) {
-            sprintf(instr, "    setl    %%al");
-        } else if (strcmp(addr->binop.op, ">") == 0) {
-            sprintf(instr, "    setg    %%al");
-        } else if (strcmp(addr->binop.op, "<=") == 0) {
-            sprintf(instr, "    setle   %%al");
-        } else if (strcmp(addr->binop.op, ">=") == 0) {
-            sprintf(instr, "    setge   %%al");
-        } else if (strcmp(addr->binop.op, "==") == 0) {
-            sprintf(instr, "    sete    %%al");
-        } else if (strcmp(addr->binop.op, "!=") == 0) {
-            sprintf(instr, "    setne   %%al");
-        }
-        addRealAsmInstruction(instr);
-        sprintf(instr, "    movzbq  %%al, %%rax");
-        addRealAsmInstruction(instr);
+        emitRealAsm("    %s", getRealSetInstruction(addr->binop.op));
+        emitRealAsm("    movzbq  %%al, %%rax");
     } else if (strcmp(addr->binop.op, "&&") == 0) {
-        sprintf(instr, "    andq    %s, %%rax", arg2);
-        addRealAsmInstruction(instr);
+        emitRealAsm("    andq    %s, %%rax", arg2);
     } else if (strcmp(addr->binop.op, "||") == 0) {
-        sprintf(instr, "    orq     %s, %%rax", arg2);
-        addRealAsmInstruction(instr);
+        emitRealAsm("    orq     %s, %%rax", arg2);
     }
     
     // store result
-    sprintf(instr, "    movq    %%rax, %s", result);
-    addRealAsmInstruction(instr);
+    emitRealAsm("    movq    %%rax, %s", result);
 }
 
 // generate assembly for unary operation: result = op arg1
 void generateRealUnOp(address* addr) {
-    char instr[256];
     char arg1[128], result[128];
     
     getRealOperand(addr->unop.arg1, arg1);
     getRealOperand(addr->unop.result, result);
     
-    sprintf(instr, "    # %s = %s %s", 
+    emitRealAsm("    # %s = %s %s", 
             addr->unop.result, addr->unop.op, addr->unop.arg1);
-    addRealAsmInstruction(instr);
     
     // load operand
-    sprintf(instr, "    movq    %s, %%rax", arg1);
-    addRealAsmInstruction(instr);
+    loadRealRegister(arg1, "%rax");
     
     // apply unary operation
-    if (strcmp(addr->unop.op, "-") == 0) {
-        sprintf(instr, "    negq    %%rax");
+    if (strcmp(addr->unop.op, "-") == 0 && isRealDoubleValue(addr->unop.arg1)) {
+        emitRealAsm("    btcq    $63, %%rax"); // double: flip the sign bit (exact for 0.0, unlike 0 - x)
+    } else if (strcmp(addr->unop.op, "-") == 0) {
+        emitRealAsm("    negq    %%rax");
     } else if (strcmp(addr->unop.op, "!") == 0) {
-        sprintf(instr, "    xorq    $1, %%rax");
+        emitRealAsm("    xorq    $1, %%rax");
     } else if (strcmp(addr->unop.op, "++") == 0) {
-        sprintf(instr, "    incq    %%rax");
+        emitRealAsm("    incq    %%rax");
     } else if (strcmp(addr->unop.op, "--") == 0) {
-        sprintf(instr, "    decq    %%rax");
+        emitRealAsm("    decq    %%rax");
     }
-    addRealAsmInstruction(instr);
     
     // store result
-    sprintf(instr, "    movq    %%rax, %s", result);
-    addRealAsmInstruction(instr);
+    emitRealAsm("    movq    %%rax, %s", result);
 }
 
 // generate assembly for unconditional jump: goto label
 void generateRealGoto(address* addr) {
-    char instr[256];
-    sprintf(instr, "    jmp     %s", addr->goto_stmt.target);
-    addRealAsmInstruction(instr);
+    emitRealAsm("    jmp     %s", addr->goto_stmt.target);
+}
+
+// number of instructions from .. to-1 that read the name
+static int countRealUsesIn(const char* name, int from, int to) {
+    int uses = 0;
+    for (int i = from; i < to; i++) {
+        address* addr = allAddress[i];
+        switch (addr->type) {
+            case ADDR_ASSIGN:
+                uses += (strcmp(addr->assign.arg1, name) == 0);
+                break;
+            case ADDR_BINOP:
+                uses += (strcmp(addr->binop.arg1, name) == 0 || strcmp(addr->binop.arg2, name) == 0);
+                break;
+            case ADDR_UNOP:
+                uses += (strcmp(addr->unop.arg1, name) == 0);
+                break;
+            case ADDR_IF_F_GOTO:
+                uses += (strcmp(addr->if_false.condition, name) == 0);
+                break;
+            case ADDR_IF_T_GOTO:
+                uses += (strcmp(addr->if_true.condition, name) == 0);
+                break;
+            case ADDR_ARRAY_READ:
+                uses += (strcmp(addr->array_read.index, name) == 0);
+                break;
+            case ADDR_ARRAY_WRITE:
+                uses += (strcmp(addr->array_write.index, name) == 0 || strcmp(addr->array_write.value, name) == 0);
+                break;
+            default:
+                break;
+        }
+    }
+    return uses;
+}
+
+// number of instructions that read the name
+static int countRealUses(const char* name) {
+    return countRealUsesIn(name, 0, addr_count);
+}
+
+// jump instruction of a comparison operator (the one that jumps when the comparison is false if negated)
+static const char* getRealJumpInstruction(const char* op, bool negated) {
+    if (strcmp(op, "<") == 0) return negated ? "jge" : "jl";
+    if (strcmp(op, ">") == 0) return negated ? "jle" : "jg";
+    if (strcmp(op, "<=") == 0) return negated ? "jg" : "jle";
+    if (strcmp(op, ">=") == 0) return negated ? "jl" : "jge";
+    if (strcmp(op, "==") == 0) return negated ? "jne" : "je";
+    if (strcmp(op, "!=") == 0) return negated ? "je" : "jne";
+    return NULL;
+}
+
+// true if the instruction at position is a comparison whose result only feeds the next conditional jump
+static bool isRealFusedCompare(int position) {
+    address* compare = allAddress[position];
+    if (compare->type != ADDR_BINOP || position + 1 >= addr_count) return false;
+    if (getRealJumpInstruction(compare->binop.op, false) == NULL) return false;
+    
+    // double == and != need the parity flag as well, they keep the setcc path
+    if (isRealDoubleBinOp(compare) && (strcmp(compare->binop.op, "==") == 0 || strcmp(compare->binop.op, "!=") == 0)) return false;
+    
+    address* jump = allAddress[position + 1];
+    const char* condition;
+    if (jump->type == ADDR_IF_F_GOTO) condition = jump->if_false.condition;
+    else if (jump->type == ADDR_IF_T_GOTO) condition = jump->if_true.condition;
+    else return false;
+    
+    return strcmp(condition, compare->binop.result) == 0 && countRealUses(compare->binop.result) == 1;
+}
+
+// generate assembly for a comparison and the conditional jump on its result: cmpq + jcc
+void generateRealCompareAndBranch(address* compare, address* jump) {
+    char arg1[128], arg2[128];
+    bool ifFalse = (jump->type == ADDR_IF_F_GOTO);
+    const char* target = ifFalse ? jump->if_false.target : jump->if_true.target;
+    
+    getRealOperand(compare->binop.arg1, arg1);
+    getRealOperand(compare->binop.arg2, arg2);
+    
+    emitRealAsm("    # %s %s %s %s goto %s", ifFalse ? "ifFalse" : "ifTrue",
+            compare->binop.arg1, compare->binop.op, compare->binop.arg2, target);
+    
+    // doubles: ucomisd + ja/jae (jbe/jb when negated, they also jump for NaN)
+    if (isRealDoubleBinOp(compare)) {
+        bool above = (strcmp(generateRealDoubleCompare(compare), "a") == 0);
+        emitRealAsm("    %-8s%s", ifFalse ? (above ? "jbe" : "jb") : (above ? "ja" : "jae"), target);
+        return;
+    }
+    
+    // the first operand must be a register (or memory when the second one is not),
+    // a constant beyond 32 bits is no immediate
+    if (isRealWideImmediate(arg2)) {
+        loadRealRegister(arg2, "%rcx");
+        strcpy(arg2, "%rcx");
+    }
+    if (arg1[0] != '%' && (arg1[0] == '$' || arg2[0] != '$')) {
+        loadRealRegister(arg1, "%rax");
+        strcpy(arg1, "%rax");
+    }
+    
+    emitRealAsm("    cmpq    %s, %s", arg2, arg1);
+    
+    emitRealAsm("    %-8s%s", getRealJumpInstruction(compare->binop.op, ifFalse), target);
+}
+
+// compare a double condition with 0.0 for the jumps of ifFalse / ifTrue
+static void generateRealDoubleTest(const char* condition) {
+    char source[128];
+    getRealDoubleSource(condition, "%xmm1", source);
+    emitRealAsm("    xorpd   %%xmm0, %%xmm0");
+    emitRealAsm("    ucomisd %s, %%xmm0", source);
 }
 
 // generate assembly for conditional jump if false: ifFalse condition goto label
 void generateRealIfFalseGoto(address* addr) {
-    char instr[256];
     char condition[128];
     
     getRealOperand(addr->if_false.condition, condition);
     
-    sprintf(instr, "    # ifFalse %s goto %s", 
+    emitRealAsm("    # ifFalse %s goto %s", 
             addr->if_false.condition, addr->if_false.target);
-    addRealAsmInstruction(instr);
     
-    sprintf(instr, "    movq    %s, %%rax", condition);
-    addRealAsmInstruction(instr);
+    // doubles: +-0.0 is false, NaN (unordered: ZF and PF set) is true
+    if (isRealDoubleValue(addr->if_false.condition)) {
+        generateRealDoubleTest(addr->if_false.condition);
+        emitRealAsm("    jp      LP%d", real_parity_labels);
+        emitRealAsm("    je      %s", addr->if_false.target);
+        emitRealAsm("LP%d:", real_parity_labels++);
+        return;
+    }
     
-    sprintf(instr, "    testq   %%rax, %%rax");
-    addRealAsmInstruction(instr);
+    if (condition[0] == '%') {
+        emitRealAsm("    testq   %s, %s", condition, condition);
+    } else {
+        loadRealRegister(condition, "%rax");
+        
+        emitRealAsm("    testq   %%rax, %%rax");
+    }
     
-    sprintf(instr, "    je      %s", addr->if_false.target);
-    addRealAsmInstruction(instr);
+    emitRealAsm("    je      %s", addr->if_false.target);
 }
 
 // generate assembly for conditional jump if true: ifTrue condition goto label
 void generateRealIfTrueGoto(address* addr) {
-    char instr[256];
     char condition[128];
     
     getRealOperand(addr->if_true.condition, condition);
     
-    sprintf(instr, "    # ifTrue %s goto %s", 
+    emitRealAsm("    # ifTrue %s goto %s", 
             addr->if_true.condition, addr->if_true.target);
-    addRealAsmInstruction(instr);
     
-    sprintf(instr, "    movq    %s, %%rax", condition);
-    addRealAsmInstruction(instr);
+    // doubles: +-0.0 is false, NaN (unordered: ZF and PF set) is true
+    if (isRealDoubleValue(addr->if_true.condition)) {
+        generateRealDoubleTest(addr->if_true.condition);
+        emitRealAsm("    jne     %s", addr->if_true.target);
+        emitRealAsm("    jp      %s", addr->if_true.target);
+        return;
+    }
     
-    sprintf(instr, "    testq   %%rax, %%rax");
-    addRealAsmInstruction(instr);
+    if (condition[0] == '%') {
+        emitRealAsm("    testq   %s, %s", condition, condition);
+    } else {
+        loadRealRegister(condition, "%rax");
+        
+        emitRealAsm("    testq   %%rax, %%rax");
+    }
     
-    sprintf(instr, "    jne     %s", addr->if_true.target);
-    addRealAsmInstruction(instr);
+    emitRealAsm("    jne     %s", addr->if_true.target);
 }
 
 // generate assembly for label definition: label:
 void generateRealLabel(address* addr) {
-    char instr[256];
-    sprintf(instr, "%s:", addr->label.labelNumber);
-    addRealAsmInstruction(instr);
+    emitRealAsm("%s:", addr->label.labelNumber);
+}
+
+// 32-bit (size 4) or 8-bit (size 1) name of a 64-bit register: %rsi -> %esi / %sil, %r8 -> %r8d / %r8b
+static void getRealSubRegister(const char* reg, int size, char* output) {
+    static const char* legacy[][3] = {
+        {"%rax", "%eax", "%al"}, {"%rcx", "%ecx", "%cl"}, {"%rdx", "%edx", "%dl"}, {"%rbx", "%ebx", "%bl"},
+        {"%rsi", "%esi", "%sil"}, {"%rdi", "%edi", "%dil"}, {"%rbp", "%ebp", "%bpl"}, {"%rsp", "%esp", "%spl"}
+    };
+    for (int i = 0; i < 8; i++) {
+        if (strcmp(reg, legacy[i][0]) == 0) {
+            strcpy(output, legacy[i][size == 4 ? 1 : 2]);
+            return;
+        }
+    }
+    sprintf(output, "%s%c", reg, size == 4 ? 'd' : 'b'); // %r8-%r15
+}
+
+// memory operand of array[index] in static storage, with size = element bytes
+// constant index: label+disp(%rip); index in a register: label(,%reg,size);
+// index in memory: loaded to %rdx first
+static void getRealArrayElement(const char* array, const char* index_operand, char* output) {
+    char index[128], label[MAX_NAME + 8];
+    int size = getRealElementSize(array);
+    
+    getRealStaticArrayLabel(array, label);
+    getRealOperand(index_operand, index);
+    
+    if (isRealImmediate32(index)) {
+        long long displacement = size * atoll(index + 1);
+        if (displacement == 0) {
+            sprintf(output, "%s(%%rip)", label);
+        } else {
+            sprintf(output, "%s%+lld(%%rip)", label, displacement);
+        }
+    } else if (index[0] == '%') {
+        sprintf(output, "%s(,%s,%d)", label, index, size);
+    } else {
+        emitRealAsm("    movq    %s, %%rdx", index);
+        sprintf(output, "%s(,%%rdx,%d)", label, size);
+    }
 }
 
 // generate assembly for array element read: result = array[index]
+// byte elements (char, bool) are zero-extended with movzbl (which clears the upper 32 bits too)
 void generateRealArrayRead(address* addr) {
-    char instr[256];
-    char index[128], result[128];
+    char element[128], result[128], reg32[8];
+    bool byte = (getRealElementSize(addr->array_read.array) == 1);
     
-    getRealOperand(addr->array_read.index, index);
     getRealOperand(addr->array_read.result, result);
     
-    sprintf(instr, "    # %s = %s[%s]", 
+    emitRealAsm("    # %s = %s[%s]", 
             addr->array_read.result, addr->array_read.array, addr->array_read.index);
-    addRealAsmInstruction(instr);
     
-    // load index to %rbx
-    sprintf(instr, "    movq    %s, %%rbx", index);
-    addRealAsmInstruction(instr);
+    getRealArrayElement(addr->array_read.array, addr->array_read.index, element);
     
-    // scale by 8 (size of each element)
-    sprintf(instr, "    imulq   $8, %%rbx");
-    addRealAsmInstruction(instr);
-    
-    // get array base address
-    int array_offset = getStackOffset(addr->array_read.array);
-    sprintf(instr, "    leaq    %d(%%rbp), %%rax", array_offset);
-    addRealAsmInstruction(instr);
+    // load the element straight into a register result, through %rax otherwise
+    if (result[0] == '%') {
+        if (byte) {
+            getRealSubRegister(result, 4, reg32);
+            emitRealAsm("    movzbl  %s, %s", element, reg32);
+        } else {
+            emitRealAsm("    movq    %s, %s", element, result);
+        }
+        return;
+    }
     
-    // load array element
-    sprintf(instr, "    movq    (%%rax, %%rbx), %%rax");
-    addRealAsmInstruction(instr);
+    if (byte) {
+        emitRealAsm("    movzbl  %s, %%eax", element);
+    } else {
+        emitRealAsm("    movq    %s, %%rax", element);
+    }
     
-    // store result
-    sprintf(instr, "    movq    %%rax, %s", result);
-    addRealAsmInstruction(instr);
+    emitRealAsm("    movq    %%rax, %s", result);
 }
 
 // generate assembly for array element write: array[index] = value
+// byte elements (char, bool) store the low byte with movb
 void generateRealArrayWrite(address* addr) {
-    char instr[256];
-    char index[128], value[128];
+    char element[128], value[128], reg8[8];
+    bool byte = (getRealElementSize(addr->array_write.array) == 1);
     
-    getRealOperand(addr->array_write.index, index);
     getRealOperand(addr->array_write.value, value);
+    if (isRealDoubleName(addr->array_write.array)) {
+        getRealDoubleOperand(addr->array_write.value, value); // an int constant becomes a double constant
+    }
     
-    sprintf(instr, "    # %s[%s] = %s", 
+    emitRealAsm("    # %s[%s] = %s", 
             addr->array_write.array, addr->array_write.index, addr->array_write.value);
-    addRealAsmInstruction(instr);
     
-    // Load value to %rax
-    sprintf(instr, "    movq    %s, %%rax", value);
-    addRealAsmInstruction(instr);
+    // a value in memory (or a too large constant) goes through %rax
+    if (value[0] != '%' && !isRealImmediate32(value)) {
+        emitRealAsm("    movq    %s, %%rax", value);
+        strcpy(value, "%rax");
+    }
+    
+    getRealArrayElement(addr->array_write.array, addr->array_write.index, element);
+    
+    if (!byte) {
+        emitRealAsm("    movq    %s, %s", value, element);
+    } else if (value[0] == '$') {
+        emitRealAsm("    movb    $%d, %s", (unsigned char)atoll(value + 1), element);
+    } else {
+        getRealSubRegister(value, 1, reg8);
+        emitRealAsm("    movb    %s, %s", reg8, element);
+    }
+}
+
+// counted loop with constant bounds and a body without labels or jumps, matched at its head label:
+//   i = c0 ; L: ; T = i < n ; ifFalse T goto E ; <body> ; T2 = i + 1 ; i = T2 ; goto L ; E:
+// ("<=" for the bound, "i = i + 1" for the increment); the head has no other entry
+typedef struct {
+    const char* counter;       // loop variable
+    long long first;           // first value of the loop variable
+    long long count;           // iterations
+    int body;                  // position of the first body instruction
+    int body_end;              // position after the body (the increment)
+    int end;                   // position of the back jump
+} RealCountedLoop;
+
+// counted loop whose body only fills or copies an array ("loop idiom"):
+//   a[i] = v   or   T1 = b[i] ; a[i] = T1
+typedef struct {
+    const char* counter;       // loop variable
+    long long first;           // first index
+    long long count;           // iterations (elements filled or copied)
+    long long last_value;      // value of the loop variable after the loop
+    const char* target;        // array written
+    const char* source;        // array read (copy) or NULL (fill)
+    const char* value;         // value written by a fill
+    long long bits;            // value of a fill as element bits
+    int end;                   // position of the back jump
+} RealLoopIdiom;
+
+// number of jumps to a label
+static int countRealJumpsTo(const char* label) {
+    int jumps = 0;
+    for (int i = 0; i < addr_count; i++) {
+        address* addr = allAddress[i];
+        if (addr->type == ADDR_GOTO) jumps += (strcmp(addr->goto_stmt.target, label) == 0);
+        if (addr->type == ADDR_IF_F_GOTO) jumps += (strcmp(addr->if_false.target, label) == 0);
+        if (addr->type == ADDR_IF_T_GOTO) jumps += (strcmp(addr->if_true.target, label) == 0);
+    }
+    return jumps;
+}
+
+// true if the instruction at position is "result = name + 1"
+static bool isRealIncrement(int position, const char* name) {
+    if (position < 0 || position >= addr_count || allAddress[position]->type != ADDR_BINOP) return false;
+    address* addr = allAddress[position];
+    return strcmp(addr->binop.op, "+") == 0 && strcmp(addr->binop.arg1, name) == 0 && strcmp(addr->binop.arg2, "1") == 0;
+}
+
+// name an instruction defines ("" for jumps, labels and array writes)
+static const char* getRealDefinedName(address* addr) {
+    switch (addr->type) {
+        case ADDR_ASSIGN: return addr->assign.result;
+        case ADDR_BINOP: return addr->binop.result;
+        case ADDR_UNOP: return addr->unop.result;
+        case ADDR_ARRAY_READ: return addr->array_read.result;
+        default: return "";
+    }
+}
+
+// true if the array has elements first .. first+count-1
+static bool isRealArrayRange(const char* array, long long first, long long count) {
+    RealStaticArray* static_array = findRealStaticArray(array);
+    return static_array != NULL && first >= 0 && count > 0 && first + count <= static_array->size;
+}
+
+// counted loop starting at the label at position (not at -O0, whose TAC keeps the loops unoptimized)
+static bool findRealCountedLoop(int position, RealCountedLoop* loop) {
+    if (strcmp(opt_pipeline_name, "-O0") == 0 || position < 1 || position + 5 >= addr_count) return false;
+    
+    address* init = allAddress[position - 1];
+    address* head = allAddress[position];
+    address* compare = allAddress[position + 1];
+    address* branch = allAddress[position + 2];
+    if (init->type != ADDR_ASSIGN || !isInteger(init->assign.arg1)) return false;
+    if (compare->type != ADDR_BINOP || branch->type != ADDR_IF_F_GOTO) return false;
     
-    // Load index to %rbx
-    sprintf(instr, "    movq    %s, %%rbx", index);
-    addRealAsmInstruction(instr);
+    const char* counter = init->assign.result;
+    bool inclusive = (strcmp(compare->binop.op, "<=") == 0);
+    if (!inclusive && strcmp(compare->binop.op, "<") != 0) return false;
+    if (strcmp(compare->binop.arg1, counter) != 0 || !isInteger(compare->binop.arg2)) return false;
+    if (strcmp(branch->if_false.condition, compare->binop.result) != 0 || countRealUses(compare->binop.result) != 1) return false;
     
-    // Scale by 8
-    sprintf(instr, "    imulq   $8, %%rbx");
-    addRealAsmInstruction(instr);
+    // the back jump: the first label or jump after the head
+    int end = position + 3;
+    while (end < addr_count && allAddress[end]->type != ADDR_LABEL && allAddress[end]->type != ADDR_GOTO &&
+           allAddress[end]->type != ADDR_IF_F_GOTO && allAddress[end]->type != ADDR_IF_T_GOTO) end++;
+    if (end + 1 >= addr_count || allAddress[end]->type != ADDR_GOTO || allAddress[end + 1]->type != ADDR_LABEL) return false;
+    if (strcmp(allAddress[end]->goto_stmt.target, head->label.labelNumber) != 0 || countRealJumpsTo(head->label.labelNumber) != 1) return false;
+    if (strcmp(allAddress[end + 1]->label.labelNumber, branch->if_false.target) != 0) return false;
     
-    // Get array base address
-    int array_offset = getStackOffset(addr->array_write.array);
-    sprintf(instr, "    leaq    %d(%%rbp), %%rcx", array_offset);
-    addRealAsmInstruction(instr);
+    // increment: "T2 = i + 1 ; i = T2" or "i = i + 1" right before the back jump
+    int increment = end - 1;
+    if (!isRealIncrement(increment, counter)) {
+        address* copy = allAddress[increment];
+        increment--;
+        if (copy->type != ADDR_ASSIGN || strcmp(copy->assign.result, counter) != 0 || !isRealIncrement(increment, counter) ||
+            strcmp(copy->assign.arg1, allAddress[increment]->binop.result) != 0 || countRealUses(copy->assign.arg1) != 1) return false;
+    } else if (strcmp(allAddress[increment]->binop.result, counter) != 0) {
+        return false;
+    }
+    if (increment < position + 3) return false;
     
-    // Store to array
-    sprintf(instr, "    movq    %%rax, (%%rcx, %%rbx)");
-    addRealAsmInstruction(instr);
+    // the body leaves the loop variable alone
+    for (int k = position + 3; k < increment; k++) {
+        if (strcmp(getRealDefinedName(allAddress[k]), counter) == 0) return false;
+    }
+    
+    loop->counter = counter;
+    loop->first = atoll(init->assign.arg1);
+    loop->count = atoll(compare->binop.arg2) + (inclusive ? 1 : 0) - loop->first;
+    loop->body = position + 3;
+    loop->body_end = increment;
+    loop->end = end;
+    return loop->count > 0;
 }
 
-// main function to convert 3-address code to real x86-64 assembly
-void generateRealTargetCode() {
-    // reset assembly code counter
-    real_asm_count = 0;
+// fill or copy loop starting at the label at position
+static bool findRealLoopIdiom(int position, RealLoopIdiom* idiom) {
+    RealCountedLoop loop;
+    if (!findRealCountedLoop(position, &loop)) return false;
     
-    // build variable to stack offset mapping
-    buildVariableStackMap();
+    // body: one store to a[i], of a constant or of b[i]
+    int k = loop.body;
+    idiom->source = NULL;
+    if (allAddress[k]->type == ADDR_ARRAY_READ) {
+        address* read = allAddress[k++];
+        if (strcmp(read->array_read.index, loop.counter) != 0 || countRealUses(read->array_read.result) != 1) return false;
+        if (allAddress[k]->type != ADDR_ARRAY_WRITE || strcmp(allAddress[k]->array_write.value, read->array_read.result) != 0) return false;
+        idiom->source = read->array_read.array;
+    }
+    address* write = allAddress[k++];
+    if (k != loop.body_end || write->type != ADDR_ARRAY_WRITE || strcmp(write->array_write.index, loop.counter) != 0) return false;
+    idiom->target = write->array_write.array;
+    idiom->value = write->array_write.value;
     
-    // PASS 1: pre-allocate stack space for all temp variables
-    // process all instructions to discover all temps and allocate their stack space
+    idiom->counter = loop.counter;
+    idiom->first = loop.first;
+    idiom->count = loop.count;
+    idiom->last_value = loop.first + loop.count;
+    idiom->end = loop.end;
+    if (!isRealArrayRange(idiom->target, idiom->first, idiom->count)) return false;
+    
+    if (idiom->source == NULL) {
+        if (!getRealConstantBits(idiom->value, isRealDoubleName(idiom->target), &idiom->bits)) return false;
+        return true;
+    }
+    
+    // a copy between two arrays of the same element type
+    return strcmp(idiom->source, idiom->target) != 0 && isRealArrayRange(idiom->source, idiom->first, idiom->count) &&
+           getRealElementSize(idiom->source) == getRealElementSize(idiom->target) &&
+           isRealDoubleName(idiom->source) == isRealDoubleName(idiom->target);
+}
+
+// memory operand of the byte at offset in the static storage of an array
+static void getRealStaticByte(const char* array, long long offset, char* output) {
+    char label[MAX_NAME + 8];
+    getRealStaticArrayLabel(array, label);
+    if (offset == 0) {
+        sprintf(output, "%s(%%rip)", label);
+    } else {
+        sprintf(output, "%s%+lld(%%rip)", label, offset);
+    }
+}
+
+// 64-bit value into %rax
+static void loadRealBits(long long bits) {
+    if (bits == 0) {
+        emitRealAsm("    xorl    %%eax, %%eax");
+    } else if (bits >= INT32_MIN && bits <= INT32_MAX) {
+        emitRealAsm("    movq    $%lld, %%rax", bits);
+    } else {
+        emitRealAsm("    movabsq $%lld, %%rax", bits);
+    }
+}
+
+// generate a fill or copy loop as straight stores (small) or one rep stos / rep movs:
+//   for (i = 0; i < 10; i++) letters[i] = 'A';   ==>   movabsq $0x4141414141414141, %rax
+//                                                       movq    %rax, letters.arr(%rip)
+//                                                       movb    %al, letters.arr+8(%rip) ...
+void generateRealLoopIdiom(RealLoopIdiom* idiom) {
+    char target[MAX_NAME + 32], source[MAX_NAME + 32], counter[128];
+    int size = getRealElementSize(idiom->target);
+    long long bytes = idiom->count * size;
+    long long offset = idiom->first * size;
+    
+    if (idiom->source == NULL) {
+        emitRealAsm("    # %s[%s] = %s for %s = %lld .. %lld: fill of %lld bytes", idiom->target, idiom->counter,
+                idiom->value, idiom->counter, idiom->first, idiom->last_value - 1, bytes);
+    } else {
+        emitRealAsm("    # %s[%s] = %s[%s] for %s = %lld .. %lld: copy of %lld bytes", idiom->target, idiom->counter,
+                idiom->source, idiom->counter, idiom->counter, idiom->first, idiom->last_value - 1, bytes);
+    }
+    
+    // the fill value in %rax, a byte repeated over all 8 bytes
+    if (idiom->source == NULL) {
+        unsigned long long pattern = (size == 1) ? (idiom->bits & 0xff) * 0x0101010101010101ULL : (unsigned long long)idiom->bits;
+        loadRealBits((long long)pattern);
+    }
+    
+    if (bytes <= REAL_INLINE_IDIOM_BYTES) {
+        // 8 bytes per store, the rest (byte arrays) one byte each
+        for (long long done = 0; done < bytes; done += (bytes - done >= 8) ? 8 : 1) {
+            bool quad = (bytes - done >= 8);
+            getRealStaticByte(idiom->target, offset + done, target);
+            if (idiom->source != NULL) {
+                getRealStaticByte(idiom->source, offset + done, source);
+                emitRealAsm(quad ? "    movq    %s, %%rax" : "    movzbl  %s, %%eax", source);
+            }
+            emitRealAsm(quad ? "    movq    %%rax, %s" : "    movb    %%al, %s", target);
+        }
+    } else {
+        // %rdi (and %rsi) may hold values of the register allocator
+        bool save_rdi = isRegisterInUse("%rdi");
+        bool save_rsi = (idiom->source != NULL && isRegisterInUse("%rsi"));
+        const char* unit = (bytes % 8 == 0) ? "q" : "b";
+        
+        if (save_rdi) emitRealAsm("    pushq   %%rdi");
+        if (save_rsi) emitRealAsm("    pushq   %%rsi");
+        getRealStaticByte(idiom->target, offset, target);
+        emitRealAsm("    leaq    %s, %%rdi", target);
+        if (idiom->source != NULL) {
+            getRealStaticByte(idiom->source, offset, source);
+            emitRealAsm("    leaq    %s, %%rsi", source);
+        }
+        emitRealAsm("    movq    $%lld, %%rcx", (bytes % 8 == 0) ? bytes / 8 : bytes);
+        emitRealAsm("    rep %s%s", idiom->source == NULL ? "stos" : "movs", unit);
+        if (save_rsi) emitRealAsm("    popq    %%rsi");
+        if (save_rdi) emitRealAsm("    popq    %%rdi");
+    }
+    
+    // the loop variable as the loop leaves it
+    getRealOperand(idiom->counter, counter);
+    emitRealAsm("    movq    $%lld, %s    # %s = %lld", idiom->last_value, counter, idiom->counter, idiom->last_value);
+}
+
+// vectorizable loop: a counted loop whose body reads and writes int or double arrays only at [i]
+// and combines the elements with + - (and * / for doubles), constants and variables the body
+// leaves alone; no iteration reads what another one writes, so 2 (SSE2) or 4 (AVX2) iterations
+// run as one and the scalar loop does the remaining count % lanes; an int "s = s + x" is a
+// reduction into one partial sum per lane; double reductions stay scalar (adding the lanes
+// separately would reassociate and change the rounding); ints have no packed 64-bit multiply
+// before AVX-512
+#define REAL_VECTOR_BODY 32           // longest body looked at
+#define REAL_VECTOR_REGISTERS 16      // %xmm0 .. %xmm15 (%xmm0 for lanes folded into a reduction)
+
+typedef enum {
+    REAL_VECTOR_LOAD,          // T = a[i]
+    REAL_VECTOR_STORE,         // a[i] = x
+    REAL_VECTOR_OP,            // T = x op y
+    REAL_VECTOR_REDUCE,        // T = s +- x (and "s = T" next) or s = s +- x (ints only)
+    REAL_VECTOR_SKIP           // s = T of a reduction
+} RealVectorRole;
+
+typedef struct {
+    RealCountedLoop loop;
+    bool is_double;                                // element type of every array (8 bytes each)
+    int lanes;                                     // elements per vector register
+    long long vector_end;                          // loop variable after the vector loop
+    RealVectorRole role[REAL_VECTOR_BODY];         // per body instruction
+    int reg[REAL_VECTOR_BODY];                     // register of the value it defines, accumulator of a reduction
+    const char* reduced[REAL_VECTOR_BODY];         // variable of a reduction
+    const char* invariant[REAL_VECTOR_REGISTERS];  // constants and variables read, broadcast before the loop
+    int invariant_reg[REAL_VECTOR_REGISTERS];
+    int invariant_count;
+} RealVectorLoop;
+
+// number of body instructions defining the name
+static int countRealVectorDefinitions(RealVectorLoop* v, const char* name) {
+    int definitions = 0;
+    for (int k = v->loop.body; k < v->loop.body_end; k++) {
+        definitions += (strcmp(getRealDefinedName(allAddress[k]), name) == 0);
+    }
+    return definitions;
+}
+
+// position of the body instruction defining the name (-1 = none)
+static int findRealVectorDefinition(RealVectorLoop* v, const char* name) {
+    for (int k = v->loop.body; k < v->loop.body_end; k++) {
+        if (strcmp(getRealDefinedName(allAddress[k]), name) == 0) return k;
+    }
+    return -1;
+}
+
+// position of the last body instruction reading the name
+static int findRealVectorLastUse(RealVectorLoop* v, const char* name) {
+    for (int k = v->loop.body_end - 1; k >= v->loop.body; k--) {
+        if (countRealUsesIn(name, k, k + 1) > 0) return k;
+    }
+    return -1;
+}
+
+// true if the body defines the name once, for the body alone: a temp of one iteration
+static bool isRealVectorTemp(RealVectorLoop* v, const char* name) {
+    return isRealTempVar(name) && isRealDoubleName(name) == v->is_double && countRealVectorDefinitions(v, name) == 1 &&
+           countRealUses(name) == countRealUsesIn(name, v->loop.body, v->loop.body_end);
+}
+
+// check an operand read at position: a temp defined earlier in the body, or a constant or
+// variable the body never writes (an invariant, added to the broadcast list)
+static bool addRealVectorOperand(RealVectorLoop* v, const char* operand, int position) {
+    long long bits;
+    if (strcmp(operand, v->loop.counter) == 0) return false;
+    
+    int definition = findRealVectorDefinition(v, operand);
+    if (definition != -1) {
+        RealVectorRole role = v->role[definition - v->loop.body];
+        return definition < position && isRealVectorTemp(v, operand) && (role == REAL_VECTOR_LOAD || role == REAL_VECTOR_OP);
+    }
+    
+    for (int n = 0; n < v->invariant_count; n++) {
+        if (strcmp(v->invariant[n], operand) == 0) return true;
+    }
+    if (!getRealConstantBits(operand, v->is_double, &bits)) {
+        if (isRealNumber(operand) || isDouble((char*)operand) || isCharConstant((char*)operand)) return false;
+        if (strcmp(operand, "true") == 0 || strcmp(operand, "false") == 0) return false;
+        if (isRealArrayName(operand) || isRealDoubleName(operand) != v->is_double) return false;
+    }
+    if (v->invariant_count == REAL_VECTOR_REGISTERS) return false;
+    v->invariant[v->invariant_count++] = operand;
+    return true;
+}
+
+// check an array access at [i] inside the arrays' bounds
+static bool isRealVectorAccess(RealVectorLoop* v, const char* array, const char* index) {
+    return strcmp(index, v->loop.counter) == 0 && getRealElementSize(array) == 8 && isRealDoubleName(array) == v->is_double &&
+           isRealArrayRange(array, v->loop.first, v->loop.count);
+}
+
+// first free register (-1 = none left)
+static int takeRealVectorRegister(bool* free) {
+    for (int r = 0; r < REAL_VECTOR_REGISTERS; r++) {
+        if (free[r]) {
+            free[r] = false;
+            return r;
+        }
+    }
+    return -1;
+}
+
+// register holding the value of an operand at position
+static int getRealVectorOperandRegister(RealVectorLoop* v, const char* operand) {
+    int definition = findRealVectorDefinition(v, operand);
+    if (definition != -1) return v->reg[definition - v->loop.body];
+    for (int n = 0; n < v->invariant_count; n++) {
+        if (strcmp(v->invariant[n], operand) == 0) return v->invariant_reg[n];
+    }
+    return -1;
+}
+
+// free the register of an operand whose last use is at position
+static void freeRealVectorOperand(RealVectorLoop* v, const char* operand, int position, bool* free) {
+    if (findRealVectorDefinition(v, operand) != -1 && findRealVectorLastUse(v, operand) == position) {
+        free[getRealVectorOperandRegister(v, operand)] = true;
+    }
+}
+
+// vectorizable loop starting at the label at position
+static bool findRealVectorLoop(int position, RealVectorLoop* v) {
+    if (real_vector_isa == VECTOR_NONE || !findRealCountedLoop(position, &v->loop)) return false;
+    RealCountedLoop* loop = &v->loop;
+    if (loop->body_end - loop->body > REAL_VECTOR_BODY) return false;
+    
+    v->lanes = (real_vector_isa == VECTOR_AVX2) ? 4 : 2;
+    v->vector_end = loop->first + loop->count / v->lanes * v->lanes;
+    v->invariant_count = 0;
+    if (loop->count < v->lanes) return false;
+    
+    // element type: that of the first array in the body
+    const char* first_array = NULL;
+    for (int k = loop->body; k < loop->body_end && first_array == NULL; k++) {
+        if (allAddress[k]->type == ADDR_ARRAY_READ) first_array = allAddress[k]->array_read.array;
+        if (allAddress[k]->type == ADDR_ARRAY_WRITE) first_array = allAddress[k]->array_write.array;
+    }
+    if (first_array == NULL) return false;
+    v->is_double = isRealDoubleName(first_array);
+    
+    // registers the register allocator left alone; %xmm0 folds lanes, %xmm1 is scratch of scalar code only
+    bool free[REAL_VECTOR_REGISTERS];
+    for (int r = 0; r < REAL_VECTOR_REGISTERS; r++) {
+        char name[8];
+        sprintf(name, "%%xmm%d", r);
+        free[r] = (r == 1) || (r >= 2 && !isRegisterInUse(name));
+    }
+    
+    // roles, invariants and reductions
+    for (int k = loop->body; k < loop->body_end; k++) {
+        address* addr = allAddress[k];
+        int p = k - loop->body;
+        v->reg[p] = -1;
+        v->reduced[p] = NULL;
+        
+        if (addr->type == ADDR_ARRAY_READ) {
+            if (!isRealVectorAccess(v, addr->array_read.array, addr->array_read.index)) return false;
+            v->role[p] = REAL_VECTOR_LOAD;
+            if (!isRealVectorTemp(v, addr->array_read.result)) return false;
+            
+        } else if (addr->type == ADDR_ARRAY_WRITE) {
+            if (!isRealVectorAccess(v, addr->array_write.array, addr->array_write.index)) return false;
+            v->role[p] = REAL_VECTOR_STORE;
+            if (!addRealVectorOperand(v, addr->array_write.value, k)) return false;
+            
+        } else if (addr->type == ADDR_BINOP) {
+            const char* op = addr->binop.op;
+            if (strcmp(op, "+") != 0 && strcmp(op, "-") != 0 && (!v->is_double || (strcmp(op, "*") != 0 && strcmp(op, "/") != 0))) return false;
+            
+            // reduction: "T = s op x ; s = T" or "s = s op x", s read nowhere else in the body
+            const char* s = addr->binop.result;
+            bool copied = false;
+            if (k + 1 < loop->body_end && allAddress[k + 1]->type == ADDR_ASSIGN &&
+                strcmp(allAddress[k + 1]->assign.arg1, s) == 0 && countRealUses(s) == 1) {
+                s = allAddress[k + 1]->assign.result;
+                copied = true;
+            }
+            bool commutes = (strcmp(op, "+") == 0 || strcmp(op, "*") == 0);
+            bool reduction = !isRealTempVar(s) && strcmp(s, loop->counter) != 0 && isRealDoubleName(s) == v->is_double &&
+                             (strcmp(addr->binop.arg1, s) == 0 || (commutes && strcmp(addr->binop.arg2, s) == 0)) &&
+                             countRealVectorDefinitions(v, s) == 1 && countRealUsesIn(s, loop->body, loop->body_end) == 1;
+            if (reduction) {
+                if (v->is_double) return false; // strict order of the scalar loop
+                const char* x = (strcmp(addr->binop.arg1, s) == 0) ? addr->binop.arg2 : addr->binop.arg1;
+                if (!addRealVectorOperand(v, x, k)) return false;
+                v->role[p] = REAL_VECTOR_REDUCE;
+                v->reduced[p] = s;
+                v->reg[p] = takeRealVectorRegister(free);
+                if (v->reg[p] == -1) return false;
+                if (copied) {
+                    v->role[p + 1] = REAL_VECTOR_SKIP;
+                    v->reg[p + 1] = -1;
+                    v->reduced[p + 1] = NULL;
+                    k++;
+                }
+                continue;
+            }
+            
+            v->role[p] = REAL_VECTOR_OP;
+            if (!isRealVectorTemp(v, addr->binop.result)) return false;
+            if (!addRealVectorOperand(v, addr->binop.arg1, k) || !addRealVectorOperand(v, addr->binop.arg2, k)) return false;
+            
+        } else {
+            return false;
+        }
+    }
+    
+    // the invariants keep their register for the whole loop
+    for (int n = 0; n < v->invariant_count; n++) {
+        v->invariant_reg[n] = takeRealVectorRegister(free);
+        if (v->invariant_reg[n] == -1) return false;
+    }
+    
+    // temps: a register from definition to last use; SSE2 computes into the first operand
+    for (int k = loop->body; k < loop->body_end; k++) {
+        address* addr = allAddress[k];
+        int p = k - loop->body;
+        
+        switch (v->role[p]) {
+            case REAL_VECTOR_LOAD:
+                v->reg[p] = takeRealVectorRegister(free);
+                break;
+                
+            case REAL_VECTOR_OP: {
+                const char* x = addr->binop.arg1;
+                const char* y = addr->binop.arg2;
+                bool x_dies = findRealVectorDefinition(v, x) != -1 && findRealVectorLastUse(v, x) == k;
+                if (v->lanes == 2 && x_dies) {
+                    v->reg[p] = getRealVectorOperandRegister(v, x);
+                    if (strcmp(x, y) != 0) freeRealVectorOperand(v, y, k, free);
+                } else if (v->lanes == 2) {
+                    v->reg[p] = takeRealVectorRegister(free);
+                    freeRealVectorOperand(v, y, k, free);
+                } else {
+                    freeRealVectorOperand(v, x, k, free);
+                    if (strcmp(x, y) != 0) freeRealVectorOperand(v, y, k, free);
+                    v->reg[p] = takeRealVectorRegister(free);
+                }
+                break;
+            }
+                
+            case REAL_VECTOR_STORE:
+                freeRealVectorOperand(v, addr->array_write.value, k, free);
+                break;
+                
+            case REAL_VECTOR_REDUCE: {
+                const char* x = (strcmp(addr->binop.arg1, v->reduced[p]) == 0) ? addr->binop.arg2 : addr->binop.arg1;
+                freeRealVectorOperand(v, x, k, free);
+                break;
+            }
+                
+            default:
+                break;
+        }
+        if (v->role[p] == REAL_VECTOR_LOAD || v->role[p] == REAL_VECTOR_OP) {
+            if (v->reg[p] == -1) return false;
+            if (findRealVectorLastUse(v, getRealDefinedName(addr)) == -1) free[v->reg[p]] = true; // never read
+        }
+    }
+    return true;
+}
+
+// name of a vector register (%xmm with SSE2, %ymm with AVX2)
+static void getRealVectorRegister(RealVectorLoop* v, int reg, char* output) {
+    sprintf(output, "%%%cmm%d", v->lanes == 4 ? 'y' : 'x', reg);
+}
+
+// packed instruction of an operator
+static const char* getRealVectorInstruction(const char* op, bool is_double) {
+    if (!is_double) return (op[0] == '+') ? "paddq" : "psubq";
+    if (op[0] == '+') return "addpd";
+    if (op[0] == '-') return "subpd";
+    if (op[0] == '*') return "mulpd";
+    return "divpd";
+}
+
+// value of an invariant in every element of a vector register: a double straight from its register,
+// stack slot or the constant pool, an int from its register or stack slot (constants through %rax)
+static void generateRealVectorBroadcast(RealVectorLoop* v, const char* operand, int reg) {
+    char source[128], xmm[8];
+    long long bits;
+    sprintf(xmm, "%%xmm%d", reg);
+    
+    if (v->is_double) {
+        getRealDoubleOperand(operand, source);
+        if (!isRealXmmRegister(source)) {
+            loadRealDouble(operand, xmm);
+            strcpy(source, xmm);
+        }
+    } else {
+        getRealOperand(operand, source);
+        if (getRealConstantBits(operand, false, &bits)) {
+            loadRealBits(bits);
+            strcpy(source, "%rax");
+        }
+        emitRealAsm("    movq    %s, %s", source, xmm);
+        strcpy(source, xmm);
+    }
+    
+    if (v->lanes == 4) {
+        emitRealAsm("    %s %s, %%ymm%d", v->is_double ? "vbroadcastsd" : "vpbroadcastq", source, reg);
+    } else {
+        emitRealAsm("    pshufd  $68, %s, %s", source, xmm);
+    }
+}
+
+// generate the vector loop in front of a vectorizable loop, which then runs the remaining iterations:
+//   for (i = 0; i < 101; i++) c[i] = a[i] + b[i];   ==>   movq    $0, %rcx
+//                                                     LV0:  movdqu  a.arr(,%rcx,8), %xmm2
+//                                                           movdqu  b.arr(,%rcx,8), %xmm3
+//                                                           paddq   %xmm3, %xmm2
+//                                                           movdqu  %xmm2, c.arr(,%rcx,8)
+//                                                           addq    $2, %rcx ; cmpq $100, %rcx ; jl LV0
+void generateRealVectorLoop(RealVectorLoop* v, int number) {
+    RealCountedLoop* loop = &v->loop;
+    bool avx = (v->lanes == 4);
+    const char* prefix = avx ? "v" : "";
+    const char* move = v->is_double ? "movupd" : "movdqu";
+    char a[16], b[16], c[16], operand[128], element[MAX_NAME + 32];
+    
+    emitRealAsm("    # %s = %lld .. %lld in %s vectors of %d, the loop below does the rest", loop->counter, loop->first,
+            v->vector_end - 1, avx ? "AVX2" : "SSE2", v->lanes);
+    
+    // invariants in every element, int accumulators at 0 (added to s after the loop)
+    for (int n = 0; n < v->invariant_count; n++) {
+        generateRealVectorBroadcast(v, v->invariant[n], v->invariant_reg[n]);
+    }
+    for (int p = 0; p < loop->body_end - loop->body; p++) {
+        if (v->role[p] != REAL_VECTOR_REDUCE) continue;
+        getRealVectorRegister(v, v->reg[p], a);
+        if (avx) {
+            emitRealAsm("    vpxor   %s, %s, %s", a, a, a);
+        } else {
+            emitRealAsm("    pxor    %s, %s", a, a);
+        }
+    }
+    
+    emitRealAsm("    movq    $%lld, %%rcx", loop->first);
+    emitRealAsm("LV%d:", number);
+    for (int k = loop->body; k < loop->body_end; k++) {
+        address* addr = allAddress[k];
+        int p = k - loop->body;
+        
+        switch (v->role[p]) {
+            case REAL_VECTOR_LOAD:
+                getRealStaticArrayLabel(addr->array_read.array, element);
+                getRealVectorRegister(v, v->reg[p], a);
+                emitRealAsm("    %s%-*s %s(,%%rcx,8), %s", prefix, avx ? 6 : 7, move, element, a);
+                break;
+                
+            case REAL_VECTOR_STORE:
+                getRealStaticArrayLabel(addr->array_write.array, element);
+                getRealVectorRegister(v, getRealVectorOperandRegister(v, addr->array_write.value), a);
+                emitRealAsm("    %s%-*s %s, %s(,%%rcx,8)", prefix, avx ? 6 : 7, move, a, element);
+                break;
+                
+            case REAL_VECTOR_OP: {
+                const char* instruction = getRealVectorInstruction(addr->binop.op, v->is_double);
+                getRealVectorRegister(v, getRealVectorOperandRegister(v, addr->binop.arg1), a);
+                getRealVectorRegister(v, getRealVectorOperandRegister(v, addr->binop.arg2), b);
+                getRealVectorRegister(v, v->reg[p], c);
+                if (avx) {
+                    emitRealAsm("    v%-6s %s, %s, %s", instruction, b, a, c);
+                } else {
+                    if (strcmp(a, c) != 0) emitRealAsm("    movapd  %s, %s", a, c);
+                    emitRealAsm("    %-7s %s, %s", instruction, b, c);
+                }
+                break;
+            }
+                
+            case REAL_VECTOR_REDUCE: {
+                const char* x = (strcmp(addr->binop.arg1, v->reduced[p]) == 0) ? addr->binop.arg2 : addr->binop.arg1;
+                getRealVectorRegister(v, getRealVectorOperandRegister(v, x), b);
+                getRealVectorRegister(v, v->reg[p], a);
+                if (avx) {
+                    emitRealAsm("    vpaddq  %s, %s, %s", b, a, a);
+                } else {
+                    emitRealAsm("    paddq   %s, %s", b, a);
+                }
+                break;
+            }
+                
+            default:
+                break;
+        }
+    }
+    emitRealAsm("    addq    $%d, %%rcx", v->lanes);
+    emitRealAsm("    cmpq    $%lld, %%rcx", v->vector_end);
+    emitRealAsm("    jl      LV%d", number);
+    
+    // int accumulators: sum of the lanes added to s
+    for (int p = 0; p < loop->body_end - loop->body; p++) {
+        if (v->role[p] != REAL_VECTOR_REDUCE || !avx) continue;
+        emitRealAsm("    vextracti128 $1, %%ymm%d, %%xmm0", v->reg[p]);
+        emitRealAsm("    vpaddq  %%xmm0, %%xmm%d, %%xmm%d", v->reg[p], v->reg[p]);
+    }
+    if (avx) emitRealAsm("    vzeroupper");
+    for (int p = 0; p < loop->body_end - loop->body; p++) {
+        if (v->role[p] != REAL_VECTOR_REDUCE) continue;
+        getRealOperand(v->reduced[p], operand);
+        emitRealAsm("    pshufd  $78, %%xmm%d, %%xmm0", v->reg[p]);
+        emitRealAsm("    paddq   %%xmm0, %%xmm%d", v->reg[p]);
+        emitRealAsm("    movq    %%xmm%d, %%rax", v->reg[p]);
+        emitRealAsm("    %sq    %%rax, %s", allAddress[loop->body + p]->binop.op[0] == '+' ? "add" : "sub", operand);
+    }
+    
+    getRealOperand(loop->counter, operand);
+    emitRealAsm("    movq    $%lld, %s    # %s = %lld", v->vector_end, operand, loop->counter, v->vector_end);
+}
+
+// allocate a stack slot for an operand that lives on the stack and has none yet
+static void mapOperand(const char* operand) {
+    if (isRealNumber(operand) || isRealLabel(operand) || isCharConstant((char*)operand)) return;
+    if (strcmp(operand, "true") == 0 || strcmp(operand, "false") == 0) return;
+    getStackOffset(operand);
+}
+
+// allocate a stack slot for every operand of the TAC that has none yet
+static void mapAllOperands() {
     for (int i = 0; i < addr_count; i++) {
         address* addr = allAddress[i];
         
         switch (addr->type) {
             case ADDR_ASSIGN:
-                getStackOffset(addr->assign.result);
-                getStackOffset(addr->assign.arg1);
+                mapOperand(addr->assign.result);
+                mapOperand(addr->assign.arg1);
                 break;
                 
             case ADDR_BINOP:
-                getStackOffset(addr->binop.result);
-                getStackOffset(addr->binop.arg1);
-                getStackOffset(addr->binop.arg2);
+                mapOperand(addr->binop.result);
+                mapOperand(addr->binop.arg1);
+                mapOperand(addr->binop.arg2);
                 break;
                 
             case ADDR_UNOP:
-                getStackOffset(addr->unop.result);
-                getStackOffset(addr->unop.arg1);
+                mapOperand(addr->unop.result);
+                mapOperand(addr->unop.arg1);
                 break;
                 
             case ADDR_IF_F_GOTO:
-                getStackOffset(addr->if_false.condition);
+                mapOperand(addr->if_false.condition);
                 break;
                 
             case ADDR_IF_T_GOTO:
-                getStackOffset(addr->if_true.condition);
+                mapOperand(addr->if_true.condition);
                 break;
                 
             case ADDR_ARRAY_READ:
-                getStackOffset(addr->array_read.result);
-                getStackOffset(addr->array_read.index);
+                mapOperand(addr->array_read.result);
+                mapOperand(addr->array_read.index);
                 break;
                 
             case ADDR_ARRAY_WRITE:
-                getStackOffset(addr->array_write.index);
-                getStackOffset(addr->array_write.value);
+                mapOperand(addr->array_write.index);
+                mapOperand(addr->array_write.value);
                 break;
                 
             default:
                 break;
         }
     }
+}
+
+// --vector=none|sse2|avx2 (false if unknown)
+bool setVectorIsa(const char* name) {
+    if (strcmp(name, "none") == 0) {
+        real_vector_isa = VECTOR_NONE;
+    } else if (strcmp(name, "sse2") == 0) {
+        real_vector_isa = VECTOR_SSE2;
+    } else if (strcmp(name, "avx2") == 0) {
+        real_vector_isa = VECTOR_AVX2;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// main function to convert 3-address code to real x86-64 assembly
+void generateRealTargetCode() {
+    // start a new assembly listing
+    clearRealAsm();
+    real_double_pool_count = 0;
+    real_loop_idioms = 0;
+    real_loops_vectorized = 0;
+    real_parity_labels = 0;
+    buildRealSymbolIndex();
+    findRealDoubleNames();
+    findRealStaticArrays();
+    
+    // build variable to stack offset mapping
+    buildVariableStackMap();
+    
+    // PASS 1: pre-allocate stack space for all temp variables
+    // process all instructions to discover all temps and allocate their stack space
+    mapAllOperands();
+    stack_frame_before = getRealFrameSize();
+    
+    // keep values in registers (06_03) and share slots between names that are never
+    // alive at the same time (06_02); -O0 keeps one slot per name
+    if (strcmp(opt_pipeline_name, "-O0") != 0) {
+        clearVarStackMap();
+        current_stack_offset = -8;
+        
+        analyzeRealLiveness();
+        allocateRegisters();
+        current_stack_offset = allocateStackSlots(current_stack_offset);
+        current_stack_offset = allocateRegisterSaveSlots(current_stack_offset);
+        mapAllOperands();
+    }
+    stack_frame_after = getRealFrameSize();
     
     // NOW generate prologue with correct stack size
     generateRealPrologue();
@@ -549,6 +2171,12 @@ void generateRealTargetCode() {
                 break;
                 
             case ADDR_BINOP:
+                // comparison that only feeds the next branch: cmpq + jcc, no boolean in between
+                if (isRealFusedCompare(i)) {
+                    generateRealCompareAndBranch(addr, allAddress[i + 1]);
+                    i++;
+                    break;
+                }
                 generateRealBinOp(addr);
                 break;
                 
@@ -568,16 +2196,31 @@ void generateRealTargetCode() {
                 generateRealIfTrueGoto(addr);
                 break;
                 
-            case ADDR_LABEL:
+            case ADDR_LABEL: {
+                // fill or copy loop: no loop at all, straight stores or a rep stos / rep movs
+                RealLoopIdiom idiom;
+                if (findRealLoopIdiom(i, &idiom)) {
+                    generateRealLoopIdiom(&idiom);
+                    real_loop_idioms++;
+                    i = idiom.end;
+                    break;
+                }
+                // loop over int / double arrays: a vector loop first, this loop does the rest
+                RealVectorLoop vector;
+                if (findRealVectorLoop(i, &vector)) {
+                    generateRealVectorLoop(&vector, real_loops_vectorized);
+                    real_loops_vectorized++;
+                }
                 generateRealLabel(addr);
                 break;
+            }
                 
             case ADDR_ARRAY_READ:
                 generateRealArrayRead(addr);
                 break;
                 
             case ADDR_ARRAY_WRITE:
-                generateRealArrayWrite(addr);
+                if (!realInitFolded[i]) generateRealArrayWrite(addr); // initializer in the static image
                 break;
                 
             default:
@@ -587,4 +2230,6 @@ void generateRealTargetCode() {
     
     // generate epilogue
     generateRealEpilogue();
+    generateRealDoublePool();
+    generateRealStaticArrays();
 }
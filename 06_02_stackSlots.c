@@ -0,0 +1,497 @@
+/**
+ * 06_02_stackSlots.c - Stack Slot Sharing for the x86-64 Backend
+ *
+ * Without this module every temporary and variable gets its own 8-byte slot,
+ * so the frame grows with the number of temporaries the program ever used.
+ * Here the slots follow the values that are alive at the same time:
+ * names whose live ranges never overlap share a slot.
+ *
+ * Features:
+ * - Live variables over the final TAC (basic blocks of allAddress, jumps
+ *   followed through their labels), bit sets per block; the same analysis
+ *   gives the live intervals of the register allocator (06_03)
+ * - Interference graph: a definition interferes with everything live after it
+ *   (except the source of a copy, so copies can be coalesced)
+ * - Coalescing: "a = b" where a and b do not interfere puts both names in one
+ *   slot, the copy then needs no code at all
+ * - Slot colouring: greedy, in order of first appearance, smallest free slot
+ * - Names that got a register need no slot; arrays keep their own space;
+ *   -O0 keeps one slot per name
+ * - Frame size with and without sharing is reported (terminal and report)
+ *
+ * Example:
+ *   T1 = a + 1        T1 -> slot 0
+ *   b = T1            b  -> slot 0 (coalesced with T1, no code)
+ *   T2 = b * 2        T2 -> slot 1
+ *   c = T2            c  -> slot 1 (coalesced with T2, no code)
+ *
+ * Author: Ridham Khurana
+ */
+
+#include "database.h"
+
+// statistics of the last allocation
+int stack_frame_before = 0;     // frame size (bytes) with one slot per name
+int stack_frame_after = 0;      // frame size (bytes) actually used
+int stack_slot_names = 0;       // scalar names that got a slot
+int stack_slot_count = 0;       // slots they share
+int stack_copies_coalesced = 0; // copies whose two names were put in one slot
+
+// names of the TAC (temporaries and scalar variables), index = first appearance
+static char** slotNames = NULL;
+static int slot_name_count = 0;
+static int* slotTable = NULL;   // open addressing: hash slot -> name index (-1 = empty)
+static int slot_table_size = 0;
+
+// bit sets of 64-bit words, 'slot_words' words per set
+static int slot_words = 0;
+
+static void* slotAlloc(size_t count , size_t size){
+    void* memory = calloc(count ? count : 1 , size);
+    if(memory == NULL){
+        printf("06_02 || Stack slot allocation error [06_02.01] -> Memory allocation failed for stack slot analysis\n");
+        exit(6);
+    }
+    return memory;
+}
+
+// true if the operand is kept in a stack slot of its own (not a constant, label or array)
+static bool slotIsCandidate(const char* name){
+    if(name == NULL || name[0] == '\0') return false;
+    if(isRealNumber(name) || isRealLabel(name)) return false;
+    if(strcmp(name , "true") == 0 || strcmp(name , "false") == 0) return false;
+    if(isCharConstant((char*)name)) return false;
+    return !isRealArrayName(name);
+}
+
+// index of a name (-1 if it is not a candidate); adds it when 'add' is set
+static int slotIndexOf(const char* name , bool add){
+    if(name == NULL || name[0] == '\0') return -1;
+
+    int mask = slot_table_size - 1;
+    int h = hashString(name) & mask;
+    while(slotTable[h] != -1){
+        if(strcmp(slotNames[slotTable[h]] , name) == 0) return slotTable[h];
+        h = (h + 1) & mask;
+    }
+
+    if(!add || !slotIsCandidate(name)) return -1;
+
+    slotNames[slot_name_count] = (char*)name;
+    slotTable[h] = slot_name_count;
+    return slot_name_count++;
+}
+
+// name defined by the instruction and the names it uses (indices, -1 = none)
+static int slotDefAndUses(address* addr , int uses[2] , bool add){
+    int def = -1;
+    uses[0] = -1;
+    uses[1] = -1;
+
+    switch(addr->type){
+        case ADDR_ASSIGN:
+            uses[0] = slotIndexOf(addr->assign.arg1 , add);
+            def = slotIndexOf(addr->assign.result , add);
+            break;
+        case ADDR_BINOP:
+            uses[0] = slotIndexOf(addr->binop.arg1 , add);
+            uses[1] = slotIndexOf(addr->binop.arg2 , add);
+            def = slotIndexOf(addr->binop.result , add);
+            break;
+        case ADDR_UNOP:
+            uses[0] = slotIndexOf(addr->unop.arg1 , add);
+            def = slotIndexOf(addr->unop.result , add);
+            break;
+        case ADDR_IF_F_GOTO:
+            uses[0] = slotIndexOf(addr->if_false.condition , add);
+            break;
+        case ADDR_IF_T_GOTO:
+            uses[0] = slotIndexOf(addr->if_true.condition , add);
+            break;
+        case ADDR_ARRAY_READ:
+            uses[0] = slotIndexOf(addr->array_read.index , add);
+            def = slotIndexOf(addr->array_read.result , add);
+            break;
+        case ADDR_ARRAY_WRITE:
+            uses[0] = slotIndexOf(addr->array_write.index , add);
+            uses[1] = slotIndexOf(addr->array_write.value , add);
+            break;
+        default:
+            break;
+    }
+
+    return def;
+}
+
+static bool slotJumps(address* addr){
+    return addr->type == ADDR_GOTO || addr->type == ADDR_IF_F_GOTO || addr->type == ADDR_IF_T_GOTO;
+}
+
+static char* slotJumpTarget(address* addr){
+    if(addr->type == ADDR_GOTO) return addr->goto_stmt.target;
+    if(addr->type == ADDR_IF_F_GOTO) return addr->if_false.target;
+    if(addr->type == ADDR_IF_T_GOTO) return addr->if_true.target;
+    return NULL;
+}
+
+#define SLOT_TEST(set , i) (((set)[(i) >> 6] >> ((i) & 63)) & 1ULL)
+#define SLOT_SET(set , i) ((set)[(i) >> 6] |= 1ULL << ((i) & 63))
+#define SLOT_CLEAR(set , i) ((set)[(i) >> 6] &= ~(1ULL << ((i) & 63)))
+
+// union-find over the names (coalesced names share one representative)
+static int* slotParent = NULL;
+
+static int slotFind(int i){
+    while(slotParent[i] != i){
+        slotParent[i] = slotParent[slotParent[i]];
+        i = slotParent[i];
+    }
+    return i;
+}
+
+// live variables of the last analyzeRealLiveness() (kept until allocateStackSlots())
+static int slot_blocks = 0;
+static int* slotBlockStart = NULL;
+static unsigned long long* slotIn = NULL;   // live on entry of each block
+static unsigned long long* slotOut = NULL;  // live on exit of each block
+static int* slotStart = NULL;               // live interval of each name (first and last position)
+static int* slotEnd = NULL;
+static int* slotDefAt = NULL;               // name defined at each position (-1 = none)
+
+// live variables over the final TAC: names, basic blocks, live IN/OUT and one live interval per name
+void analyzeRealLiveness(){
+    int n = addr_count;
+
+    // ---- names ----
+    int max_names = 3 * n + 1;
+    slot_table_size = hashTableSize(max_names);
+    slotNames = (char**)slotAlloc(max_names , sizeof(char*));
+    slotTable = (int*)slotAlloc(slot_table_size , sizeof(int));
+    for(int i=0 ; i<slot_table_size ; i++) slotTable[i] = -1;
+    slot_name_count = 0;
+
+    int uses[2];
+    slotDefAt = (int*)slotAlloc(n , sizeof(int));
+    for(int i=0 ; i<n ; i++) slotDefAt[i] = slotDefAndUses(allAddress[i] , uses , true);
+
+    int names = slot_name_count;
+    slot_words = (names + 63) / 64;
+
+    // ---- basic blocks of the linear code ----
+    int* blockOf = (int*)slotAlloc(n , sizeof(int));
+    slotBlockStart = (int*)slotAlloc(n + 1 , sizeof(int));
+    int blocks = 0;
+    for(int i=0 ; i<n ; i++){
+        if(i == 0 || allAddress[i]->type == ADDR_LABEL || slotJumps(allAddress[i-1])) slotBlockStart[blocks++] = i;
+        blockOf[i] = blocks - 1;
+    }
+    slotBlockStart[blocks] = n;
+    slot_blocks = blocks;
+
+    // label number -> position of the label
+    int max_label = 0;
+    for(int i=0 ; i<n ; i++){
+        if(allAddress[i]->type == ADDR_LABEL) max_label = (atoi(allAddress[i]->label.labelNumber + 1) > max_label) ? atoi(allAddress[i]->label.labelNumber + 1) : max_label;
+    }
+    int* labelAt = (int*)slotAlloc(max_label + 1 , sizeof(int));
+    for(int i=0 ; i<=max_label ; i++) labelAt[i] = -1;
+    for(int i=0 ; i<n ; i++){
+        if(allAddress[i]->type == ADDR_LABEL) labelAt[atoi(allAddress[i]->label.labelNumber + 1)] = i;
+    }
+
+    // successors: jump target and/or the next block
+    int* succ = (int*)slotAlloc(2 * blocks , sizeof(int));
+    for(int b=0 ; b<blocks ; b++){
+        address* last = allAddress[slotBlockStart[b+1] - 1];
+        succ[2*b] = -1;
+        succ[2*b+1] = -1;
+
+        if(slotJumps(last)){
+            int label = atoi(slotJumpTarget(last) + 1);
+            if(label >= 0 && label <= max_label && labelAt[label] != -1) succ[2*b] = blockOf[labelAt[label]];
+        }
+        if(last->type != ADDR_GOTO && b+1 < blocks) succ[2*b+1] = b+1;
+    }
+
+    // ---- live variables per block ----
+    unsigned long long* use = (unsigned long long*)slotAlloc((size_t)blocks * slot_words , sizeof(unsigned long long));
+    unsigned long long* def = (unsigned long long*)slotAlloc((size_t)blocks * slot_words , sizeof(unsigned long long));
+    slotIn = (unsigned long long*)slotAlloc((size_t)blocks * slot_words , sizeof(unsigned long long));
+    slotOut = (unsigned long long*)slotAlloc((size_t)blocks * slot_words , sizeof(unsigned long long));
+
+    for(int b=0 ; b<blocks ; b++){
+        unsigned long long* u = &use[(size_t)b * slot_words];
+        unsigned long long* d = &def[(size_t)b * slot_words];
+        for(int i=slotBlockStart[b+1]-1 ; i>=slotBlockStart[b] ; i--){
+            int defined = slotDefAndUses(allAddress[i] , uses , false);
+            if(defined != -1){
+                SLOT_SET(d , defined);
+                SLOT_CLEAR(u , defined);
+            }
+            if(uses[0] != -1) SLOT_SET(u , uses[0]);
+            if(uses[1] != -1) SLOT_SET(u , uses[1]);
+        }
+    }
+
+    // IN = USE + (OUT - DEF), OUT = union of IN of the successors; backwards until nothing changes
+    bool changed = true;
+    while(changed){
+        changed = false;
+        for(int b=blocks-1 ; b>=0 ; b--){
+            unsigned long long* o = &slotOut[(size_t)b * slot_words];
+            for(int k=0 ; k<2 ; k++){
+                if(succ[2*b+k] == -1) continue;
+                unsigned long long* s = &slotIn[(size_t)succ[2*b+k] * slot_words];
+                for(int w=0 ; w<slot_words ; w++) o[w] |= s[w];
+            }
+
+            unsigned long long* u = &use[(size_t)b * slot_words];
+            unsigned long long* d = &def[(size_t)b * slot_words];
+            unsigned long long* l = &slotIn[(size_t)b * slot_words];
+            for(int w=0 ; w<slot_words ; w++){
+                unsigned long long value = u[w] | (o[w] & ~d[w]);
+                if(value != l[w]){
+                    l[w] = value;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // ---- live intervals: every position where the name is defined or live on entry ----
+    slotStart = (int*)slotAlloc(names , sizeof(int));
+    slotEnd = (int*)slotAlloc(names , sizeof(int));
+    for(int i=0 ; i<names ; i++){
+        slotStart[i] = n;
+        slotEnd[i] = -1;
+    }
+
+    unsigned long long* live = (unsigned long long*)slotAlloc(slot_words , sizeof(unsigned long long));
+    for(int b=0 ; b<blocks ; b++){
+        memcpy(live , &slotOut[(size_t)b * slot_words] , slot_words * sizeof(unsigned long long));
+
+        for(int i=slotBlockStart[b+1]-1 ; i>=slotBlockStart[b] ; i--){
+            int defined = slotDefAndUses(allAddress[i] , uses , false);
+            if(defined != -1){
+                SLOT_CLEAR(live , defined);
+                if(i < slotStart[defined]) slotStart[defined] = i;
+                if(i > slotEnd[defined]) slotEnd[defined] = i;
+            }
+            if(uses[0] != -1) SLOT_SET(live , uses[0]);
+            if(uses[1] != -1) SLOT_SET(live , uses[1]);
+
+            for(int w=0 ; w<slot_words ; w++){
+                unsigned long long bits = live[w];
+                while(bits){
+                    int name = w * 64 + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    if(i < slotStart[name]) slotStart[name] = i;
+                    if(i > slotEnd[name]) slotEnd[name] = i;
+                }
+            }
+        }
+    }
+
+    free(blockOf);
+    free(labelAt);
+    free(succ);
+    free(use);
+    free(def);
+    free(live);
+}
+
+int getRealLiveNameCount(){
+    return slot_name_count;
+}
+
+const char* getRealLiveName(int index){
+    return slotNames[index];
+}
+
+// index of a name of the last analysis (-1 if it has none)
+int findRealLiveName(const char* name){
+    return slotIndexOf(name , false);
+}
+
+void getRealLiveInterval(int index , int* start , int* end){
+    *start = slotStart[index];
+    *end = slotEnd[index];
+}
+
+// name defined by the instruction at position (-1 = none or not a scalar)
+int getRealLiveDefinedAt(int position){
+    return slotDefAt[position];
+}
+
+// give every scalar name of the last analysis that did not get a register a stack offset
+// below 'first_offset' (through setStackOffset), then drop the analysis; returns the next free offset
+int allocateStackSlots(int first_offset){
+    int names = slot_name_count;
+    int blocks = slot_blocks;
+    int uses[2];
+
+    stack_slot_names = 0;
+    stack_slot_count = 0;
+    stack_copies_coalesced = 0;
+
+    // ---- interference: a definition interferes with every name live after it ----
+    unsigned long long* graph = (unsigned long long*)slotAlloc((size_t)names * slot_words , sizeof(unsigned long long));
+    unsigned long long* live = (unsigned long long*)slotAlloc(slot_words , sizeof(unsigned long long));
+
+    for(int b=0 ; b<blocks ; b++){
+        memcpy(live , &slotOut[(size_t)b * slot_words] , slot_words * sizeof(unsigned long long));
+
+        for(int i=slotBlockStart[b+1]-1 ; i>=slotBlockStart[b] ; i--){
+            int defined = slotDefAndUses(allAddress[i] , uses , false);
+
+            if(defined != -1){
+                // the source of a copy may share the slot: both hold the same value afterwards
+                int source = (allAddress[i]->type == ADDR_ASSIGN) ? uses[0] : -1;
+                bool sourceLive = (source != -1) && SLOT_TEST(live , source);
+                if(source != -1) SLOT_CLEAR(live , source);
+
+                unsigned long long* row = &graph[(size_t)defined * slot_words];
+                for(int w=0 ; w<slot_words ; w++){
+                    unsigned long long bits = live[w];
+                    while(bits){
+                        int other = w * 64 + __builtin_ctzll(bits);
+                        bits &= bits - 1;
+                        if(other == defined) continue;
+                        SLOT_SET(row , other);
+                        SLOT_SET(&graph[(size_t)other * slot_words] , defined);
+                    }
+                }
+
+                if(sourceLive) SLOT_SET(live , source);
+                SLOT_CLEAR(live , defined);
+            }
+
+            if(uses[0] != -1) SLOT_SET(live , uses[0]);
+            if(uses[1] != -1) SLOT_SET(live , uses[1]);
+        }
+    }
+
+    // names read before any definition keep a slot of their own (never reuse a slot they could read)
+    if(blocks > 0){
+        for(int i=0 ; i<names ; i++){
+            if(!SLOT_TEST(&slotIn[0] , i)) continue;
+            for(int j=0 ; j<names ; j++){
+                if(j == i) continue;
+                SLOT_SET(&graph[(size_t)i * slot_words] , j);
+                SLOT_SET(&graph[(size_t)j * slot_words] , i);
+            }
+        }
+    }
+
+    // ---- coalescing of copies ----
+    // members[r]: names of the class of representative r; a class interferes with every name in its row
+    slotParent = (int*)slotAlloc(names , sizeof(int));
+    unsigned long long* members = (unsigned long long*)slotAlloc((size_t)names * slot_words , sizeof(unsigned long long));
+    for(int i=0 ; i<names ; i++){
+        slotParent[i] = i;
+        SLOT_SET(&members[(size_t)i * slot_words] , i);
+    }
+
+    for(int i=0 ; i<addr_count ; i++){
+        if(allAddress[i]->type != ADDR_ASSIGN) continue;
+        int defined = slotDefAndUses(allAddress[i] , uses , false);
+        if(defined == -1 || uses[0] == -1) continue;
+        if(getAllocatedRegister(defined) != -1 || getAllocatedRegister(uses[0]) != -1) continue;
+
+        int a = slotFind(defined);
+        int b = slotFind(uses[0]);
+        if(a == b) continue;
+
+        // do the two classes interfere?
+        unsigned long long* rowA = &graph[(size_t)a * slot_words];
+        unsigned long long* membersB = &members[(size_t)b * slot_words];
+        bool interferes = false;
+        for(int w=0 ; w<slot_words && !interferes ; w++) interferes = (rowA[w] & membersB[w]) != 0;
+        if(interferes) continue;
+
+        // merge b into a (the class interferes with the neighbours of both)
+        unsigned long long* rowB = &graph[(size_t)b * slot_words];
+        unsigned long long* membersA = &members[(size_t)a * slot_words];
+        for(int w=0 ; w<slot_words ; w++){
+            rowA[w] |= rowB[w];
+            membersA[w] |= membersB[w];
+        }
+        slotParent[b] = a;
+        stack_copies_coalesced++;
+    }
+
+    // ---- colouring: smallest slot no interfering class uses ----
+    int* colour = (int*)slotAlloc(names , sizeof(int));
+    int* takenBy = (int*)slotAlloc(names + 1 , sizeof(int)); // colour -> last class that saw it taken
+    for(int i=0 ; i<names ; i++){
+        colour[i] = -1;
+        takenBy[i] = -1;
+    }
+
+    for(int i=0 ; i<names ; i++){
+        int r = slotFind(i);
+        if(colour[r] != -1 || getAllocatedRegister(i) != -1) continue;
+
+        unsigned long long* row = &graph[(size_t)r * slot_words];
+        for(int w=0 ; w<slot_words ; w++){
+            unsigned long long bits = row[w];
+            while(bits){
+                int other = slotFind(w * 64 + __builtin_ctzll(bits));
+                bits &= bits - 1;
+                if(colour[other] != -1) takenBy[colour[other]] = r;
+            }
+        }
+
+        int c = 0;
+        while(takenBy[c] == r) c++;
+        colour[r] = c;
+        if(c + 1 > stack_slot_count) stack_slot_count = c + 1;
+    }
+
+    for(int i=0 ; i<names ; i++){
+        if(getAllocatedRegister(i) != -1) continue;
+        setStackOffset(slotNames[i] , first_offset - 8 * colour[slotFind(i)]);
+        stack_slot_names++;
+    }
+
+    free(slotNames);
+    free(slotTable);
+    free(slotBlockStart);
+    free(slotIn);
+    free(slotOut);
+    free(slotStart);
+    free(slotEnd);
+    free(slotDefAt);
+    free(graph);
+    free(live);
+    free(slotParent);
+    free(members);
+    free(colour);
+    free(takenBy);
+    slotNames = NULL;
+    slotTable = NULL;
+    slotBlockStart = NULL;
+    slotIn = NULL;
+    slotOut = NULL;
+    slotStart = NULL;
+    slotEnd = NULL;
+    slotDefAt = NULL;
+    slotParent = NULL;
+
+    return first_offset - 8 * stack_slot_count;
+}
+
+// frame size of the last generated code, with and without shared slots (terminal)
+void printStackFrameStats(){
+    if(stack_frame_after == stack_frame_before){
+        printf("   Stack frame: %d bytes\n" , stack_frame_after);
+        return;
+    }
+    if(stack_slot_names == 0){
+        printf("   Stack frame: %d -> %d bytes\n" , stack_frame_before , stack_frame_after);
+        return;
+    }
+
+    printf("   Stack frame: %d -> %d bytes (%d names in %d slots, %d copies coalesced)\n" ,
+           stack_frame_before , stack_frame_after , stack_slot_names , stack_slot_count , stack_copies_coalesced);
+}
@@ -0,0 +1,243 @@
+/**
+ * 06_03_registerAllocator.c - Linear-Scan Register Allocation
+ *
+ * Keeps temporaries and scalar variables of the real x86-64 assembly in
+ * general purpose registers instead of stack slots. The live intervals come
+ * from the live variables of 06_02_stackSlots.c: an interval reaches from
+ * the first to the last position the name is defined or live at.
+ *
+ * Features:
+ * - Linear scan (Poletto & Sarkar) over the intervals in order of their start
+ * - 11 registers: %rsi %rdi %r8 %r9 %r10 %r11 first (free to use), then the
+ *   callee-saved %rbx %r12 %r13 %r14 %r15 (saved in the prologue and restored
+ *   in the epilogue); %rax %rcx %rdx stay scratch registers of the patterns
+ * - No register free: the interval that ends last is spilled (stays on the
+ *   stack, where 06_02 gives it a shared slot)
+ * - A name whose last use is the instruction that defines another name hands
+ *   its register over; a copy "a = b" then prefers the register of b and
+ *   needs no code at all
+ * - Doubles get their own class: %xmm2-%xmm15 (%xmm0 and %xmm1 stay scratch
+ *   registers of the SSE2 patterns), scanned separately from the integers
+ * - "--regs=N" limits the registers (of both classes; 0 = every value on the stack)
+ *
+ * Example:
+ *   i = 0                       movq    $0, %rsi
+ *   L1:                         L1:
+ *   T1 = i < 10                 movq    %rsi, %rax
+ *   ...                         cmpq    $10, %rax
+ *
+ * Author: Ridham Khurana
+ */
+
+#include "database.h"
+
+#define REG_TOTAL (MAX_REAL_REGISTERS + MAX_REAL_XMM_REGISTERS)
+
+// general purpose registers first, then the xmm registers of the doubles
+static const char* regNames[REG_TOTAL] = {
+    "%rsi", "%rdi", "%r8", "%r9", "%r10", "%r11",
+    "%rbx", "%r12", "%r13", "%r14", "%r15",
+    "%xmm2", "%xmm3", "%xmm4", "%xmm5", "%xmm6", "%xmm7", "%xmm8",
+    "%xmm9", "%xmm10", "%xmm11", "%xmm12", "%xmm13", "%xmm14", "%xmm15"
+};
+static const bool regCalleeSaved[REG_TOTAL] = {
+    false, false, false, false, false, false,
+    true, true, true, true, true,
+    false, false, false, false, false, false, false,
+    false, false, false, false, false, false, false
+};
+
+int reg_limit = MAX_REAL_REGISTERS;
+int reg_names_allocated = 0;
+int reg_names_spilled = 0;
+int reg_used_count = 0;
+
+static int* regOf = NULL;                        // register of each name of the analysis (-1 = stack)
+static int reg_name_total = 0;
+static bool regUsed[REG_TOTAL];
+static int regSaveOffset[REG_TOTAL];    // stack slot of a saved callee-saved register
+
+// intervals of the analysis, for the sort
+static int* regStart = NULL;
+static int* regEnd = NULL;
+
+static void* regAlloc(size_t count , size_t size){
+    void* memory = calloc(count ? count : 1 , size);
+    if(memory == NULL){
+        printf("06_03 || Register allocation error [06_03.01] -> Memory allocation failed for register allocation\n");
+        exit(6);
+    }
+    return memory;
+}
+
+void setRegisterLimit(int n){
+    if(n < 0) n = 0;
+    if(n > MAX_REAL_REGISTERS) n = MAX_REAL_REGISTERS;
+    reg_limit = n;
+}
+
+// order of the intervals: by start, then by index (first appearance)
+static int regCompareStart(const void* a , const void* b){
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    if(regStart[x] != regStart[y]) return regStart[x] - regStart[y];
+    return x - y;
+}
+
+// register a copy "name = source" would like to share (source index, -1 if the name is not defined by a copy)
+static int* regCopyHints(int names){
+    int* hint = (int*)regAlloc(names , sizeof(int));
+    for(int i=0 ; i<names ; i++) hint[i] = -1;
+
+    for(int i=0 ; i<addr_count ; i++){
+        if(allAddress[i]->type != ADDR_ASSIGN) continue;
+        int defined = findRealLiveName(allAddress[i]->assign.result);
+        int source = findRealLiveName(allAddress[i]->assign.arg1);
+        if(defined != -1 && source != -1 && hint[defined] == -1) hint[defined] = source;
+    }
+
+    return hint;
+}
+
+// linear scan over the names of one class (doubles or not) with the registers first .. first+count-1
+static void regLinearScan(int* order , int names , int* hint , bool doubles , int first , int count){
+    int active[REG_TOTAL];   // names holding a register
+    int active_count = 0;
+    bool taken[REG_TOTAL] = {false};
+
+    for(int k=0 ; k<names ; k++){
+        int current = order[k];
+        int start = regStart[current];
+        if(regEnd[current] < start) continue; // never live (not possible for a name of the TAC)
+        if(isRealDoubleName(getRealLiveName(current)) != doubles) continue;
+
+        // free the registers of intervals that are over; an interval that ends where this
+        // name is defined is over as well (the instruction reads it before it writes)
+        bool definedHere = (start < addr_count && getRealLiveDefinedAt(start) == current);
+        for(int a=0 ; a<active_count ; a++){
+            int other = active[a];
+            if(regEnd[other] < start || (regEnd[other] == start && definedHere)){
+                taken[regOf[other]] = false;
+                active[a--] = active[--active_count];
+            }
+        }
+
+        // a free register: the one of the copy source if possible, else the first one
+        int reg = -1;
+        int hinted = (hint[current] != -1) ? regOf[hint[current]] : -1;
+        if(hinted >= first && hinted < first + count && !taken[hinted]) reg = hinted;
+        for(int r=first ; r<first+count && reg == -1 ; r++){
+            if(!taken[r]) reg = r;
+        }
+
+        if(reg == -1 && count > 0){
+            // none free: spill the interval that ends last
+            int last = -1;
+            for(int a=0 ; a<active_count ; a++){
+                if(last == -1 || regEnd[active[a]] > regEnd[active[last]]) last = a;
+            }
+            if(regEnd[active[last]] > regEnd[current]){
+                int spilled = active[last];
+                reg = regOf[spilled];
+                regOf[spilled] = -1;
+                taken[reg] = false;
+                active[last] = active[--active_count];
+            }
+        }
+
+        if(reg == -1) continue;
+        regOf[current] = reg;
+        taken[reg] = true;
+        active[active_count++] = current;
+    }
+}
+
+// linear scan over the live intervals of the last analyzeRealLiveness()
+void allocateRegisters(){
+    int names = getRealLiveNameCount();
+
+    free(regOf);
+    regOf = (int*)regAlloc(names , sizeof(int));
+    reg_name_total = names;
+    reg_names_allocated = 0;
+    reg_names_spilled = 0;
+    reg_used_count = 0;
+    for(int r=0 ; r<REG_TOTAL ; r++) regUsed[r] = false;
+    for(int i=0 ; i<names ; i++) regOf[i] = -1;
+
+    regStart = (int*)regAlloc(names , sizeof(int));
+    regEnd = (int*)regAlloc(names , sizeof(int));
+    int* order = (int*)regAlloc(names , sizeof(int));
+    for(int i=0 ; i<names ; i++){
+        getRealLiveInterval(i , &regStart[i] , &regEnd[i]);
+        order[i] = i;
+    }
+    qsort(order , names , sizeof(int) , regCompareStart);
+
+    int* hint = regCopyHints(names);
+    int xmm_limit = (reg_limit < MAX_REAL_REGISTERS) ? reg_limit : MAX_REAL_XMM_REGISTERS; // --regs=N below the maximum limits both classes
+    regLinearScan(order , names , hint , false , 0 , reg_limit);
+    regLinearScan(order , names , hint , true , MAX_REAL_REGISTERS , xmm_limit);
+
+    for(int i=0 ; i<names ; i++){
+        if(regOf[i] == -1){
+            reg_names_spilled++;
+            continue;
+        }
+        setRealRegister(getRealLiveName(i) , regNames[regOf[i]]);
+        reg_names_allocated++;
+        if(!regUsed[regOf[i]]) reg_used_count++;
+        regUsed[regOf[i]] = true;
+    }
+
+    free(order);
+    free(hint);
+    free(regStart);
+    free(regEnd);
+    regStart = NULL;
+    regEnd = NULL;
+}
+
+int getAllocatedRegister(int index){
+    if(regOf == NULL || index < 0 || index >= reg_name_total) return -1;
+    return regOf[index];
+}
+
+bool isRegisterInUse(const char* name){
+    for(int r=0 ; r<REG_TOTAL ; r++){
+        if(strcmp(regNames[r] , name) == 0) return regUsed[r];
+    }
+    return false;
+}
+
+// one stack slot per callee-saved register in use, below 'first_offset'; returns the next free offset
+int allocateRegisterSaveSlots(int first_offset){
+    for(int r=0 ; r<REG_TOTAL ; r++){
+        if(!regUsed[r] || !regCalleeSaved[r]) continue;
+        regSaveOffset[r] = first_offset;
+        first_offset -= 8;
+    }
+    return first_offset;
+}
+
+void generateRegisterSaves(){
+    for(int r=0 ; r<REG_TOTAL ; r++){
+        if(!regUsed[r] || !regCalleeSaved[r]) continue;
+        emitRealAsm("    movq    %s, %d(%%rbp)    # Save callee-saved register" , regNames[r] , regSaveOffset[r]);
+    }
+}
+
+void generateRegisterRestores(){
+    for(int r=0 ; r<REG_TOTAL ; r++){
+        if(!regUsed[r] || !regCalleeSaved[r]) continue;
+        emitRealAsm("    movq    %d(%%rbp), %s    # Restore callee-saved register" , regSaveOffset[r] , regNames[r]);
+    }
+}
+
+// register allocation of the last generated code (terminal)
+void printRegisterStats(){
+    if(reg_names_allocated == 0 && reg_names_spilled == 0) return;
+
+    printf("   Registers: %d names in %d registers, %d on the stack\n" ,
+           reg_names_allocated , reg_used_count , reg_names_spilled);
+}
@@ -0,0 +1,515 @@
+/**
+ * 06_04_peephole.c - Peephole Optimizer for the Real x86-64 Assembly
+ *
+ * Runs over the real assembly lines after the target code generation. Every line is
+ * parsed into a mnemonic, its operands and its comment, the rules look at a
+ * small window of instructions (comment lines do not count) and rewrite the
+ * parsed instructions; the lines are printed again at the end.
+ *
+ * Features:
+ * - Store-load forwarding: "movq %r, M" followed by "movq M, %s" loads from
+ *   the register instead ("movq %r, %s", or nothing if %s is %r)
+ * - Redundant moves: "movq X, X", a move back ("movq A, B" then "movq B, A")
+ *   and moves to a scratch register (%rax %rcx %rdx) nobody reads
+ * - Immediate strength reduction: "movq $0, %r" -> "xorl %e, %e",
+ *   "movq $c, %rcx" + "imulq %rcx, %r" -> "imulq $c, %r",
+ *   "imulq $2^k, %r" -> "shlq $k, %r", "addq $0"/"subq $0"/"imulq $1" removed
+ *   (only where no instruction reads the flags before they are set again)
+ * - Jump to the next label: "jmp L" / "jcc L" directly before "L:" removed
+ * - Counts how often each rule fired (terminal and report); not run at -O0
+ *
+ * Example:
+ *   movq    %rax, -16(%rbp)          movq    %rax, -16(%rbp)
+ *   movq    -16(%rbp), %rax   ==>    shlq    $3, %rax
+ *   movq    $8, %rcx
+ *   imulq   %rcx, %rax
+ *
+ * Author: Ridham Khurana
+ */
+
+#include "database.h"
+
+#define PEEP_MAX_OPERANDS 2
+
+typedef enum {
+    PEEP_INSTRUCTION,   // mnemonic and operands
+    PEEP_LABEL,         // "name:"
+    PEEP_OTHER,         // comment line, directive or empty line (kept as it is)
+    PEEP_DELETED        // removed by a rule
+} PeepKind;
+
+typedef struct {
+    PeepKind kind;
+    char mnemonic[16];
+    char operand[PEEP_MAX_OPERANDS][96];
+    int operand_count;
+    char comment[160];          // trailing "# ..." of an instruction ("" = none)
+    char text[256];             // label name or the whole line of PEEP_OTHER
+} PeepLine;
+
+// statistics of the last run
+int peep_store_load_forwarded = 0;
+int peep_moves_removed = 0;
+int peep_strength_reduced = 0;
+int peep_jumps_removed = 0;
+int peep_lines_before = 0;
+int peep_lines_after = 0;
+
+static PeepLine* peepLines = NULL;
+static int peep_count = 0;
+
+// x86-64 registers by family (64, 32, 16, 8 bit names)
+#define PEEP_FAMILIES 16
+static const char* peepFamilies[PEEP_FAMILIES][4] = {
+    {"%rax", "%eax", "%ax", "%al"},   {"%rcx", "%ecx", "%cx", "%cl"},
+    {"%rdx", "%edx", "%dx", "%dl"},   {"%rbx", "%ebx", "%bx", "%bl"},
+    {"%rsi", "%esi", "%si", "%sil"},  {"%rdi", "%edi", "%di", "%dil"},
+    {"%rbp", "%ebp", "%bp", "%bpl"},  {"%rsp", "%esp", "%sp", "%spl"},
+    {"%r8", "%r8d", "%r8w", "%r8b"},  {"%r9", "%r9d", "%r9w", "%r9b"},
+    {"%r10", "%r10d", "%r10w", "%r10b"}, {"%r11", "%r11d", "%r11w", "%r11b"},
+    {"%r12", "%r12d", "%r12w", "%r12b"}, {"%r13", "%r13d", "%r13w", "%r13b"},
+    {"%r14", "%r14d", "%r14w", "%r14b"}, {"%r15", "%r15d", "%r15w", "%r15b"}
+};
+#define PEEP_RAX 0
+#define PEEP_RCX 1
+#define PEEP_RDX 2
+#define PEEP_RSI 4
+#define PEEP_RDI 5
+
+// ---------------------------------------------------------------- parsing ---
+
+static void peepTrim(char* str){
+    int end = strlen(str);
+    while(end > 0 && isspace((unsigned char)str[end-1])) str[--end] = '\0';
+    int start = 0;
+    while(str[start] && isspace((unsigned char)str[start])) start++;
+    if(start > 0) memmove(str , str + start , end - start + 1);
+}
+
+static void peepParse(const char* line , PeepLine* out){
+    char buffer[256];
+    strncpy(buffer , line , 255);
+    buffer[255] = '\0';
+
+    memset(out , 0 , sizeof(PeepLine));
+    strcpy(out->text , buffer);
+
+    char body[256];
+    strcpy(body , buffer);
+    peepTrim(body);
+
+    // comment lines, directives and empty lines are kept as they are
+    if(body[0] == '\0' || body[0] == '#' || body[0] == '.'){
+        out->kind = PEEP_OTHER;
+        return;
+    }
+    if(line[0] != ' ' && body[strlen(body)-1] == ':'){
+        out->kind = PEEP_LABEL;
+        strcpy(out->text , body);
+        out->text[strlen(out->text)-1] = '\0';
+        return;
+    }
+
+    // trailing comment
+    char* hash = strchr(body , '#');
+    if(hash != NULL){
+        strncpy(out->comment , hash , sizeof(out->comment) - 1);
+        *hash = '\0';
+        peepTrim(body);
+    }
+
+    // mnemonic
+    int i = 0;
+    while(body[i] && !isspace((unsigned char)body[i]) && i < (int)sizeof(out->mnemonic) - 1){
+        out->mnemonic[i] = body[i];
+        i++;
+    }
+    out->mnemonic[i] = '\0';
+
+    // operands, split at commas outside of parentheses
+    char* rest = body + i;
+    while(*rest && isspace((unsigned char)*rest)) rest++;
+    int depth = 0;
+    int length = 0;
+    out->kind = PEEP_INSTRUCTION;
+    if(*rest == '\0') return;
+    for(char* c=rest ; ; c++){
+        if(*c == '(') depth++;
+        if(*c == ')') depth--;
+        if((*c == ',' && depth == 0) || *c == '\0'){
+            if(out->operand_count == PEEP_MAX_OPERANDS){
+                // more operands than the rules know: keep the line untouched
+                out->kind = PEEP_OTHER;
+                strcpy(out->text , line);
+                return;
+            }
+            char* operand = out->operand[out->operand_count++];
+            strncpy(operand , rest , length);
+            operand[length] = '\0';
+            peepTrim(operand);
+            if(*c == '\0') break;
+            rest = c + 1;
+            length = 0;
+            continue;
+        }
+        length++;
+    }
+}
+
+static void peepRender(PeepLine* line , char* out){
+    if(line->kind == PEEP_OTHER){
+        strcpy(out , line->text);
+        return;
+    }
+    if(line->kind == PEEP_LABEL){
+        sprintf(out , "%s:" , line->text);
+        return;
+    }
+
+    if(line->operand_count == 0) sprintf(out , "    %s" , line->mnemonic);
+    else if(line->operand_count == 1) sprintf(out , "    %-7s %s" , line->mnemonic , line->operand[0]);
+    else sprintf(out , "    %-7s %s, %s" , line->mnemonic , line->operand[0] , line->operand[1]);
+
+    if(line->comment[0] != '\0'){
+        strcat(out , "    ");
+        strncat(out , line->comment , 255 - strlen(out));
+    }
+}
+
+// ------------------------------------------------------- operand helpers ---
+
+static bool peepIsMnemonic(PeepLine* line , const char* mnemonic){
+    return line->kind == PEEP_INSTRUCTION && strcmp(line->mnemonic , mnemonic) == 0;
+}
+
+// family of an operand that is exactly a register (-1 otherwise)
+static int peepRegisterFamily(const char* operand){
+    for(int f=0 ; f<PEEP_FAMILIES ; f++){
+        for(int k=0 ; k<4 ; k++){
+            if(strcmp(operand , peepFamilies[f][k]) == 0) return f;
+        }
+    }
+    return -1;
+}
+
+static bool peepIs64BitRegister(const char* operand){
+    int family = peepRegisterFamily(operand);
+    return family != -1 && strcmp(operand , peepFamilies[family][0]) == 0;
+}
+
+static bool peepIsMemory(const char* operand){
+    return strchr(operand , '(') != NULL;
+}
+
+// true if the operand names a register of the family (alone or inside an address)
+static bool peepMentions(const char* operand , int family){
+    for(int k=0 ; k<4 ; k++){
+        const char* name = peepFamilies[family][k];
+        int length = strlen(name);
+        for(const char* found=strstr(operand , name) ; found ; found=strstr(found + 1 , name)){
+            if(!isalnum((unsigned char)found[length])) return true;
+        }
+    }
+    return false;
+}
+
+// value of an immediate operand "$n" (false if the operand is none or too large for 32 bits)
+static bool peepImmediate(const char* operand , long long* value){
+    if(operand[0] != '$') return false;
+    char* end;
+    *value = strtoll(operand + 1 , &end , 10);
+    return *end == '\0' && operand[1] != '\0' && *value >= INT32_MIN && *value <= INT32_MAX;
+}
+
+// next instruction or label after position (comment lines skipped, -1 at the end)
+static int peepNext(int position){
+    for(int i=position+1 ; i<peep_count ; i++){
+        if(peepLines[i].kind == PEEP_INSTRUCTION || peepLines[i].kind == PEEP_LABEL) return i;
+    }
+    return -1;
+}
+
+// ------------------------------------------------ instruction semantics ---
+
+static bool peepIsConditionalJump(PeepLine* line){
+    return line->kind == PEEP_INSTRUCTION && line->mnemonic[0] == 'j' && strcmp(line->mnemonic , "jmp") != 0;
+}
+
+static bool peepReadsFlags(PeepLine* line){
+    if(peepIsConditionalJump(line)) return true;
+    if(strncmp(line->mnemonic , "set" , 3) == 0 || strncmp(line->mnemonic , "cmov" , 4) == 0) return true;
+    return strcmp(line->mnemonic , "adcq") == 0 || strcmp(line->mnemonic , "sbbq") == 0;
+}
+
+static bool peepSetsFlags(PeepLine* line){
+    static const char* setters[] = {"cmpq", "testq", "addq", "subq", "andq", "orq", "xorq", "xorl",
+                                    "imulq", "idivq", "salq", "sarq", "shlq", "shrq", "incq", "decq", "negq",
+                                    "btcq", "andb", "orb", "ucomisd"};
+    for(int i=0 ; i<(int)(sizeof(setters)/sizeof(setters[0])) ; i++){
+        if(strcmp(line->mnemonic , setters[i]) == 0) return true;
+    }
+    return false;
+}
+
+// true if the flags after position are never read before they are set again
+static bool peepFlagsDeadAfter(int position){
+    for(int i=peepNext(position) ; i != -1 ; i=peepNext(i)){
+        PeepLine* line = &peepLines[i];
+        if(line->kind == PEEP_LABEL) continue;     // falls into the label
+        if(peepReadsFlags(line)) return false;
+        if(peepSetsFlags(line)) return true;
+        if(strcmp(line->mnemonic , "ret") == 0 || strcmp(line->mnemonic , "leave") == 0) return true;
+        if(strcmp(line->mnemonic , "jmp") == 0) return false;
+    }
+    return true;
+}
+
+// does the instruction write the whole register without reading it first?
+static bool peepOverwrites(PeepLine* line , int family){
+    if(line->operand_count != 2 || peepRegisterFamily(line->operand[1]) != family) return false;
+    if(!peepIs64BitRegister(line->operand[1]) && strcmp(line->operand[1] , peepFamilies[family][1]) != 0) return false;
+    if(peepMentions(line->operand[0] , family)) return strcmp(line->mnemonic , "xorl") == 0 && strcmp(line->operand[0] , line->operand[1]) == 0;
+    return strcmp(line->mnemonic , "movq") == 0 || strcmp(line->mnemonic , "leaq") == 0 || strcmp(line->mnemonic , "movabsq") == 0 ||
+           strcmp(line->mnemonic , "movzbq") == 0 || strcmp(line->mnemonic , "movzbl") == 0 ||
+           strcmp(line->mnemonic , "movslq") == 0 || strcmp(line->mnemonic , "movl") == 0 || strcmp(line->mnemonic , "xorl") == 0;
+}
+
+// "imulq %r": %rdx:%rax = %rax * %r
+static bool peepIsWideMultiply(PeepLine* line){
+    return strcmp(line->mnemonic , "imulq") == 0 && line->operand_count == 1;
+}
+
+// "rep stosq" / "rep movsq" (and without rep): %rcx count, %rdi and %rsi pointers, %rax fill value
+static bool peepIsString(PeepLine* line){
+    if(strcmp(line->mnemonic , "rep") == 0) return true;
+    return line->operand_count == 0 && (strncmp(line->mnemonic , "stos" , 4) == 0 || strncmp(line->mnemonic , "movs" , 4) == 0);
+}
+
+static bool peepReads(PeepLine* line , int family){
+    if(peepIsString(line)) return family == PEEP_RAX || family == PEEP_RCX || family == PEEP_RSI || family == PEEP_RDI;
+    if(strcmp(line->mnemonic , "cqto") == 0) return family == PEEP_RAX;
+    if(strcmp(line->mnemonic , "idivq") == 0) return family == PEEP_RAX || family == PEEP_RDX || peepMentions(line->operand[0] , family);
+    if(peepIsWideMultiply(line)) return family == PEEP_RAX || peepMentions(line->operand[0] , family);
+    if(strcmp(line->mnemonic , "ret") == 0) return family == PEEP_RAX;
+    if(peepOverwrites(line , family)) return false;
+    for(int k=0 ; k<line->operand_count ; k++){
+        if(peepMentions(line->operand[k] , family)) return true;
+    }
+    return false;
+}
+
+static bool peepWrites(PeepLine* line , int family){
+    if(peepIsString(line)) return family == PEEP_RCX || family == PEEP_RSI || family == PEEP_RDI;
+    if(strcmp(line->mnemonic , "cqto") == 0) return family == PEEP_RDX;
+    if(strcmp(line->mnemonic , "idivq") == 0 || peepIsWideMultiply(line)) return family == PEEP_RAX || family == PEEP_RDX;
+    return peepOverwrites(line , family);
+}
+
+// true if the value of the register after position is never read
+// (the scratch registers %rax %rcx %rdx never carry a value across a jump)
+static bool peepRegisterDeadAfter(int position , int family){
+    bool scratch = (family == PEEP_RAX || family == PEEP_RCX || family == PEEP_RDX);
+
+    for(int i=peepNext(position) ; i != -1 ; i=peepNext(i)){
+        PeepLine* line = &peepLines[i];
+        if(line->kind == PEEP_LABEL) continue;
+        if(peepReads(line , family)) return false;
+        if(peepWrites(line , family)) return true;
+        if(strcmp(line->mnemonic , "jmp") == 0) return scratch;
+        if(peepIsConditionalJump(line) && !scratch) return false;
+    }
+    return true;
+}
+
+static void peepDelete(int position){
+    peepLines[position].kind = PEEP_DELETED;
+}
+
+// ------------------------------------------------------------------ rules ---
+
+// movq R, M ; movq M, D  ->  movq R, M ; movq R, D (or nothing if D is R)
+static bool peepStoreLoadForwarding(int i){
+    PeepLine* store = &peepLines[i];
+    if(!peepIsMnemonic(store , "movq") || !peepIsMemory(store->operand[1])) return false;
+
+    long long value;
+    bool source = peepIs64BitRegister(store->operand[0]) || peepImmediate(store->operand[0] , &value);
+    if(!source) return false;
+
+    int j = peepNext(i);
+    if(j == -1) return false;
+    PeepLine* load = &peepLines[j];
+    if(!peepIsMnemonic(load , "movq") || strcmp(load->operand[0] , store->operand[1]) != 0) return false;
+    if(!peepIs64BitRegister(load->operand[1])) return false;
+
+    if(strcmp(load->operand[1] , store->operand[0]) == 0){
+        peepDelete(j);
+    } else{
+        strcpy(load->operand[0] , store->operand[0]);
+    }
+    peep_store_load_forwarded++;
+    return true;
+}
+
+// movq X, X / movq A, B ; movq B, A / a move to a scratch register nobody reads
+static bool peepRedundantMove(int i){
+    PeepLine* move = &peepLines[i];
+    if(!peepIsMnemonic(move , "movq") || move->operand_count != 2) return false;
+
+    if(strcmp(move->operand[0] , move->operand[1]) == 0){
+        peepDelete(i);
+        peep_moves_removed++;
+        return true;
+    }
+
+    // the move back is redundant unless the first move changed a register of the address
+    int j = peepNext(i);
+    int target = peepRegisterFamily(move->operand[1]);
+    if(j != -1 && peepIsMnemonic(&peepLines[j] , "movq") && (target == -1 || !peepMentions(move->operand[0] , target)) &&
+       strcmp(peepLines[j].operand[0] , move->operand[1]) == 0 && strcmp(peepLines[j].operand[1] , move->operand[0]) == 0){
+        peepDelete(j);
+        peep_moves_removed++;
+        return true;
+    }
+
+    int family = peepRegisterFamily(move->operand[1]);
+    if((family == PEEP_RAX || family == PEEP_RCX || family == PEEP_RDX) && peepIs64BitRegister(move->operand[1]) &&
+       peepRegisterDeadAfter(i , family)){
+        peepDelete(i);
+        peep_moves_removed++;
+        return true;
+    }
+
+    return false;
+}
+
+static int peepPowerOfTwo(long long value){
+    if(value < 2 || (value & (value - 1)) != 0) return -1;
+    int exponent = 0;
+    while(value > 1){
+        value >>= 1;
+        exponent++;
+    }
+    return exponent;
+}
+
+static bool peepStrengthReduction(int i){
+    PeepLine* line = &peepLines[i];
+    long long value;
+    if(line->kind != PEEP_INSTRUCTION || line->operand_count != 2) return false;
+
+    // movq $0, %r  ->  xorl %e, %e
+    if(strcmp(line->mnemonic , "movq") == 0 && peepImmediate(line->operand[0] , &value) && value == 0 &&
+       peepIs64BitRegister(line->operand[1]) && peepFlagsDeadAfter(i)){
+        int family = peepRegisterFamily(line->operand[1]);
+        strcpy(line->mnemonic , "xorl");
+        strcpy(line->operand[0] , peepFamilies[family][1]);
+        strcpy(line->operand[1] , peepFamilies[family][1]);
+        peep_strength_reduced++;
+        return true;
+    }
+
+    // movq $c, %rcx ; imulq %rcx, %r  ->  imulq $c, %r
+    int j = peepNext(i);
+    if(strcmp(line->mnemonic , "movq") == 0 && peepImmediate(line->operand[0] , &value) &&
+       strcmp(line->operand[1] , "%rcx") == 0 && j != -1 && peepIsMnemonic(&peepLines[j] , "imulq") &&
+       strcmp(peepLines[j].operand[0] , "%rcx") == 0 && strcmp(peepLines[j].operand[1] , "%rcx") != 0 &&
+       peepRegisterDeadAfter(j , PEEP_RCX)){
+        strcpy(peepLines[j].operand[0] , line->operand[0]);
+        peepDelete(i);
+        peep_strength_reduced++;
+        return true;
+    }
+
+    if(!peepImmediate(line->operand[0] , &value) || !peepFlagsDeadAfter(i)) return false;
+
+    // imulq $2^k, %r  ->  shlq $k, %r
+    int exponent = peepPowerOfTwo(value);
+    if(strcmp(line->mnemonic , "imulq") == 0 && exponent > 0 && peepIs64BitRegister(line->operand[1])){
+        strcpy(line->mnemonic , "shlq");
+        sprintf(line->operand[0] , "$%d" , exponent);
+        peep_strength_reduced++;
+        return true;
+    }
+
+    // x + 0, x - 0, x * 1
+    if(((strcmp(line->mnemonic , "addq") == 0 || strcmp(line->mnemonic , "subq") == 0) && value == 0) ||
+       (strcmp(line->mnemonic , "imulq") == 0 && value == 1)){
+        peepDelete(i);
+        peep_strength_reduced++;
+        return true;
+    }
+
+    return false;
+}
+
+// jmp L / jcc L directly before L:
+static bool peepJumpToNext(int i){
+    PeepLine* jump = &peepLines[i];
+    if(jump->kind != PEEP_INSTRUCTION || jump->mnemonic[0] != 'j' || jump->operand_count != 1) return false;
+
+    for(int j=peepNext(i) ; j != -1 && peepLines[j].kind == PEEP_LABEL ; j=peepNext(j)){
+        if(strcmp(peepLines[j].text , jump->operand[0]) == 0){
+            peepDelete(i);
+            peep_jumps_removed++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ------------------------------------------------------------------ driver ---
+
+void optimizeRealAssembly(){
+    peep_store_load_forwarded = 0;
+    peep_moves_removed = 0;
+    peep_strength_reduced = 0;
+    peep_jumps_removed = 0;
+    peep_lines_before = real_asm_count;
+    peep_lines_after = real_asm_count;
+
+    if(strcmp(opt_pipeline_name , "-O0") == 0 || real_asm_count == 0) return;
+
+    peepLines = (PeepLine*)malloc(real_asm_count * sizeof(PeepLine));
+    if(peepLines == NULL){
+        printf("06_04 || Peephole optimization error [06_04.01] -> Memory allocation failed for peephole optimization\n");
+        exit(6);
+    }
+    peep_count = real_asm_count;
+    for(int i=0 ; i<peep_count ; i++) peepParse(getRealAsmLine(i) , &peepLines[i]);
+
+    // apply the rules until none fires
+    bool changed = true;
+    while(changed){
+        changed = false;
+        for(int i=0 ; i<peep_count ; i++){
+            if(peepLines[i].kind != PEEP_INSTRUCTION) continue;
+            if(peepStoreLoadForwarding(i) || peepRedundantMove(i) || peepStrengthReduction(i) || peepJumpToNext(i)){
+                changed = true;
+            }
+        }
+    }
+
+    // write the remaining lines back
+    char line[256];
+    clearRealAsm();
+    for(int i=0 ; i<peep_count ; i++){
+        if(peepLines[i].kind == PEEP_DELETED) continue;
+        peepRender(&peepLines[i] , line);
+        addRealAsmInstruction(line);
+    }
+    peep_lines_after = real_asm_count;
+
+    free(peepLines);
+    peepLines = NULL;
+}
+
+// rules fired by the last run (terminal)
+void printPeepholeStats(){
+    int fired = peep_store_load_forwarded + peep_moves_removed + peep_strength_reduced + peep_jumps_removed;
+    if(strcmp(opt_pipeline_name , "-O0") == 0) return;
+
+    printf("   Peephole: %d rules fired, %d -> %d lines (store-load forwarding %d, redundant moves %d, strength reduction %d, jumps to next %d)\n" ,
+           fired , peep_lines_before , peep_lines_after , peep_store_load_forwarded , peep_moves_removed ,
+           peep_strength_reduced , peep_jumps_removed);
+}
@@ -0,0 +1,1073 @@
+/**
+ * 06_05_elfWriter.c - Direct ELF64 Executable Emission
+ *
+ * Encodes the real x86-64 assembly lines (after the peephole
+ * optimizer) into machine code and writes a static ELF64 executable, so no
+ * assembler or linker is needed. The text of the assembly stays in the
+ * report as before.
+ *
+ * Features:
+ * - Encoder for the instructions the backend emits: integer moves and ALU
+ *   operations, shifts, multiply/divide, setcc/jcc/jmp/call, the SSE2 double
+ *   instructions and the directives of the data sections (.quad, .long,
+ *   .byte, .zero, .align)
+ * - Every jump and call uses a 32-bit displacement, so one pass and a list
+ *   of fixups (resolved once the sections are laid out) are enough;
+ *   memory displacements use 8 bits when they fit
+ * - Minimal _start: calls main and exits through the exit system call
+ * - One PT_LOAD segment per section (.text R+X, .rodata R, .data/.bss R+W)
+ *   at 0x400000, section headers and a symbol table (_start, main) for objdump/gdb
+ * - "--elf=<file>" on the command line writes the executable
+ *
+ * Example:
+ *   movq    -8(%rbp), %rax          48 8b 45 f8
+ *   addq    $1, %rax          ==>   48 83 c0 01
+ *   jge     L3                      0f 8d <rel32>
+ *
+ * Author: Ridham Khurana
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "database.h"
+#include <sys/stat.h>
+#include <errno.h>
+
+#define ELF_BASE_ADDRESS 0x400000ULL
+#define ELF_PAGE 0x1000ULL
+#define ELF_SECTIONS 4           // .text .rodata .data .bss
+#define ELF_SECTION_BSS 3
+
+typedef enum {
+    ELF_OPERAND_REGISTER,
+    ELF_OPERAND_XMM,
+    ELF_OPERAND_IMMEDIATE,
+    ELF_OPERAND_MEMORY,
+    ELF_OPERAND_LABEL
+} ElfOperandKind;
+
+typedef struct {
+    ElfOperandKind kind;
+    int reg;                    // register number 0-15 (register, xmm)
+    int size;                   // bytes of a register (1, 4, 8; 16 for %xmm, 32 for %ymm)
+    long long value;            // immediate, or displacement of a memory operand
+    int base;                   // memory: base register (-1 = none, ELF_RIP = %rip)
+    int index;                  // memory: index register (-1 = none)
+    int scale;                  // memory: 1, 2, 4 or 8
+    char label[MAX_NAME];       // label of a jump, or symbolic displacement of a memory operand
+} ElfOperand;
+
+#define ELF_RIP 16
+
+typedef struct {
+    const char* name;
+    unsigned char* bytes;
+    int size;                   // bytes (for .bss only counted, never stored)
+    int capacity;
+    unsigned long long address; // virtual address after the layout
+    unsigned long long offset;  // file offset after the layout
+} ElfSection;
+
+typedef struct {
+    char name[MAX_NAME];
+    int section;
+    int offset;
+} ElfSymbol;
+
+typedef struct {
+    int section;
+    int offset;                 // position of the 32-bit field
+    int end;                    // end of the instruction (pc-relative fixups)
+    bool relative;              // pc-relative (jumps, %rip) or absolute address
+    long long addend;
+    char label[MAX_NAME];
+} ElfFixup;
+
+// statistics of the last run
+int elf_code_bytes = 0;
+int elf_data_bytes = 0;
+int elf_file_bytes = 0;
+
+static ElfSection elfSections[ELF_SECTIONS] = {
+    {".text", NULL, 0, 0, 0, 0}, {".rodata", NULL, 0, 0, 0, 0},
+    {".data", NULL, 0, 0, 0, 0}, {".bss", NULL, 0, 0, 0, 0}
+};
+static int elf_current = 0;
+
+static ElfSymbol* elfSymbols = NULL;
+static int elf_symbol_count = 0;
+static int elf_symbol_capacity = 0;
+
+static ElfFixup* elfFixups = NULL;
+static int elf_fixup_count = 0;
+static int elf_fixup_capacity = 0;
+static int elf_pending_fixups = 0;      // fixups of the current instruction (their end is set at its end)
+
+static const char* elf_line = "";       // line being encoded, for the error messages
+
+static const char* elfRegisters64[16] = {"%rax", "%rcx", "%rdx", "%rbx", "%rsp", "%rbp", "%rsi", "%rdi",
+                                         "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15"};
+static const char* elfRegisters32[16] = {"%eax", "%ecx", "%edx", "%ebx", "%esp", "%ebp", "%esi", "%edi",
+                                         "%r8d", "%r9d", "%r10d", "%r11d", "%r12d", "%r13d", "%r14d", "%r15d"};
+static const char* elfRegisters8[16] = {"%al", "%cl", "%dl", "%bl", "%spl", "%bpl", "%sil", "%dil",
+                                        "%r8b", "%r9b", "%r10b", "%r11b", "%r12b", "%r13b", "%r14b", "%r15b"};
+
+// condition codes of jcc/setcc
+static const char* elfConditions[][2] = {
+    {"o", "0"}, {"no", "1"}, {"b", "2"}, {"c", "2"}, {"nae", "2"}, {"ae", "3"}, {"nb", "3"}, {"nc", "3"},
+    {"e", "4"}, {"z", "4"}, {"ne", "5"}, {"nz", "5"}, {"be", "6"}, {"na", "6"}, {"a", "7"}, {"nbe", "7"},
+    {"s", "8"}, {"ns", "9"}, {"p", "10"}, {"pe", "10"}, {"np", "11"}, {"po", "11"},
+    {"l", "12"}, {"nge", "12"}, {"ge", "13"}, {"nl", "13"}, {"le", "14"}, {"ng", "14"}, {"g", "15"}, {"nle", "15"}
+};
+
+// ---------------------------------------------------------------- buffers ---
+
+static void* elfGrow(void* memory , int* capacity , int needed , size_t size){
+    if(needed <= *capacity) return memory;
+    int grown = *capacity ? *capacity : 256;
+    while(grown < needed) grown *= 2;
+    void* bigger = realloc(memory , grown * size);
+    if(bigger == NULL){
+        printf("06_05 || ELF emission error [06_05.01] -> Memory allocation failed for ELF emission\n");
+        exit(6);
+    }
+    *capacity = grown;
+    return bigger;
+}
+
+static void elfError(const char* message){
+    printf("06_05 || ELF emission error [06_05.02] -> %s: %s\n" , message , elf_line);
+    exit(6);
+}
+
+static void elfByte(int byte){
+    ElfSection* section = &elfSections[elf_current];
+    if(elf_current == ELF_SECTION_BSS){
+        if(byte != 0) elfError("Data in .bss must be zero");
+        section->size++;
+        return;
+    }
+    section->bytes = (unsigned char*)elfGrow(section->bytes , &section->capacity , section->size + 1 , 1);
+    section->bytes[section->size++] = (unsigned char)byte;
+}
+
+static void elfValue(unsigned long long value , int bytes){
+    for(int i=0 ; i<bytes ; i++) elfByte((int)((value >> (8 * i)) & 0xff));
+}
+
+// 32-bit field to be filled in once the label has an address
+static void elfFixup(const char* label , long long addend , bool relative){
+    elfFixups = (ElfFixup*)elfGrow(elfFixups , &elf_fixup_capacity , elf_fixup_count + 1 , sizeof(ElfFixup));
+    ElfFixup* fixup = &elfFixups[elf_fixup_count++];
+    fixup->section = elf_current;
+    fixup->offset = elfSections[elf_current].size;
+    fixup->end = fixup->offset + 4;
+    fixup->relative = relative;
+    fixup->addend = addend;
+    strcpy(fixup->label , label);
+    elf_pending_fixups++;
+    elfValue(0 , 4);
+}
+
+static void elfDefineSymbol(const char* name){
+    for(int i=0 ; i<elf_symbol_count ; i++){
+        if(strcmp(elfSymbols[i].name , name) == 0) elfError("Label defined twice");
+    }
+    elfSymbols = (ElfSymbol*)elfGrow(elfSymbols , &elf_symbol_capacity , elf_symbol_count + 1 , sizeof(ElfSymbol));
+    ElfSymbol* symbol = &elfSymbols[elf_symbol_count++];
+    strncpy(symbol->name , name , MAX_NAME - 1);
+    symbol->name[MAX_NAME - 1] = '\0';
+    symbol->section = elf_current;
+    symbol->offset = elfSections[elf_current].size;
+}
+
+// ---------------------------------------------------------------- parsing ---
+
+static void elfTrim(char* str){
+    int end = strlen(str);
+    while(end > 0 && isspace((unsigned char)str[end-1])) str[--end] = '\0';
+    int start = 0;
+    while(str[start] && isspace((unsigned char)str[start])) start++;
+    if(start > 0) memmove(str , str + start , end - start + 1);
+}
+
+static int elfRegisterNumber(const char* name , int* size){
+    for(int r=0 ; r<16 ; r++){
+        if(strcmp(name , elfRegisters64[r]) == 0){ *size = 8; return r; }
+        if(strcmp(name , elfRegisters32[r]) == 0){ *size = 4; return r; }
+        if(strcmp(name , elfRegisters8[r]) == 0){ *size = 1; return r; }
+    }
+    return -1;
+}
+
+static long long elfNumber(const char* text){
+    char* end;
+    errno = 0;
+    long long value = strtoll(text , &end , 0);
+    if(*text == '\0' || *end != '\0' || errno == ERANGE){
+        // values above INT64_MAX (a .quad written in hex; strtoll clamps them)
+        value = (long long)strtoull(text , &end , 0);
+        if(*text == '\0' || *end != '\0') elfError("Invalid number");
+    }
+    return value;
+}
+
+static void elfParseOperand(char* text , ElfOperand* operand){
+    memset(operand , 0 , sizeof(ElfOperand));
+    operand->base = -1;
+    operand->index = -1;
+    operand->scale = 1;
+    elfTrim(text);
+
+    if(text[0] == '$'){
+        operand->kind = ELF_OPERAND_IMMEDIATE;
+        operand->value = elfNumber(text + 1);
+        return;
+    }
+    if(strncmp(text , "%xmm" , 4) == 0 || strncmp(text , "%ymm" , 4) == 0){
+        operand->kind = ELF_OPERAND_XMM;
+        operand->size = (text[1] == 'y') ? 32 : 16;
+        operand->reg = atoi(text + 4);
+        if(operand->reg < 0 || operand->reg > 15) elfError("Unknown register");
+        return;
+    }
+    if(text[0] == '%'){
+        operand->kind = ELF_OPERAND_REGISTER;
+        operand->reg = elfRegisterNumber(text , &operand->size);
+        if(operand->reg == -1) elfError("Unknown register");
+        return;
+    }
+
+    char* open = strchr(text , '(');
+    if(open == NULL){
+        operand->kind = ELF_OPERAND_LABEL;
+        strcpy(operand->label , text);
+        return;
+    }
+
+    // memory: [label][+-disp](base[,index[,scale]])
+    operand->kind = ELF_OPERAND_MEMORY;
+    *open = '\0';
+    char* displacement = text;
+    if(displacement[0] != '\0'){
+        if(isdigit((unsigned char)displacement[0]) || displacement[0] == '-' || displacement[0] == '+'){
+            operand->value = elfNumber(displacement);
+        } else{
+            char* sign = strpbrk(displacement , "+-");
+            if(sign != NULL){
+                operand->value = elfNumber(sign);
+                *sign = '\0';
+            }
+            strcpy(operand->label , displacement);
+        }
+    }
+
+    char* inside = open + 1;
+    char* close = strchr(inside , ')');
+    if(close == NULL) elfError("Missing ) in memory operand");
+    *close = '\0';
+
+    char* parts[3] = {inside , NULL , NULL};
+    int count = 1;
+    for(char* c=inside ; *c && count < 3 ; c++){
+        if(*c == ','){
+            *c = '\0';
+            parts[count++] = c + 1;
+        }
+    }
+    int size;
+    for(int i=0 ; i<count ; i++) elfTrim(parts[i]);
+    if(parts[0][0] != '\0'){
+        if(strcmp(parts[0] , "%rip") == 0) operand->base = ELF_RIP;
+        else if((operand->base = elfRegisterNumber(parts[0] , &size)) == -1 || size != 8) elfError("Invalid base register");
+    }
+    if(count > 1 && parts[1][0] != '\0'){
+        if((operand->index = elfRegisterNumber(parts[1] , &size)) == -1 || size != 8 || operand->index == 4) elfError("Invalid index register");
+    }
+    if(count > 2) operand->scale = atoi(parts[2]);
+    if(operand->scale != 1 && operand->scale != 2 && operand->scale != 4 && operand->scale != 8) elfError("Invalid scale");
+}
+
+// --------------------------------------------------------------- encoding ---
+
+static bool elfIsRegister(ElfOperand* operand , int size){
+    return operand->kind == ELF_OPERAND_REGISTER && operand->size == size;
+}
+
+static bool elfIsVector(ElfOperand* operand , int size){
+    return operand->kind == ELF_OPERAND_XMM && operand->size == size;
+}
+
+static bool elfIsRegisterOrMemory(ElfOperand* operand , int size){
+    return elfIsRegister(operand , size) || operand->kind == ELF_OPERAND_MEMORY;
+}
+
+static bool elfFits8(long long value){
+    return value >= -128 && value <= 127;
+}
+
+static bool elfFits32(long long value){
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+static void elfModRM(int reg , ElfOperand* rm);
+
+// [prefix] [REX] opcode ModRM [SIB] [disp]: reg is the register of the reg field, rm a register or memory
+// operand; byte_registers forces a REX prefix for %spl %bpl %sil %dil
+static void elfEncode(int prefix , bool wide , const unsigned char* opcode , int opcode_length , int reg , ElfOperand* rm , bool byte_registers){
+    int rex = (wide ? 8 : 0) | ((reg & 8) ? 4 : 0);
+    bool memory = (rm->kind == ELF_OPERAND_MEMORY);
+    if(memory){
+        if(rm->index != -1 && (rm->index & 8)) rex |= 2;
+        if(rm->base != -1 && rm->base != ELF_RIP && (rm->base & 8)) rex |= 1;
+    } else if(rm->reg & 8){
+        rex |= 1;
+    }
+    bool force = byte_registers && ((!memory && rm->reg >= 4 && rm->reg <= 7) || (reg >= 4 && reg <= 7));
+
+    if(prefix) elfByte(prefix);
+    if(rex || force) elfByte(0x40 | rex);
+    for(int i=0 ; i<opcode_length ; i++) elfByte(opcode[i]);
+    elfModRM(reg , rm);
+}
+
+// ModRM [SIB] [disp] of the reg field and a register or memory operand
+static void elfModRM(int reg , ElfOperand* rm){
+    if(rm->kind != ELF_OPERAND_MEMORY){
+        elfByte(0xc0 | ((reg & 7) << 3) | (rm->reg & 7));
+        return;
+    }
+
+    if(rm->base == ELF_RIP){
+        elfByte(((reg & 7) << 3) | 5);
+        if(rm->label[0] == '\0') elfValue((unsigned long long)rm->value , 4);
+        else elfFixup(rm->label , rm->value , true);
+        return;
+    }
+
+    int scale_bits = (rm->scale == 8) ? 3 : (rm->scale == 4) ? 2 : (rm->scale == 2) ? 1 : 0;
+    if(rm->base == -1){
+        // absolute address (index optional): SIB with no base and a 32-bit displacement
+        elfByte(((reg & 7) << 3) | 4);
+        elfByte((scale_bits << 6) | (((rm->index == -1) ? 4 : rm->index) & 7) << 3 | 5);
+        if(rm->label[0] == '\0') elfValue((unsigned long long)rm->value , 4);
+        else elfFixup(rm->label , rm->value , false);
+        return;
+    }
+    if(rm->label[0] != '\0') elfError("Symbolic displacement needs %rip or no base register");
+
+    int mod = 2;
+    if(rm->value == 0 && (rm->base & 7) != 5) mod = 0;      // %rbp/%r13 always need a displacement
+    else if(elfFits8(rm->value)) mod = 1;
+    else if(!elfFits32(rm->value)) elfError("Displacement does not fit 32 bits");
+
+    bool sib = (rm->index != -1 || (rm->base & 7) == 4);  // %rsp/%r12 as base need a SIB byte
+    elfByte((mod << 6) | ((reg & 7) << 3) | (sib ? 4 : (rm->base & 7)));
+    if(sib) elfByte((scale_bits << 6) | ((((rm->index == -1) ? 4 : rm->index) & 7) << 3) | (rm->base & 7));
+    if(mod == 1) elfValue((unsigned long long)rm->value , 1);
+    if(mod == 2) elfValue((unsigned long long)rm->value , 4);
+}
+
+static void elfEncode1(int prefix , bool wide , int opcode , int reg , ElfOperand* rm){
+    unsigned char bytes[1] = {(unsigned char)opcode};
+    elfEncode(prefix , wide , bytes , 1 , reg , rm , false);
+}
+
+static void elfEncode2(int prefix , bool wide , int opcode , int reg , ElfOperand* rm){
+    unsigned char bytes[2] = {0x0f , (unsigned char)opcode};
+    elfEncode(prefix , wide , bytes , 2 , reg , rm , false);
+}
+
+// VEX prefix (always the 3-byte form) opcode ModRM [SIB] [disp]: map 1 = 0f, 2 = 0f38, 3 = 0f3a;
+// pp 0 = none, 1 = 66, 2 = f3, 3 = f2; vvvv is the extra source register (0 = none)
+static void elfVex(int map , int pp , bool wide , bool long256 , int opcode , int reg , int vvvv , ElfOperand* rm){
+    int x = 0 , b = 0;
+    if(rm->kind == ELF_OPERAND_MEMORY){
+        if(rm->index != -1) x = (rm->index >> 3) & 1;
+        if(rm->base != -1 && rm->base != ELF_RIP) b = (rm->base >> 3) & 1;
+    } else{
+        b = (rm->reg >> 3) & 1;
+    }
+    elfByte(0xc4);
+    elfByte(((((reg >> 3) & 1) ^ 1) << 7) | ((x ^ 1) << 6) | ((b ^ 1) << 5) | map);
+    elfByte((wide ? 0x80 : 0) | ((~vvvv & 15) << 3) | (long256 ? 4 : 0) | pp);
+    elfByte(opcode);
+    elfModRM(reg , rm);
+}
+
+static int elfConditionCode(const char* suffix){
+    for(int i=0 ; i<(int)(sizeof(elfConditions)/sizeof(elfConditions[0])) ; i++){
+        if(strcmp(suffix , elfConditions[i][0]) == 0) return atoi(elfConditions[i][1]);
+    }
+    return -1;
+}
+
+// addq/orq/andq/subq/xorq/cmpq and the 32/8-bit forms; extension is the /n of the immediate form
+static bool elfArithmetic(int extension , int size , ElfOperand* source , ElfOperand* target){
+    bool wide = (size == 8);
+    int base = extension * 8;               // 00 add, 08 or, 20 and, 28 sub, 30 xor, 38 cmp
+    int byte = (size == 1) ? 0 : 1;
+
+    if(source->kind == ELF_OPERAND_IMMEDIATE && elfIsRegisterOrMemory(target , size)){
+        if(size == 1){
+            elfEncode1(0 , false , 0x80 , extension , target);
+            elfValue((unsigned long long)source->value , 1);
+        } else if(elfFits8(source->value)){
+            elfEncode1(0 , wide , 0x83 , extension , target);
+            elfValue((unsigned long long)source->value , 1);
+        } else if(elfFits32(source->value)){
+            elfEncode1(0 , wide , 0x81 , extension , target);
+            elfValue((unsigned long long)source->value , 4);
+        } else{
+            return false;
+        }
+        return true;
+    }
+    if(elfIsRegister(source , size) && elfIsRegisterOrMemory(target , size)){
+        unsigned char opcode[1] = {(unsigned char)(base + byte)};
+        elfEncode(0 , wide , opcode , 1 , source->reg , target , size == 1);
+        return true;
+    }
+    if(source->kind == ELF_OPERAND_MEMORY && elfIsRegister(target , size)){
+        unsigned char opcode[1] = {(unsigned char)(base + 2 + byte)};
+        elfEncode(0 , wide , opcode , 1 , target->reg , source , size == 1);
+        return true;
+    }
+    return false;
+}
+
+// movq / movl / movb between registers, memory and immediates (and the xmm forms of movq)
+static bool elfMove(int size , ElfOperand* source , ElfOperand* target){
+    bool wide = (size == 8);
+
+    if(size == 8 && (source->kind == ELF_OPERAND_XMM || target->kind == ELF_OPERAND_XMM)){
+        if(source->kind == ELF_OPERAND_XMM && target->kind == ELF_OPERAND_XMM) elfEncode2(0xf3 , false , 0x7e , target->reg , source);
+        else if(target->kind == ELF_OPERAND_XMM && elfIsRegister(source , 8)) elfEncode2(0x66 , true , 0x6e , target->reg , source);
+        else if(source->kind == ELF_OPERAND_XMM && elfIsRegister(target , 8)) elfEncode2(0x66 , true , 0x7e , source->reg , target);
+        else if(target->kind == ELF_OPERAND_XMM && source->kind == ELF_OPERAND_MEMORY) elfEncode2(0xf3 , false , 0x7e , target->reg , source);
+        else if(source->kind == ELF_OPERAND_XMM && target->kind == ELF_OPERAND_MEMORY) elfEncode2(0x66 , false , 0xd6 , source->reg , target);
+        else return false;
+        return true;
+    }
+
+    if(source->kind == ELF_OPERAND_IMMEDIATE && elfIsRegisterOrMemory(target , size)){
+        if(size == 1){
+            elfEncode1(0 , false , 0xc6 , 0 , target);
+            elfValue((unsigned long long)source->value , 1);
+        } else if(size == 8 && !elfFits32(source->value)){
+            if(target->kind != ELF_OPERAND_REGISTER) return false;
+            if(target->reg & 8) elfByte(0x49);
+            else elfByte(0x48);
+            elfByte(0xb8 + (target->reg & 7));
+            elfValue((unsigned long long)source->value , 8);
+        } else if(size == 4 && target->kind == ELF_OPERAND_REGISTER){
+            if(target->reg & 8) elfByte(0x41);
+            elfByte(0xb8 + (target->reg & 7));
+            elfValue((unsigned long long)source->value , 4);
+        } else{
+            elfEncode1(0 , wide , 0xc7 , 0 , target);
+            elfValue((unsigned long long)source->value , 4);
+        }
+        return true;
+    }
+    int byte = (size == 1) ? 0 : 1;
+    if(elfIsRegister(source , size) && elfIsRegisterOrMemory(target , size)){
+        unsigned char opcode[1] = {(unsigned char)(0x88 + byte)};
+        elfEncode(0 , wide , opcode , 1 , source->reg , target , size == 1);
+        return true;
+    }
+    if(source->kind == ELF_OPERAND_MEMORY && elfIsRegister(target , size)){
+        unsigned char opcode[1] = {(unsigned char)(0x8a + byte)};
+        elfEncode(0 , wide , opcode , 1 , target->reg , source , size == 1);
+        return true;
+    }
+    return false;
+}
+
+// shlq/salq/shrq/sarq by an immediate or %cl
+static bool elfShift(int extension , ElfOperand* source , ElfOperand* target){
+    if(!elfIsRegisterOrMemory(target , 8)) return false;
+    if(source->kind == ELF_OPERAND_IMMEDIATE){
+        elfEncode1(0 , true , 0xc1 , extension , target);
+        elfValue((unsigned long long)source->value , 1);
+        return true;
+    }
+    if(elfIsRegister(source , 1) && source->reg == 1){
+        elfEncode1(0 , true , 0xd3 , extension , target);
+        return true;
+    }
+    return false;
+}
+
+// SSE2 scalar double instruction "op xmm/m64, xmm"
+static bool elfSse(int prefix , int opcode , bool wide , ElfOperand* source , ElfOperand* target){
+    if(!elfIsVector(target , 16)) return false;
+    if(!elfIsVector(source , 16) && source->kind != ELF_OPERAND_MEMORY && !(wide && elfIsRegister(source , 8))) return false;
+    elfEncode2(prefix , wide , opcode , target->reg , source);
+    return true;
+}
+
+// SSE2 packed move: load "op xmm/m128, xmm" or store "op xmm, m128"
+static bool elfSseMove(int prefix , int load , int store , ElfOperand* source , ElfOperand* target){
+    if(elfIsVector(target , 16)) return elfSse(prefix , load , false , source , target);
+    if(!elfIsVector(source , 16) || target->kind != ELF_OPERAND_MEMORY) return false;
+    elfEncode2(prefix , false , store , source->reg , target);
+    return true;
+}
+
+// AVX packed move (vmovdqu, vmovupd) of %xmm or %ymm: load or store
+static bool elfVexMove(int pp , int load , int store , ElfOperand* source , ElfOperand* target){
+    if(target->kind == ELF_OPERAND_XMM && (source->kind == ELF_OPERAND_XMM || source->kind == ELF_OPERAND_MEMORY)){
+        elfVex(1 , pp , false , target->size == 32 , load , target->reg , 0 , source);
+        return true;
+    }
+    if(source->kind != ELF_OPERAND_XMM || target->kind != ELF_OPERAND_MEMORY) return false;
+    elfVex(1 , pp , false , source->size == 32 , store , source->reg , 0 , target);
+    return true;
+}
+
+// AVX three-operand instruction "op src2, src1, dst" (src2 may be memory)
+static bool elfVex3(int map , int pp , int opcode , ElfOperand* operands){
+    ElfOperand* source2 = &operands[0];
+    ElfOperand* source1 = &operands[1];
+    ElfOperand* target = &operands[2];
+    if(target->kind != ELF_OPERAND_XMM || source1->kind != ELF_OPERAND_XMM || source1->size != target->size) return false;
+    if(source2->kind != ELF_OPERAND_XMM && source2->kind != ELF_OPERAND_MEMORY) return false;
+    elfVex(map , pp , false , target->size == 32 , opcode , target->reg , source1->reg , source2);
+    return true;
+}
+
+// packed SSE2 and AVX2 instructions of the loop vectorizer (06_01)
+static bool elfVectorInstruction(const char* mnemonic , ElfOperand* operands , int count){
+    ElfOperand* a = &operands[0];
+    ElfOperand* b = &operands[1];
+    ElfOperand* c = &operands[2];
+    // legacy SSE2 "op xmm/m128, xmm" (prefix 66) and AVX "vop src2, src1, dst" (pp 1 = 66) share the opcodes
+    static const char* packed[][2] = {
+        {"paddq", "d4"}, {"psubq", "fb"}, {"addpd", "58"}, {"subpd", "5c"}, {"mulpd", "59"}, {"divpd", "5e"},
+        {"pxor", "ef"}, {"punpcklqdq", "6c"}, {"unpckhpd", "15"}
+    };
+    static const char* scalar[][2] = {{"vaddsd", "58"}, {"vsubsd", "5c"}, {"vmulsd", "59"}, {"vdivsd", "5e"}};
+
+    if(count == 0 && strcmp(mnemonic , "vzeroupper") == 0){
+        elfValue(0x77f8c5 , 3);
+        return true;
+    }
+    if(count == 2){
+        if(strcmp(mnemonic , "movupd") == 0) return elfSseMove(0x66 , 0x10 , 0x11 , a , b);
+        if(strcmp(mnemonic , "movdqu") == 0) return elfSseMove(0xf3 , 0x6f , 0x7f , a , b);
+        if(strcmp(mnemonic , "vmovupd") == 0) return elfVexMove(1 , 0x10 , 0x11 , a , b);
+        if(strcmp(mnemonic , "vmovdqu") == 0) return elfVexMove(2 , 0x6f , 0x7f , a , b);
+        if((strcmp(mnemonic , "vpbroadcastq") == 0 || strcmp(mnemonic , "vbroadcastsd") == 0) && elfIsVector(b , 32) &&
+           (elfIsVector(a , 16) || a->kind == ELF_OPERAND_MEMORY)){
+            elfVex(2 , 1 , false , true , mnemonic[1] == 'p' ? 0x59 : 0x19 , b->reg , 0 , a);
+            return true;
+        }
+        for(int n=0 ; n<(int)(sizeof(packed)/sizeof(packed[0])) ; n++){
+            if(strcmp(mnemonic , packed[n][0]) == 0) return elfSse(0x66 , (int)strtol(packed[n][1] , NULL , 16) , false , a , b);
+        }
+        return false;
+    }
+    if(count != 3) return false;
+
+    if(mnemonic[0] == 'v'){
+        for(int n=0 ; n<(int)(sizeof(packed)/sizeof(packed[0])) ; n++){
+            if(strcmp(mnemonic + 1 , packed[n][0]) == 0) return elfVex3(1 , 1 , (int)strtol(packed[n][1] , NULL , 16) , operands);
+        }
+        for(int n=0 ; n<(int)(sizeof(scalar)/sizeof(scalar[0])) ; n++){
+            if(strcmp(mnemonic , scalar[n][0]) == 0 && elfIsVector(c , 16)) return elfVex3(1 , 3 , (int)strtol(scalar[n][1] , NULL , 16) , operands);
+        }
+    }
+    if(a->kind != ELF_OPERAND_IMMEDIATE) return false;
+
+    // "pshufd $imm, xmm/m128, xmm" and the AVX form
+    if((strcmp(mnemonic , "pshufd") == 0 || strcmp(mnemonic , "vpshufd") == 0) && c->kind == ELF_OPERAND_XMM &&
+       (b->kind == ELF_OPERAND_XMM || b->kind == ELF_OPERAND_MEMORY)){
+        if(mnemonic[0] == 'v') elfVex(1 , 1 , false , c->size == 32 , 0x70 , c->reg , 0 , b);
+        else if(!elfSse(0x66 , 0x70 , false , b , c)) return false;
+        elfValue((unsigned long long)a->value , 1);
+        return true;
+    }
+    // "vextracti128 $1, ymm, xmm/m128" (vextractf128 the same for doubles)
+    if((strcmp(mnemonic , "vextracti128") == 0 || strcmp(mnemonic , "vextractf128") == 0) && elfIsVector(b , 32) &&
+       (elfIsVector(c , 16) || c->kind == ELF_OPERAND_MEMORY)){
+        elfVex(3 , 1 , false , true , mnemonic[8] == 'i' ? 0x39 : 0x19 , b->reg , 0 , c);
+        elfValue((unsigned long long)a->value , 1);
+        return true;
+    }
+    return false;
+}
+
+// encode one instruction (false if the form is not known)
+static bool elfInstruction(const char* mnemonic , ElfOperand* operands , int count){
+    ElfOperand* a = &operands[0];   // source (AT&T order)
+    ElfOperand* b = &operands[1];   // target
+    static const char* arithmetic[] = {"add", "or", "", "", "and", "sub", "xor", "cmp"};
+
+    if(count == 0){
+        if(strcmp(mnemonic , "ret") == 0){ elfByte(0xc3); return true; }
+        if(strcmp(mnemonic , "leave") == 0){ elfByte(0xc9); return true; }
+        if(strcmp(mnemonic , "cqto") == 0 || strcmp(mnemonic , "cqo") == 0){ elfValue(0x9948 , 2); return true; }
+        if(strcmp(mnemonic , "syscall") == 0){ elfValue(0x050f , 2); return true; }
+        if(strcmp(mnemonic , "nop") == 0){ elfByte(0x90); return true; }
+        if(strcmp(mnemonic , "rep") == 0){ elfByte(0xf3); return true; }
+        if(strcmp(mnemonic , "stosq") == 0){ elfValue(0xab48 , 2); return true; }
+        if(strcmp(mnemonic , "movsq") == 0){ elfValue(0xa548 , 2); return true; }
+        if(strcmp(mnemonic , "stosb") == 0){ elfByte(0xaa); return true; }
+        if(strcmp(mnemonic , "movsb") == 0){ elfByte(0xa4); return true; }
+        return false;
+    }
+
+    if(count == 1){
+        // jumps and calls: always rel32
+        if(a->kind == ELF_OPERAND_LABEL){
+            if(strcmp(mnemonic , "jmp") == 0) elfByte(0xe9);
+            else if(strcmp(mnemonic , "call") == 0) elfByte(0xe8);
+            else if(mnemonic[0] == 'j' && elfConditionCode(mnemonic + 1) != -1){
+                elfByte(0x0f);
+                elfByte(0x80 + elfConditionCode(mnemonic + 1));
+            } else return false;
+            elfFixup(a->label , 0 , true);
+            return true;
+        }
+        if(strncmp(mnemonic , "set" , 3) == 0 && elfConditionCode(mnemonic + 3) != -1 && elfIsRegisterOrMemory(a , 1)){
+            unsigned char opcode[2] = {0x0f , (unsigned char)(0x90 + elfConditionCode(mnemonic + 3))};
+            elfEncode(0 , false , opcode , 2 , 0 , a , true);
+            return true;
+        }
+        if((strcmp(mnemonic , "pushq") == 0 || strcmp(mnemonic , "popq") == 0) && elfIsRegister(a , 8)){
+            if(a->reg & 8) elfByte(0x41);
+            elfByte((mnemonic[0] == 'p' && mnemonic[1] == 'u' ? 0x50 : 0x58) + (a->reg & 7));
+            return true;
+        }
+        if(elfIsRegisterOrMemory(a , 8)){
+            if(strcmp(mnemonic , "negq") == 0){ elfEncode1(0 , true , 0xf7 , 3 , a); return true; }
+            if(strcmp(mnemonic , "notq") == 0){ elfEncode1(0 , true , 0xf7 , 2 , a); return true; }
+            if(strcmp(mnemonic , "imulq") == 0){ elfEncode1(0 , true , 0xf7 , 5 , a); return true; }
+            if(strcmp(mnemonic , "idivq") == 0){ elfEncode1(0 , true , 0xf7 , 7 , a); return true; }
+            if(strcmp(mnemonic , "incq") == 0){ elfEncode1(0 , true , 0xff , 0 , a); return true; }
+            if(strcmp(mnemonic , "decq") == 0){ elfEncode1(0 , true , 0xff , 1 , a); return true; }
+        }
+        return false;
+    }
+
+    if(count != 2) return false;
+
+    // add/or/and/sub/xor/cmp with q, l and b suffixes
+    for(int n=0 ; n<8 ; n++){
+        int length = strlen(arithmetic[n]);
+        if(length == 0 || strncmp(mnemonic , arithmetic[n] , length) != 0 || mnemonic[length + 1] != '\0') continue;
+        char suffix = mnemonic[length];
+        int size = (suffix == 'q') ? 8 : (suffix == 'l') ? 4 : (suffix == 'b') ? 1 : 0;
+        if(size != 0) return elfArithmetic(n , size , a , b);
+    }
+
+    if(strcmp(mnemonic , "movq") == 0) return elfMove(8 , a , b);
+    if(strcmp(mnemonic , "movl") == 0) return elfMove(4 , a , b);
+    if(strcmp(mnemonic , "movb") == 0) return elfMove(1 , a , b);
+    if(strcmp(mnemonic , "movabsq") == 0 && a->kind == ELF_OPERAND_IMMEDIATE && elfIsRegister(b , 8)){
+        elfByte((b->reg & 8) ? 0x49 : 0x48);
+        elfByte(0xb8 + (b->reg & 7));
+        elfValue((unsigned long long)a->value , 8);
+        return true;
+    }
+    if(strcmp(mnemonic , "leaq") == 0 && a->kind == ELF_OPERAND_MEMORY && elfIsRegister(b , 8)){
+        elfEncode1(0 , true , 0x8d , b->reg , a);
+        return true;
+    }
+    if(strcmp(mnemonic , "testq") == 0 && elfIsRegister(a , 8) && elfIsRegisterOrMemory(b , 8)){
+        elfEncode1(0 , true , 0x85 , a->reg , b);
+        return true;
+    }
+    if(strcmp(mnemonic , "imulq") == 0 && elfIsRegister(b , 8)){
+        if(a->kind == ELF_OPERAND_IMMEDIATE){
+            // imulq $c, %r is imulq $c, %r, %r
+            elfEncode1(0 , true , elfFits8(a->value) ? 0x6b : 0x69 , b->reg , b);
+            elfValue((unsigned long long)a->value , elfFits8(a->value) ? 1 : 4);
+            return true;
+        }
+        if(elfIsRegisterOrMemory(a , 8)){
+            elfEncode2(0 , true , 0xaf , b->reg , a);
+            return true;
+        }
+    }
+    if(strcmp(mnemonic , "shlq") == 0 || strcmp(mnemonic , "salq") == 0) return elfShift(4 , a , b);
+    if(strcmp(mnemonic , "shrq") == 0) return elfShift(5 , a , b);
+    if(strcmp(mnemonic , "sarq") == 0) return elfShift(7 , a , b);
+    if(strcmp(mnemonic , "btcq") == 0 && a->kind == ELF_OPERAND_IMMEDIATE && elfIsRegisterOrMemory(b , 8)){
+        elfEncode2(0 , true , 0xba , 7 , b);
+        elfValue((unsigned long long)a->value , 1);
+        return true;
+    }
+    if((strcmp(mnemonic , "movzbq") == 0 || strcmp(mnemonic , "movzbl") == 0) && elfIsRegisterOrMemory(a , 1) && elfIsRegister(b , (mnemonic[5] == 'q') ? 8 : 4)){
+        unsigned char opcode[2] = {0x0f , 0xb6};
+        elfEncode(0 , mnemonic[5] == 'q' , opcode , 2 , b->reg , a , true);
+        return true;
+    }
+    if(strcmp(mnemonic , "movslq") == 0 && elfIsRegisterOrMemory(a , 4) && elfIsRegister(b , 8)){
+        elfEncode1(0 , true , 0x63 , b->reg , a);
+        return true;
+    }
+
+    // SSE2
+    if(strcmp(mnemonic , "movsd") == 0){
+        if(b->kind == ELF_OPERAND_XMM) return elfSse(0xf2 , 0x10 , false , a , b);
+        if(a->kind == ELF_OPERAND_XMM && b->kind == ELF_OPERAND_MEMORY){
+            elfEncode2(0xf2 , false , 0x11 , a->reg , b);
+            return true;
+        }
+        return false;
+    }
+    if(strcmp(mnemonic , "movapd") == 0) return elfSse(0x66 , 0x28 , false , a , b);
+    if(strcmp(mnemonic , "addsd") == 0) return elfSse(0xf2 , 0x58 , false , a , b);
+    if(strcmp(mnemonic , "mulsd") == 0) return elfSse(0xf2 , 0x59 , false , a , b);
+    if(strcmp(mnemonic , "subsd") == 0) return elfSse(0xf2 , 0x5c , false , a , b);
+    if(strcmp(mnemonic , "divsd") == 0) return elfSse(0xf2 , 0x5e , false , a , b);
+    if(strcmp(mnemonic , "ucomisd") == 0) return elfSse(0x66 , 0x2e , false , a , b);
+    if(strcmp(mnemonic , "xorpd") == 0) return elfSse(0x66 , 0x57 , false , a , b);
+    if(strcmp(mnemonic , "cvtsi2sdq") == 0 && elfIsRegisterOrMemory(a , 8)) return elfSse(0xf2 , 0x2a , true , a , b);
+    if(strcmp(mnemonic , "cvttsd2siq") == 0 && elfIsRegister(b , 8) && (a->kind == ELF_OPERAND_XMM || a->kind == ELF_OPERAND_MEMORY)){
+        elfEncode2(0xf2 , true , 0x2c , b->reg , a);
+        return true;
+    }
+
+    return false;
+}
+
+// directives of the data sections; false if the line is no directive this writer knows
+static bool elfDirective(char* body){
+    char name[32];
+    int length = 0;
+    while(body[length] && !isspace((unsigned char)body[length]) && length < 31){
+        name[length] = body[length];
+        length++;
+    }
+    name[length] = '\0';
+    char* rest = body + length;
+    elfTrim(rest);
+
+    if(strcmp(name , ".text") == 0){ elf_current = 0; return true; }
+    if(strcmp(name , ".data") == 0){ elf_current = 2; return true; }
+    if(strcmp(name , ".bss") == 0){ elf_current = 3; return true; }
+    if(strcmp(name , ".section") == 0){
+        for(int s=0 ; s<ELF_SECTIONS ; s++){
+            if(strncmp(rest , elfSections[s].name , strlen(elfSections[s].name)) == 0){
+                elf_current = s;
+                return true;
+            }
+        }
+        elfError("Unknown section");
+    }
+    if(strcmp(name , ".globl") == 0 || strcmp(name , ".type") == 0 || strcmp(name , ".size") == 0) return true;
+    if(strcmp(name , ".align") == 0 || strcmp(name , ".p2align") == 0){
+        long long alignment = elfNumber(rest);
+        if(name[1] == 'p') alignment = 1LL << alignment;
+        if(alignment <= 0 || (alignment & (alignment - 1)) != 0) elfError("Invalid alignment");
+        while(elfSections[elf_current].size % alignment != 0) elfByte(elf_current == 0 ? 0x90 : 0);
+        return true;
+    }
+    if(strcmp(name , ".zero") == 0 || strcmp(name , ".skip") == 0){
+        long long count = elfNumber(rest);
+        for(long long i=0 ; i<count ; i++) elfByte(0);
+        return true;
+    }
+
+    int size = (strcmp(name , ".quad") == 0) ? 8 : (strcmp(name , ".long") == 0) ? 4 : (strcmp(name , ".byte") == 0) ? 1 : 0;
+    if(size == 0) return false;
+    // comma separated values
+    char* value = strtok(rest , ",");
+    while(value != NULL){
+        elfTrim(value);
+        elfValue((unsigned long long)elfNumber(value) , size);
+        value = strtok(NULL , ",");
+    }
+    return true;
+}
+
+static void elfLine(const char* line){
+    char body[256];
+    strncpy(body , line , 255);
+    body[255] = '\0';
+    elf_line = line;
+
+    char* hash = strchr(body , '#');
+    if(hash != NULL) *hash = '\0';
+    elfTrim(body);
+    if(body[0] == '\0') return;
+
+    // label
+    int length = strlen(body);
+    if(body[length-1] == ':'){
+        body[length-1] = '\0';
+        elfDefineSymbol(body);
+        return;
+    }
+
+    if(body[0] == '.'){
+        if(!elfDirective(body)) elfError("Unknown directive");
+        return;
+    }
+
+    // "rep stosq" and other prefixes on the same line
+    if(strncmp(body , "rep " , 4) == 0){
+        elfByte(0xf3);
+        memmove(body , body + 4 , strlen(body + 4) + 1);
+        elfTrim(body);
+    }
+
+    char mnemonic[32];
+    int i = 0;
+    while(body[i] && !isspace((unsigned char)body[i]) && i < 31){
+        mnemonic[i] = body[i];
+        i++;
+    }
+    mnemonic[i] = '\0';
+
+    // operands, split at commas outside of parentheses
+    ElfOperand operands[3];
+    int count = 0;
+    char* rest = body + i;
+    elfTrim(rest);
+    if(rest[0] != '\0'){
+        int depth = 0;
+        char* start = rest;
+        for(char* c=rest ; ; c++){
+            if(*c == '(') depth++;
+            if(*c == ')') depth--;
+            if((*c == ',' && depth == 0) || *c == '\0'){
+                if(count == 3) elfError("Too many operands");
+                bool end = (*c == '\0');
+                *c = '\0';
+                elfParseOperand(start , &operands[count++]);
+                if(end) break;
+                start = c + 1;
+            }
+        }
+    }
+
+    elf_pending_fixups = 0;
+    if(!elfInstruction(mnemonic , operands , count) && !elfVectorInstruction(mnemonic , operands , count)){
+        elfError("Instruction cannot be encoded");
+    }
+
+    // pc-relative fixups count from the end of the instruction (after an immediate)
+    for(int f=elf_fixup_count-elf_pending_fixups ; f<elf_fixup_count ; f++){
+        elfFixups[f].end = elfSections[elf_current].size;
+    }
+}
+
+// ----------------------------------------------------------------- layout ---
+
+static unsigned long long elfAlign(unsigned long long value , unsigned long long alignment){
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static unsigned long long elfSymbolAddress(const char* name){
+    for(int i=0 ; i<elf_symbol_count ; i++){
+        if(strcmp(elfSymbols[i].name , name) == 0) return elfSections[elfSymbols[i].section].address + elfSymbols[i].offset;
+    }
+    printf("06_05 || ELF emission error [06_05.03] -> Undefined label (%s)\n" , name);
+    exit(6);
+}
+
+static void elfPut(unsigned char* out , unsigned long long value , int bytes){
+    for(int i=0 ; i<bytes ; i++) out[i] = (unsigned char)((value >> (8 * i)) & 0xff);
+}
+
+static void elfReset(){
+    for(int s=0 ; s<ELF_SECTIONS ; s++){
+        free(elfSections[s].bytes);
+        elfSections[s].bytes = NULL;
+        elfSections[s].size = 0;
+        elfSections[s].capacity = 0;
+    }
+    free(elfSymbols);
+    free(elfFixups);
+    elfSymbols = NULL;
+    elfFixups = NULL;
+    elf_symbol_count = elf_symbol_capacity = 0;
+    elf_fixup_count = elf_fixup_capacity = 0;
+    elf_current = 0;
+}
+
+// encode the real assembly and write it as a static x86-64 ELF executable
+void writeRealElfExecutable(const char* path){
+    elfReset();
+
+    // _start: main(), then exit(status) through the system call
+    static const char* start[] = {"_start:", "    call    main", "    movl    %eax, %edi", "    movl    $60, %eax", "    syscall"};
+    for(int i=0 ; i<(int)(sizeof(start)/sizeof(start[0])) ; i++) elfLine(start[i]);
+    for(int i=0 ; i<real_asm_count ; i++) elfLine(getRealAsmLine(i));
+    elf_line = "";
+
+    // layout: ELF header and program headers, then every section on its own page(s)
+    int segments = 0;
+    for(int s=0 ; s<ELF_SECTIONS ; s++){
+        if(s == 0 || elfSections[s].size > 0) segments++;
+    }
+    unsigned long long headers = 64 + 56 * segments;
+    unsigned long long offset = elfAlign(headers , 16);
+    for(int s=0 ; s<ELF_SECTIONS ; s++){
+        ElfSection* section = &elfSections[s];
+        if(s > 0){
+            if(section->size == 0) continue;
+            offset = elfAlign(offset , ELF_PAGE);
+        }
+        section->offset = offset;
+        section->address = ELF_BASE_ADDRESS + offset;
+        if(s != ELF_SECTION_BSS) offset += section->size;
+    }
+
+    // fixups
+    for(int f=0 ; f<elf_fixup_count ; f++){
+        ElfFixup* fixup = &elfFixups[f];
+        long long target = (long long)elfSymbolAddress(fixup->label) + fixup->addend;
+        if(fixup->relative) target -= (long long)(elfSections[fixup->section].address + fixup->end);
+        if(!elfFits32(target)){
+            printf("06_05 || ELF emission error [06_05.03] -> Label (%s) out of 32-bit range\n" , fixup->label);
+            exit(6);
+        }
+        elfPut(elfSections[fixup->section].bytes + fixup->offset , (unsigned long long)target , 4);
+    }
+
+    // symbol table of the named labels (_start, main, data objects; not the L<n> jump targets),
+    // then the string tables and the section headers after the contents
+    static const char names[] = "\0.text\0.rodata\0.data\0.bss\0.symtab\0.strtab\0.shstrtab\0";
+    static const int name_offsets[ELF_SECTIONS + 3] = {1, 7, 15, 21, 26, 34, 42};
+    int header_index[ELF_SECTIONS];
+    int section_count = 1;      // null section
+    for(int s=0 ; s<ELF_SECTIONS ; s++){
+        header_index[s] = (s == 0 || elfSections[s].size > 0) ? section_count++ : 0;
+    }
+    int symtab_index = section_count;
+    section_count += 3;         // .symtab .strtab .shstrtab
+
+    int symbols = 1;
+    unsigned long long strings_size = 1;
+    for(int i=0 ; i<elf_symbol_count ; i++){
+        if(elfSymbols[i].name[0] == 'L' || elfSymbols[i].name[0] == '.') continue;
+        symbols++;
+        strings_size += strlen(elfSymbols[i].name) + 1;
+    }
+    unsigned long long symtab_offset = elfAlign(offset , 8);
+    unsigned long long strings_offset = symtab_offset + 24 * symbols;
+    unsigned long long names_offset = strings_offset + strings_size;
+    unsigned long long section_headers = elfAlign(names_offset + sizeof(names) , 8);
+    unsigned long long file_size = section_headers + 64 * section_count;
+
+    unsigned char* image = (unsigned char*)calloc(file_size , 1);
+    if(image == NULL){
+        printf("06_05 || ELF emission error [06_05.01] -> Memory allocation failed for ELF emission\n");
+        exit(6);
+    }
+
+    // ELF header
+    memcpy(image , "\177ELF" , 4);
+    image[4] = 2;                                   // 64-bit
+    image[5] = 1;                                   // little endian
+    image[6] = 1;                                   // version
+    elfPut(image + 16 , 2 , 2);                     // ET_EXEC
+    elfPut(image + 18 , 62 , 2);                    // EM_X86_64
+    elfPut(image + 20 , 1 , 4);
+    elfPut(image + 24 , elfSymbolAddress("_start") , 8);
+    elfPut(image + 32 , 64 , 8);                    // program headers
+    elfPut(image + 40 , section_headers , 8);
+    elfPut(image + 52 , 64 , 2);
+    elfPut(image + 54 , 56 , 2);
+    elfPut(image + 56 , segments , 2);
+    elfPut(image + 58 , 64 , 2);
+    elfPut(image + 60 , section_count , 2);
+    elfPut(image + 62 , section_count - 1 , 2);     // .shstrtab is the last one
+
+    // program headers: .text (with the headers in front) R+X, .rodata R, .data and .bss R+W
+    static const int flags[ELF_SECTIONS] = {5, 4, 6, 6};
+    unsigned char* header = image + 64;
+    for(int s=0 ; s<ELF_SECTIONS ; s++){
+        ElfSection* section = &elfSections[s];
+        if(header_index[s] == 0) continue;
+        unsigned long long start_offset = (s == 0) ? 0 : section->offset;
+        unsigned long long file_bytes = (s == ELF_SECTION_BSS) ? 0 : section->offset + section->size - start_offset;
+        unsigned long long memory_bytes = section->offset + section->size - start_offset;
+        elfPut(header , 1 , 4);                     // PT_LOAD
+        elfPut(header + 4 , flags[s] , 4);
+        elfPut(header + 8 , start_offset , 8);
+        elfPut(header + 16 , ELF_BASE_ADDRESS + start_offset , 8);
+        elfPut(header + 24 , ELF_BASE_ADDRESS + start_offset , 8);
+        elfPut(header + 32 , file_bytes , 8);
+        elfPut(header + 40 , memory_bytes , 8);
+        elfPut(header + 48 , ELF_PAGE , 8);
+        header += 56;
+        if(s != ELF_SECTION_BSS) memcpy(image + section->offset , section->bytes , section->size);
+    }
+
+    // symbols: global functions in .text, global objects elsewhere
+    unsigned char* symbol = image + symtab_offset + 24;
+    unsigned long long string = 1;
+    for(int i=0 ; i<elf_symbol_count ; i++){
+        ElfSymbol* label = &elfSymbols[i];
+        if(label->name[0] == 'L' || label->name[0] == '.') continue;
+        elfPut(symbol , string , 4);
+        symbol[4] = (1 << 4) | ((label->section == 0) ? 2 : 1);     // STB_GLOBAL, STT_FUNC / STT_OBJECT
+        elfPut(symbol + 6 , header_index[label->section] , 2);
+        elfPut(symbol + 8 , elfSections[label->section].address + label->offset , 8);
+        symbol += 24;
+        strcpy((char*)image + strings_offset + string , label->name);
+        string += strlen(label->name) + 1;
+    }
+    memcpy(image + names_offset , names , sizeof(names));
+
+    // section headers (the first one stays empty)
+    static const int section_flags[ELF_SECTIONS] = {6, 2, 3, 3};     // SHF_ALLOC + SHF_EXECINSTR / SHF_WRITE
+    header = image + section_headers + 64;
+    for(int s=0 ; s<ELF_SECTIONS ; s++){
+        ElfSection* section = &elfSections[s];
+        if(header_index[s] == 0) continue;
+        elfPut(header , name_offsets[s] , 4);
+        elfPut(header + 4 , (s == ELF_SECTION_BSS) ? 8 : 1 , 4);     // SHT_NOBITS / SHT_PROGBITS
+        elfPut(header + 8 , section_flags[s] , 8);
+        elfPut(header + 16 , section->address , 8);
+        elfPut(header + 24 , section->offset , 8);
+        elfPut(header + 32 , section->size , 8);
+        elfPut(header + 48 , (s == 0) ? 16 : 8 , 8);
+        header += 64;
+    }
+    elfPut(header , name_offsets[ELF_SECTIONS] , 4);
+    elfPut(header + 4 , 2 , 4);                     // SHT_SYMTAB
+    elfPut(header + 24 , symtab_offset , 8);
+    elfPut(header + 32 , 24 * symbols , 8);
+    elfPut(header + 40 , symtab_index + 1 , 4);     // names in .strtab
+    elfPut(header + 44 , 1 , 4);                    // first global symbol
+    elfPut(header + 48 , 8 , 8);
+    elfPut(header + 56 , 24 , 8);
+    header += 64;
+    elfPut(header , name_offsets[ELF_SECTIONS + 1] , 4);
+    elfPut(header + 4 , 3 , 4);                     // SHT_STRTAB
+    elfPut(header + 24 , strings_offset , 8);
+    elfPut(header + 32 , strings_size , 8);
+    elfPut(header + 48 , 1 , 8);
+    header += 64;
+    elfPut(header , name_offsets[ELF_SECTIONS + 2] , 4);
+    elfPut(header + 4 , 3 , 4);                     // SHT_STRTAB
+    elfPut(header + 24 , names_offset , 8);
+    elfPut(header + 32 , sizeof(names) , 8);
+    elfPut(header + 48 , 1 , 8);
+
+    FILE* file = fopen(path , "wb");
+    if(file == NULL || fwrite(image , 1 , file_size , file) != file_size){
+        printf("06_05 || ELF emission error [06_05.04] -> Cannot write the executable (%s)\n" , path);
+        exit(6);
+    }
+    fclose(file);
+    chmod(path , 0755);
+
+    elf_code_bytes = elfSections[0].size;
+    elf_data_bytes = elfSections[1].size + elfSections[2].size + elfSections[3].size;
+    elf_file_bytes = (int)file_size;
+    free(image);
+    elfReset();
+}
+
+// size of the last executable (terminal)
+void printElfStats(const char* path){
+    printf("   ELF: %s, %d bytes of code, %d bytes of data, %d bytes in the file\n" ,
+           path , elf_code_bytes , elf_data_bytes , elf_file_bytes);
+}
@@ -11,8 +11,16 @@
  * - Code Optimization (CFG, Basic Blocks, Data Flow Analysis)
  * - Target Code Generation (x86-64 Assembly)
  * 
- * usage: RMc4 <source_file.c> <output_file>
+ * usage: RMc4 <source_file.c> <output_file> [-O0|-O1|-O2|-O3] [--passes=<list>]
+ *             [--opt-fuel=<n>] [--opt-time=<ms>] [--threads=<n>] [--regs=<n>] [--vector=<isa>]
+ *             [--elf=<file>]
  * output file name must be: compiler_output.txt
+ * -O selects the optimization pipeline (default -O2), --passes= overrides it
+ * --opt-fuel / --opt-time stop optimizing after n transformations / ms milliseconds
+ * --threads runs the block-local optimization phases on n threads (default 1)
+ * --regs limits the registers the x86-64 backend keeps values in (default 11, 0 = all on the stack)
+ * --vector picks the instructions of vectorized array loops: none, sse2 (default) or avx2
+ * --elf also writes a static x86-64 ELF executable (no assembler or linker needed)
  * 
  * Author: Ridham Khurana
  */
@@ -30,12 +38,13 @@ char output_filename[MAX_NAME];
 int main(int argc, char* argv[]) {
     char file_name[MAX_NAME];
     char output_file_name[MAX_NAME];
+    char elf_file_name[MAX_NAME] = "";
     
     // check if correct number of arguments provided
-    if (argc != 3) {
+    if (argc < 3) {
         printf("Error: Incorrect usage\n");
-        printf("Usage: RMc4 <source_file.c> <output_file>\n");
-        printf("Example: RMc4 test.c compiler_output.txt\n");
+        printf("Usage: RMc4 <source_file.c> <output_file> [-O0|-O1|-O2|-O3] [--passes=<list>] [--opt-fuel=<n>] [--opt-time=<ms>] [--threads=<n>] [--regs=<n>] [--vector=<isa>] [--elf=<file>]\n");
+        printf("Example: RMc4 test.c compiler_output.txt -O2\n");
         exit(1);
     }
     
@@ -55,6 +64,69 @@ int main(int argc, char* argv[]) {
         exit(1);
     }
 
+    // optimization options (the last -O or --passes= wins)
+    setOptimizationLevel(2);
+    for (int i = 3; i < argc; i++) {
+        if (strlen(argv[i]) == 3 && strncmp(argv[i], "-O", 2) == 0 && argv[i][2] >= '0' && argv[i][2] <= '3') {
+            setOptimizationLevel(argv[i][2] - '0');
+        } else if (strncmp(argv[i], "--passes=", 9) == 0) {
+            char* error = setOptimizationPipeline(argv[i] + 9);
+            if (error != NULL) {
+                char names[MAX_NAME * 4];
+                getOptimizationPassNames(names, sizeof(names));
+                printf("Error: %s\n", error);
+                printf("Available passes: %s\n", names);
+                printf("Example: --passes=sccp,cfg,(constprop,fold,copyprop)*3,dce,cfg\n");
+                exit(1);
+            }
+        } else if (strncmp(argv[i], "--opt-fuel=", 11) == 0 || strncmp(argv[i], "--opt-time=", 11) == 0) {
+            // optimization budget: number of transformations or milliseconds
+            char* end;
+            double value = strtod(argv[i] + 11, &end);
+            if (argv[i][11] == '\0' || *end != '\0' || value < 0) {
+                printf("Error: '%s' needs a non-negative number\n", argv[i]);
+                exit(1);
+            }
+            if (argv[i][6] == 'f') setOptimizationBudget((long long)value, opt_time_limit_ms);
+            else setOptimizationBudget(opt_fuel_limit, value);
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            // threads of the block-local optimization phases (the output is the same for every n)
+            char* end;
+            long value = strtol(argv[i] + 10, &end, 10);
+            if (argv[i][10] == '\0' || *end != '\0' || value < 1 || value > MAX_OPT_THREADS) {
+                printf("Error: '%s' needs a number from 1 to %d\n", argv[i], MAX_OPT_THREADS);
+                exit(1);
+            }
+            setOptimizationThreads((int)value);
+        } else if (strncmp(argv[i], "--regs=", 7) == 0) {
+            // registers of the linear-scan allocator (0 = every value in its stack slot)
+            char* end;
+            long value = strtol(argv[i] + 7, &end, 10);
+            if (argv[i][7] == '\0' || *end != '\0' || value < 0 || value > MAX_REAL_REGISTERS) {
+                printf("Error: '%s' needs a number from 0 to %d\n", argv[i], MAX_REAL_REGISTERS);
+                exit(1);
+            }
+            setRegisterLimit((int)value);
+        } else if (strncmp(argv[i], "--vector=", 9) == 0) {
+            // instruction set of the loop vectorizer (none = scalar loops only)
+            if (!setVectorIsa(argv[i] + 9)) {
+                printf("Error: '%s' needs none, sse2 or avx2\n", argv[i]);
+                exit(1);
+            }
+        } else if (strncmp(argv[i], "--elf=", 6) == 0) {
+            // executable written by the integrated encoder after the assembly
+            if (argv[i][6] == '\0' || strlen(argv[i] + 6) >= MAX_NAME) {
+                printf("Error: '%s' needs a file name\n", argv[i]);
+                exit(1);
+            }
+            strcpy(elf_file_name, argv[i] + 6);
+        } else {
+            printf("Error: Unknown option '%s'\n", argv[i]);
+            printf("Usage: RMc4 <source_file.c> <output_file> [-O0|-O1|-O2|-O3] [--passes=<list>] [--opt-fuel=<n>] [--opt-time=<ms>] [--threads=<n>] [--regs=<n>] [--vector=<isa>] [--elf=<file>]\n");
+            exit(1);
+        }
+    }
+
     // Variables for timing
     clock_t start_time, end_time, phase_start, phase_end;
     double total_time_ms, phase_time_ms;
@@ -120,7 +192,9 @@ int main(int argc, char* argv[]) {
     startOptimization();
     phase_end = clock();
     phase_time_ms = ((double)(phase_end - phase_start)) / CLOCKS_PER_SEC * 1000.0;
-    printf("✓ Optimization process completed [took %.3f ms]\n\n", phase_time_ms);
+    printf("✓ Optimization process completed [took %.3f ms]\n", phase_time_ms);
+    printOptimizationPassStats();
+    printf("\n");
     
     // store instruction count after optimization
     instruction_count_after_optimization = addr_count;
@@ -132,12 +206,29 @@ int main(int argc, char* argv[]) {
     printf("⚙️  Generating target code (x86-64)...\n");
     phase_start = clock();
     generateRealTargetCode();
+    optimizeRealAssembly();
     phase_end = clock();
     phase_time_ms = ((double)(phase_end - phase_start)) / CLOCKS_PER_SEC * 1000.0;
-    printf("✓ Target code generation completed [took %.3f ms]\n\n", phase_time_ms);
+    printf("✓ Target code generation completed [took %.3f ms]\n", phase_time_ms);
+    printStackFrameStats();
+    printRegisterStats();
+    printPeepholeStats();
+    printf("\n");
     
     printRealTargetCodeToFile();
 
+    // ===== PHASE 6b: ELF EXECUTABLE (optional) =====
+    if (elf_file_name[0] != '\0') {
+        printf("⚙️  Writing ELF executable...\n");
+        phase_start = clock();
+        writeRealElfExecutable(elf_file_name);
+        phase_end = clock();
+        phase_time_ms = ((double)(phase_end - phase_start)) / CLOCKS_PER_SEC * 1000.0;
+        printf("✓ ELF executable written [took %.3f ms]\n", phase_time_ms);
+        printElfStats(elf_file_name);
+        printf("\n");
+    }
+
     // Close output file
     closeOutputFile();
     
@@ -44,6 +44,9 @@ int block_prop_count = 0;        // Number of block properties
 blockPropLive* allBlockPropsLive[MAX]; // Live variable analysis data
 int block_prop_live_count = 0;   // Number of live variable properties
 
+optPhaseStat optPhaseStats[MAX_STATEMENTS]; // Per-phase optimization statistics
+int opt_phase_count = 0;         // Number of recorded phases
+
 // Token type name lookup table for display purposes
 const char* tokenTypeNames[] = {
     "KEYWORD_INT", "KEYWORD_CHAR", "KEYWORD_DOUBLE", "KEYWORD_BOOL",
@@ -85,3 +88,122 @@ bool isStringSame(char *str1, char *str2){
 }
 
 
+
+/**
+ * hashString - Compute the FNV-1a hash of a null-terminated string
+ * 
+ * Used by the hash tables in the optimizer and the backend to map
+ * variable names and expressions to table slots in O(1).
+ * 
+ * @param str: String to hash
+ * @return: 32-bit hash value
+ */
+unsigned int hashString(const char *str){
+    unsigned int hash = 2166136261u;   // FNV offset basis
+
+    while(*str != '\0'){
+        hash ^= (unsigned char)*str;
+        hash *= 16777619u;             // FNV prime
+        str++;
+    }
+
+    return hash;
+}
+
+/**
+ * hashTableSize - Slot count of an open-addressing hash table for n entries
+ * 
+ * Smallest power of two (at least 16) that is >= 2*n, so the table stays
+ * at most half full and "hash & (size-1)" picks a slot.
+ * 
+ * @param n: Maximum number of entries
+ * @return: Number of slots
+ */
+int hashTableSize(int n){
+    int size = 16;
+    while(size < 2*n) size *= 2;
+    return size;
+}
+
+/**
+ * isCommutativeOp - Check whether swapping the operands keeps the result
+ * 
+ * Value numbering and partial redundancy elimination sort the operands of
+ * these operators so a+b and b+a are the same expression.
+ * 
+ * @param op: Binary operator of a TAC instruction
+ * @return: true for + * == != && ||
+ */
+bool isCommutativeOp(char* op){
+    return isStringSame(op , "+") || isStringSame(op , "*") ||
+           isStringSame(op , "==") || isStringSame(op , "!=") ||
+           isStringSame(op , "&&") || isStringSame(op , "||");
+}
+
+/**
+ * formatDoubleConstant - Write a double as the shortest text that reads back exactly
+ * 
+ * Three-address code keeps constants as text, so a double must be printed
+ * with enough digits to round-trip (2.5 stays "2.5", 0.1 stays "0.1").
+ * The text always contains a '.' or an exponent so it is never read as int.
+ * 
+ * @param value: Value to format (must be finite)
+ * @param output: Buffer of at least MAX_NAME characters
+ */
+void formatDoubleConstant(double value, char* output){
+    // plain decimal form for ordinary magnitudes ("10.0", "0.1")
+    if(value == 0.0 || (fabs(value) >= 1e-4 && fabs(value) < 1e15)){
+        for(int decimals = 1; decimals <= 24; decimals++){
+            snprintf(output, MAX_NAME, "%.*f", decimals, value);
+            if(strtod(output, NULL) == value) return;   // shortest exact form found
+        }
+    }
+
+    // exponent form for very large or very small values ("1e+20")
+    for(int precision = 1; precision <= 17; precision++){
+        snprintf(output, MAX_NAME, "%.*g", precision, value);
+        if(strtod(output, NULL) == value) break;   // shortest exact form found
+    }
+
+    // "3" -> "3.0" so the constant keeps its double type
+    if(!strchr(output, '.') && !strchr(output, 'e')){
+        strcat(output, ".0");
+    }
+}
+
+/**
+ * formatCharConstant - Write a char as a quoted constant ('A', '\n')
+ * 
+ * Quoting keeps char constants apart from variable names in the
+ * three-address code.
+ * 
+ * @param value: Character to format
+ * @param output: Buffer of at least 5 characters
+ */
+void formatCharConstant(char value, char* output){
+    switch(value){
+        case '\n': strcpy(output, "'\\n'"); return;
+        case '\t': strcpy(output, "'\\t'"); return;
+        case '\0': strcpy(output, "'\\0'"); return;
+        case '\\': strcpy(output, "'\\\\'"); return;
+        case '\'': strcpy(output, "'\\''"); return;
+        default: sprintf(output, "'%c'", value); return;
+    }
+}
+
+/**
+ * charConstantValue - Read the character of a quoted constant ('A' -> 65)
+ * 
+ * @param str: Constant in the form written by formatCharConstant
+ * @return: The character value
+ */
+char charConstantValue(const char* str){
+    if(str[1] != '\\') return str[1];
+
+    switch(str[2]){
+        case 'n': return '\n';
+        case 't': return '\t';
+        case '0': return '\0';
+        default: return str[2];   // '\\' and '\''
+    }
+}
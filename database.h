@@ -25,6 +25,7 @@
 #include <math.h>       // Math operations for floating-point
 #include <stdbool.h>    // Boolean type support
 #include <ctype.h>      // Character classification
+#include <stdint.h>     // uintptr_t (hashing block addresses)
 
 // ============================================================================
 // CONFIGURATION CONSTANTS
@@ -484,6 +485,9 @@ extern int block_prop_count;
  * data flow problem - we compute from OUT to IN:
  * IN[B] = GEN[B] ∪ (OUT[B] - KILL[B])
  * OUT[B] = ∪ IN[S] for all successors S of B
+ *
+ * owner/hash remember which block the sets were solved for, so that after
+ * local transformations only the changed blocks are solved again.
  */
 typedef struct blockPropLive{
     char genLive[MAX_STATEMENTS][MAX_STATEMENTS];  // Variables used in this block
@@ -497,12 +501,85 @@ typedef struct blockPropLive{
 
     char outLive[MAX_STATEMENTS][MAX_STATEMENTS];  // Variables live at block exit
     int numOutLive;
+
+    block* owner;                                  // Block the sets belong to (NULL = not solved)
+    unsigned long long hash;                       // hashOfBlock() + successors when GEN/KILL were made
 } blockPropLive;
 
 // Global storage for live variable analysis
 extern blockPropLive* allBlockPropsLive[MAX];
 extern int block_prop_live_count;
 
+/**
+ * optPhaseStat - Instruction counts recorded around one optimization phase
+ * 
+ * Every step of the optimization pipeline (05_07) records how many
+ * instructions the program had before and after it ran, so the report can
+ * show what each step saved. 'detail' holds phase-specific counters (may be
+ * empty). A step inside a repeated group is run several times; its row sums
+ * the time of all runs and keeps the count before the first run.
+ */
+typedef struct optPhaseStat{
+    char name[MAX_NAME];                 // Phase name shown in the report
+    int instructionsBefore;              // Instruction count when the phase started
+    int instructionsAfter;               // Instruction count when the phase finished
+    char detail[MAX_NAME];               // Extra counters of the phase
+    double timeMs;                       // Wall time of all runs in milliseconds
+    int runs;                            // How often the step ran
+    bool changed;                        // True if any run changed the code
+    bool outOfBudget;                    // Optimization budget ran out during this step
+    bool skipped;                        // Step never ran because the budget was gone
+} optPhaseStat;
+
+/**
+ * optPass - A registered optimization pass (05_07)
+ * 
+ * 'name' is used in --passes=, 'title' in the statistics. 'run' optimizes
+ * allBlocks and may write its counters into 'detail' (MAX_NAME bytes).
+ */
+#define MAX_OPT_PASSES 32                // Maximum registered optimization passes
+
+typedef void (*OptPassFunc)(char* detail);
+
+typedef struct optPass{
+    char name[MAX_NAME];                 // Name used in the pipeline (--passes=)
+    char title[MAX_NAME];                // Name shown in the statistics
+    OptPassFunc run;                     // Pass entry point
+} optPass;
+
+/**
+ * BlockWorkFunc - Work of a block-local phase for one block (05_08)
+ * 
+ * Called with the position of the block in allBlocks, possibly on several
+ * threads at once: it may only change that block. Returns a count (e.g. the
+ * number of rewrites); runOnAllBlocks() returns the sum over all blocks.
+ */
+#define MAX_OPT_THREADS 64               // Maximum threads of the block-local phases
+
+typedef int (*BlockWorkFunc)(int blockIndex);
+
+extern int opt_level;                     // -O level (0-3, default 2)
+extern char opt_pipeline_name[MAX_NAME];  // "-O2" or "--passes"
+extern long long opt_fuel_limit;          // --opt-fuel= (-1 = unlimited)
+extern double opt_time_limit_ms;          // --opt-time= in ms (-1 = unlimited)
+extern long long opt_fuel_used;           // Transformations done by the last pipeline
+extern bool opt_budget_exhausted;         // True once fuel or time ran out
+extern int opt_thread_count;              // --threads= (default 1)
+
+// Global storage for per-phase optimization statistics
+extern optPhaseStat optPhaseStats[MAX_STATEMENTS];
+extern int opt_phase_count;
+extern int pre_replaced_count;            // Evaluations replaced by the last PRE run (05_02)
+extern int pre_inserted_count;            // Evaluations inserted by the last PRE run (05_02)
+extern int sccp_branches_pruned;          // Constant branches removed by the last SCCP run (05_04)
+extern int sccp_blocks_removed;           // Unreachable blocks removed by the last SCCP run (05_04)
+extern int cfg_jumps_threaded;            // Jumps retargeted by the last CFG simplification (05_05)
+extern int cfg_jumps_removed;             // Jumps removed by the last CFG simplification (05_05)
+extern int cfg_blocks_removed;            // Blocks removed or merged by the last CFG simplification (05_05)
+extern int live_dead_removed;             // Instructions removed by the last DCE run
+extern int live_blocks_solved;            // Blocks whose live IN/OUT the last DCE run solved again
+extern int live_blocks_seen;              // Blocks the last DCE run would have solved without reuse
+
 // ============================================================================
 // TARGET CODE GENERATION DATA STRUCTURES
 // ============================================================================
@@ -528,9 +605,46 @@ extern int addr_count;                   // Number of TAC instructions
 extern AsmInstruction* asmCode[MAX];     // Simplified assembly output
 extern int asm_count;                    // Number of pseudo-assembly instructions
 
-// Real assembly code storage (fully assemblable x86-64)
-extern AsmInstruction* realAsmCode[MAX]; // Actual x86-64 assembly output
-extern int real_asm_count;               // Number of real assembly instructions
+// Real assembly code storage (fully assemblable x86-64), lines packed into growable chunks
+extern int real_asm_count;               // Number of real assembly lines
+extern int real_loop_idioms;             // Fill/copy loops generated without a loop
+
+// Loop vectorizer of the real assembly (06_01)
+typedef enum {
+    VECTOR_NONE,                         // scalar code only
+    VECTOR_SSE2,                         // 128-bit %xmm, 2 elements (default)
+    VECTOR_AVX2                          // 256-bit %ymm, 4 elements
+} VectorIsa;
+extern VectorIsa real_vector_isa;        // --vector=
+extern int real_loops_vectorized;        // Loops vectorized by the last run
+
+// Stack frame of the real assembly (06_02)
+extern int stack_frame_before;           // Frame size (bytes) with one slot per name
+extern int stack_frame_after;            // Frame size (bytes) with shared slots
+extern int stack_slot_names;             // Scalar names that got a slot
+extern int stack_slot_count;             // Slots shared by those names
+extern int stack_copies_coalesced;       // Copies whose two names share one slot
+
+// Register allocation of the real assembly (06_03)
+#define MAX_REAL_REGISTERS 11            // Registers the allocator may hand out
+#define MAX_REAL_XMM_REGISTERS 14        // %xmm2-%xmm15 for doubles (%xmm0/%xmm1 are scratch)
+extern int reg_limit;                    // --regs= (0 = every value on the stack)
+extern int reg_names_allocated;          // Names kept in a register
+extern int reg_names_spilled;            // Names that had to stay on the stack
+extern int reg_used_count;               // Distinct registers used
+
+// Peephole optimization of the real assembly (06_04)
+extern int peep_store_load_forwarded;    // Loads replaced by the stored register/constant
+extern int peep_moves_removed;           // Redundant or dead moves removed
+extern int peep_strength_reduced;        // Immediate operations made cheaper
+extern int peep_jumps_removed;           // Jumps to the directly following label removed
+extern int peep_lines_before;            // Assembly lines before the peephole pass
+extern int peep_lines_after;             // Assembly lines after the peephole pass
+
+// Direct ELF emission (06_05)
+extern int elf_code_bytes;               // Machine code bytes of the last executable (with _start)
+extern int elf_data_bytes;               // Bytes of .rodata, .data and .bss
+extern int elf_file_bytes;               // Size of the executable file
 
 // Symbol table storage
 extern symbol* symbolTable[MAX];         // Array of all symbols
@@ -561,6 +675,12 @@ extern char output_filename[MAX_NAME];   // Name of the compiler output file
 
 // --- Utility Functions ---
 bool isStringSame(char *str1, char *str2);  // String comparison helper
+unsigned int hashString(const char *str);   // FNV-1a string hash for hash tables
+int hashTableSize(int n);                   // Power-of-two slot count keeping n entries at most half full
+bool isCommutativeOp(char* op);             // + * == != && || (operands may be swapped)
+void formatDoubleConstant(double value, char* output); // Shortest exact text of a double
+void formatCharConstant(char value, char* output);     // Quoted char constant ('A')
+char charConstantValue(const char* str);               // Value of a quoted char constant
 
 // --- Phase 1: Lexical Analysis ---
 void generateTokens(char* file_name);       // Tokenize source file
@@ -580,17 +700,103 @@ void printSymbolTable();                    // Display entire symbol table
 
 // --- Phase 4: Intermediate Code Generation ---
 void startICG();                            // Generate three-address code from AST
+char* generateNewAddrResult();              // Fresh temporary name (T0, T1, ...)
+char* generateNewAddrLabel();               // Fresh label name (L0, L1, ...)
 void print3AddressCode();                   // Display TAC instructions
 
 // --- Phase 5: Code Optimization ---
 void startOptimization();                   // Run optimization passes on TAC
+void checkForLocalValueNumbering();         // Block-local CSE via value numbering (05_01)
+void startPartialRedundancyPhase();         // Global PRE via lazy code motion (05_02)
+void checkForAlgebraicSimplification();    // Rule-table identities and strength reduction (05_03)
+void startSparseConditionalConstPhase();    // SCCP with branch pruning (05_04)
+void simplifyControlFlowGraph();            // Jump threading, block merging, dead blocks (05_05)
+void checkForConstantPropagation();         // Constant propagation via memoised resolver (05_06)
+void checkForCopyPropagation();             // Copy propagation over available copies (05_06)
+void checkForConstantFolding();             // Fold instructions with constant operands
+void startLiveVaraiblePhase();              // Live variable analysis and DCE
+void calculateLiveVariables();              // Live variable IN/OUT of all blocks (no DCE)
+void getPropertiesOfAllBlocks();            // Reaching definition GEN/KILL/IN/OUT (for the report)
+void registerOptimizationPass(char* name, char* title, OptPassFunc run); // Add a pass (05_07)
+void setOptimizationLevel(int level);       // Select the -O0..-O3 pipeline (05_07)
+char* setOptimizationPipeline(const char* spec); // Select a --passes= pipeline (NULL or error)
+void getOptimizationPassNames(char* out, int size); // Registered pass names (for usage)
+void runOptimizationPipeline();             // Run the selected pipeline over allBlocks (05_07)
+void printOptimizationPassStats();          // Per-step statistics to stdout (05_07)
+void setOptimizationBudget(long long fuel, double timeMs); // Fuel/time limit, -1 = unlimited (05_07)
+bool hasOptimizationFuel();                 // False once the budget is gone: skip the transformation
+void burnOptimizationFuel();                // Count one transformation
+char* getOptimizationBudgetSummary();       // Fuel/time used by the last pipeline (for reports)
+void setOptimizationThreads(int n);         // Threads of the block-local phases (05_08)
+int getOptimizationThreads();               // Threads used
+long long runOnAllBlocks(BlockWorkFunc work); // Run work on every block, in parallel (05_08)
+
+// --- Phase 5: CFG editing helpers shared by the optimization passes ---
+bool isInteger(char* str);                  // Integer constant check
+bool isDouble(char* str);                   // Double constant check
+bool isCharConstant(char* str);             // Char constant check ('x')
+bool isConstant(char* str);                 // Int, double, char or bool constant check
+int stringToInt(char* str);                 // Integer constant to int
+double getNumericValueOfConstant(char* str); // Numeric value of int/double/char/bool constant
+char* foldConstantBinOp(char* op, char* arg1, char* arg2); // Fold two constants (NULL if not foldable)
+char* foldConstantUnOp(char* op, char* arg1); // Fold unary op on a constant (NULL if not foldable)
+bool isTemporaryVariable(char* str);        // Temporary check (T0, T1, ...)
+bool isVariable(char* str);                 // True for temporaries and declared variables
+tokenType getTypeOfOperand(char* str);      // Type of constant/variable/temporary (MISC_UNKNOWN if unsure)
+char* getLeftSideOfKindOfAssign(address* addr); // Name defined by instruction (NULL for jumps/labels)
+int findIndexOfBlock(block* currBlock);     // Position of block in allBlocks
+block* generateEmptyBlock();                // New block, not yet placed in allBlocks
+void insertBlockAt(int position, block* newBlock); // Place block (decides fall-through order)
+address* generateOptimizerAddress(addrType type);  // New instruction not in allAddress
+void insertAddressIntoBlock(block* currBlock, int position, address* addr); // Insert instruction
+void replaceCFGEdge(block* from, block* oldTo, block* newTo); // Redirect CFG edge
+void addCFGEdge(block* from, block* to);    // Add CFG edge in both directions
+void removeCFGEdge(block* from, block* to); // Remove one CFG edge in both directions
+void removeBlockAt(int position);           // Drop block and all its CFG edges
+void rebuildAddressListFromBlocks();        // Refresh allAddress from block order
+int countInstructionsInBlocks();            // Total instructions over all blocks
+unsigned long long hashOfBlock(block* currBlock); // Hash of the instructions of a block
+void recordOptPhaseStat(char* name, int before, int after, char* detail); // Store phase statistics
 void printBlocks();                         // Display basic blocks and CFG
 
 // --- Phase 6: Target Code Generation ---
 void generateTargetCode();                  // Generate pseudo-assembly code
 void printTargetCode();                     // Display pseudo-assembly
 void generateRealTargetCode();              // Generate real x86-64 assembly
+bool setVectorIsa(const char* name);        // --vector=none|sse2|avx2 (false if unknown)
 void printRealTargetCode();                 // Display real x86-64 assembly
+void addRealAsmInstruction(const char* instr); // Append a line of real x86-64 assembly
+void emitRealAsm(const char* format, ...)   // Append a printf-formatted line of real assembly
+    __attribute__((format(printf, 1, 2)));
+const char* getRealAsmLine(int index);      // Line of the real assembly
+void clearRealAsm();                        // Drop every line of the real assembly
+bool isRealNumber(const char* str);         // Immediate operand check (06_01)
+bool isRealLabel(const char* str);          // Label operand check (06_01)
+bool isRealDoubleName(const char* name);    // Name holding a double (06_01)
+bool isRealArrayName(const char* name);     // Array of the symbol table (06_01)
+int getStackOffset(const char* var_name);   // Stack offset of a name (allocated on first use)
+void setStackOffset(const char* var_name, int offset); // Place a name at a given stack offset
+void setRealRegister(const char* var_name, const char* reg); // Keep a name in a register
+void analyzeRealLiveness();                 // Live variables and intervals over the final TAC (06_02)
+int getRealLiveNameCount();                 // Scalar names of the last analysis
+const char* getRealLiveName(int index);     // Name of an index of the last analysis
+int findRealLiveName(const char* name);     // Index of a name of the last analysis (-1 if none)
+void getRealLiveInterval(int index, int* start, int* end); // First and last position a name is live
+int getRealLiveDefinedAt(int position);     // Name index defined at a position (-1 if none)
+int allocateStackSlots(int first_offset);   // Shared slots for names without register (returns next free offset)
+void setRegisterLimit(int n);               // --regs=
+void allocateRegisters();                   // Linear scan over the live intervals (06_03)
+int getAllocatedRegister(int index);        // Register of a name index (-1 = stack)
+bool isRegisterInUse(const char* name);     // Register given to any name by the last allocation
+int allocateRegisterSaveSlots(int first_offset); // Slots for the callee-saved registers in use
+void generateRegisterSaves();               // Save callee-saved registers (prologue)
+void generateRegisterRestores();            // Restore callee-saved registers (epilogue)
+void printRegisterStats();                  // Display register allocation summary
+void optimizeRealAssembly();                // Peephole rules over the real assembly (06_04)
+void printPeepholeStats();                  // Display the peephole rules fired
+void writeRealElfExecutable(const char* path); // Encode the real assembly into a static ELF executable (06_05)
+void printElfStats(const char* path);       // Display the size of the executable
+void printStackFrameStats();                // Display frame size before/after slot sharing
 
 // --- File Output Functions (00_01_printToFile.c) ---
 void initializeOutputFile();                // Open output file for writing
@@ -0,0 +1,88 @@
+#!/bin/bash
+
+# Loop runtime of divisions by constants: magic-number multiply vs idivq
+# Generates an averaging loop that divides by the literals 25, 7 and 10, and
+# the same loop with the divisors read from an array (not known to the
+# compiler, so they stay idivq). Both are assembled with gcc and the best
+# run time of each is printed.
+#
+# usage: tester/bench_division.sh [outer iterations (default 20000)] [runs (default 5)]
+
+OUTER=${1:-20000}
+RUNS=${2:-5}
+WORK=$(mktemp -d /tmp/rmc4_bench_XXXXXX)
+
+if [ ! -x ./RMc4 ]; then
+    echo "Build the compiler first (make)"
+    exit 1
+fi
+
+# generate the program, $1 $2 $3 are the three divisors
+program() {
+    cat <<PROGRAM
+int main() {
+    int i = 0;
+    int j = 0;
+    int total = 0;
+    int avg = 0;
+    int div[3] = {25, 7, 10};
+    int result[2] = {0, 0};
+    while (i < $OUTER) {
+        j = 0;
+        while (j < 1000) {
+            total = total + i - j;
+            avg = avg + total / $1 + (total - j) / $2 + j / $3;
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    result[0] = total;
+    result[1] = avg;
+}
+PROGRAM
+}
+
+# compile, cut the assembly out of the report and assemble it
+build() {
+    local name=$1
+    if ! ./RMc4 "$WORK/$name.c" compiler_output.txt | grep -q "Compilation completed successfully"; then
+        echo "Compilation failed ($name)"
+        exit 1
+    fi
+    awk '/REAL TARGET CODE \(Assemblable/ { on = 1; next } on && /Total Instructions/ { on = 0 } on' compiler_output.txt |
+        sed -n 's/^║ [ 0-9]\{5\} │ \(.*\)║$/\1/p' | sed 's/ *$//' > "$WORK/$name.s"
+    gcc -no-pie -z noexecstack -o "$WORK/$name" "$WORK/$name.s" || exit 1
+}
+
+# best wall time (ms) of a few runs
+measure() {
+    local best=""
+    for run in $(seq 1 "$RUNS"); do
+        local start=$(date +%s%N)
+        "$WORK/$1"
+        local ms=$(( ($(date +%s%N) - start) / 1000000 ))
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo "$best"
+}
+
+program "div[0]" "div[1]" "div[2]" > "$WORK/idiv.c"
+program 25 7 10 > "$WORK/magic.c"
+build idiv
+build magic
+
+echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
+echo "  RM COMPILER - DIVISION BY CONSTANTS, IDIVQ VS MAGIC NUMBERS"
+echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
+echo "  Program: $OUTER x 1000 loop iterations, 3 divisions each, best of $RUNS runs"
+echo ""
+
+idiv=$(measure idiv)
+magic=$(measure magic)
+printf "  divisors from memory (idivq)   : %6d ms   %2d idivq\n" "$idiv" "$(grep -c idivq "$WORK/idiv.s")"
+printf "  constant divisors (multiply)   : %6d ms   %2d idivq\n" "$magic" "$(grep -c idivq "$WORK/magic.s")"
+printf "  speedup %.2fx\n" "$(awk -v a="$idiv" -v b="$magic" 'BEGIN { print (b > 0) ? a / b : 0 }')"
+
+rm -rf "$WORK"
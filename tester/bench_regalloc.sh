@@ -0,0 +1,83 @@
+#!/bin/bash
+
+# Loop runtime with and without register allocation (06_03)
+# Generates a program with nested loops, compiles it once with all registers
+# and once with --regs=0 (every value in its stack slot, as before the
+# allocator), assembles both with gcc and prints the best run time of each.
+#
+# usage: tester/bench_regalloc.sh [outer iterations (default 20000)] [runs (default 5)]
+
+OUTER=${1:-20000}
+RUNS=${2:-5}
+WORK=$(mktemp -d /tmp/rmc4_bench_XXXXXX)
+
+if [ ! -x ./RMc4 ]; then
+    echo "Build the compiler first (make)"
+    exit 1
+fi
+
+# generate the program
+cat > "$WORK/prog.c" <<PROGRAM
+int main() {
+    int i = 0;
+    int j = 0;
+    int sum = 0;
+    int acc = 1;
+    int result[2] = {0, 0};
+    while (i < $OUTER) {
+        j = 0;
+        while (j < 1000) {
+            sum = sum + i * j + 3;
+            acc = acc + (sum - j) * 7;
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    result[0] = sum;
+    result[1] = acc;
+}
+PROGRAM
+
+# compile, cut the assembly out of the report and assemble it
+build() {
+    local name=$1
+    shift
+    if ! ./RMc4 "$WORK/prog.c" compiler_output.txt "$@" | grep -q "Compilation completed successfully"; then
+        echo "Compilation failed ($*)"
+        exit 1
+    fi
+    awk '/REAL TARGET CODE \(Assemblable/ { on = 1; next } on && /Total Instructions/ { on = 0 } on' compiler_output.txt |
+        sed -n 's/^║ [ 0-9]\{5\} │ \(.*\)║$/\1/p' | sed 's/ *$//' > "$WORK/$name.s"
+    gcc -no-pie -z noexecstack -o "$WORK/$name" "$WORK/$name.s" || exit 1
+}
+
+# best wall time (ms) of a few runs
+measure() {
+    local best=""
+    for run in $(seq 1 "$RUNS"); do
+        local start=$(date +%s%N)
+        "$WORK/$1"
+        local ms=$(( ($(date +%s%N) - start) / 1000000 ))
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo "$best"
+}
+
+build stack --regs=0
+build regs
+
+echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
+echo "  RM COMPILER - LOOP RUNTIME, STACK SLOTS VS REGISTERS"
+echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
+echo "  Program: $OUTER x 1000 loop iterations, best of $RUNS runs"
+echo ""
+
+stack=$(measure stack)
+regs=$(measure regs)
+printf "  all values on the stack (--regs=0): %6d ms   %4d instructions\n" "$stack" "$(grep -c . "$WORK/stack.s")"
+printf "  linear-scan registers             : %6d ms   %4d instructions\n" "$regs" "$(grep -c . "$WORK/regs.s")"
+printf "  speedup %.2fx\n" "$(awk -v a="$stack" -v b="$regs" 'BEGIN { print (b > 0) ? a / b : 0 }')"
+
+rm -rf "$WORK"
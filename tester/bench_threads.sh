@@ -0,0 +1,62 @@
+#!/bin/bash
+
+# Scaling benchmark of the block-local optimization phases (05_08)
+# Generates a program of while-loops, three blocks each, as many as the token
+# buffer (MAX) allows: 680 loops give about 2000 blocks. Runs fold, lvn and
+# dce on 1/2/4/8 threads and prints the best wall time of those passes out of
+# a few runs.
+#
+# usage: tester/bench_threads.sh [while-loops (default 680)] [runs (default 5)]
+
+COUNT=${1:-680}
+RUNS=${2:-5}
+PROGRAM=$(mktemp /tmp/rmc4_bench_XXXXXX.c)
+
+if [ ! -x ./RMc4 ]; then
+    echo "Build the compiler first (make)"
+    exit 1
+fi
+
+# generate the program
+{
+    echo "int main() {"
+        echo "    int y = 0;"
+    for i in $(seq 1 "$COUNT"); do
+        echo "    while(y > $i){ y = $i; }"
+    done
+    echo "}"
+} > "$PROGRAM"
+
+echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
+echo "  RM COMPILER - BLOCK-LOCAL PHASES, THREAD SCALING"
+echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
+echo "  Program: $COUNT while-loops, passes: fold,lvn,dce, best of $RUNS runs"
+echo "  CPUs: $(nproc)"
+echo ""
+
+base=""
+for threads in 1 2 4 8; do
+    best=""
+    for run in $(seq 1 "$RUNS"); do
+        output=$(./RMc4 "$PROGRAM" compiler_output.txt --passes=fold,lvn,dce --threads=$threads)
+        if ! echo "$output" | grep -q "Compilation completed successfully"; then
+            echo "$output" | grep "\[0" | head -1
+            rm -f "$PROGRAM"
+            exit 1
+        fi
+
+        # sum of the wall times of the three passes
+        ms=$(echo "$output" | grep -E "Constant Folding|Local Value Numbering|Dead Code Elimination" |
+             awk '{ for(i=2 ; i<=NF ; i++) if($i == "ms") sum += $(i-1) } END { printf "%.3f", sum }')
+        if [ -z "$best" ] || awk -v a="$ms" -v b="$best" 'BEGIN { exit !(a < b) }'; then
+            best=$ms
+        fi
+    done
+
+    [ -z "$base" ] && base=$best
+    printf "  %d thread(s): %10.3f ms   speedup %.2fx\n" "$threads" "$best" "$(awk -v a="$base" -v b="$best" 'BEGIN { print (b > 0) ? a / b : 0 }')"
+done
+
+echo ""
+echo "  Basic blocks: $(grep -o -m1 'Total Blocks: [0-9]*' compiler_output.txt | grep -o '[0-9]*')"
+rm -f "$PROGRAM"
@@ -0,0 +1,119 @@
+#!/bin/bash
+
+# Loop runtime of vectorized array loops: scalar vs SSE2 vs AVX2
+# Generates a program whose inner loops add two int arrays, scale and add
+# two double arrays and sum an int and a double array (the double sum stays
+# scalar to keep its rounding), and compiles it with
+# --vector=none, --vector=sse2 and --vector=avx2. Each build is assembled
+# with gcc and the best run time of each is printed (AVX2 is skipped if the
+# CPU lacks it).
+#
+# usage: tester/bench_vectorize.sh [outer iterations (default 20000)] [runs (default 5)]
+
+OUTER=${1:-20000}
+RUNS=${2:-5}
+WORK=$(mktemp -d /tmp/rmc4_bench_XXXXXX)
+
+if [ ! -x ./RMc4 ]; then
+    echo "Build the compiler first (make)"
+    exit 1
+fi
+
+# the program
+cat > "$WORK/loops.c" <<PROGRAM
+int main() {
+    int a[1000];
+    int b[1000];
+    int c[1000];
+    double x[1000];
+    double y[1000];
+    int i = 0;
+    int j = 0;
+    int total = 0;
+    double sum = 0.0;
+    int result[1] = {0};
+    while (j < 1000) {
+        a[j] = j;
+        b[j] = 1000 - j;
+        j = j + 1;
+    }
+    j = 0;
+    while (j < 1000) {
+        x[j] = 0.5;
+        y[j] = 0.25;
+        j = j + 1;
+    }
+    while (i < $OUTER) {
+        j = 0;
+        while (j < 1000) {
+            c[j] = a[j] + b[j] - 3;
+            j = j + 1;
+        }
+        j = 0;
+        while (j < 1000) {
+            x[j] = x[j] * 0.5 + y[j];
+            j = j + 1;
+        }
+        j = 0;
+        while (j < 1000) {
+            total = total + c[j];
+            j = j + 1;
+        }
+        j = 0;
+        while (j < 1000) {
+            sum = sum + x[j];
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    result[0] = total;
+}
+PROGRAM
+
+# compile with one --vector= setting, cut the assembly out of the report and assemble it
+build() {
+    local isa=$1
+    if ! ./RMc4 "$WORK/loops.c" compiler_output.txt --vector=$isa | grep -q "Compilation completed successfully"; then
+        echo "Compilation failed (--vector=$isa)"
+        exit 1
+    fi
+    awk '/REAL TARGET CODE \(Assemblable/ { on = 1; next } on && /Total Instructions/ { on = 0 } on' compiler_output.txt |
+        sed -n 's/^║ [ 0-9]\{5\} │ \(.*\)║$/\1/p' | sed 's/ *$//' > "$WORK/$isa.s"
+    gcc -no-pie -z noexecstack -o "$WORK/$isa" "$WORK/$isa.s" || exit 1
+}
+
+# best wall time (ms) of a few runs
+measure() {
+    local best=""
+    for run in $(seq 1 "$RUNS"); do
+        local start=$(date +%s%N)
+        "$WORK/$1"
+        local ms=$(( ($(date +%s%N) - start) / 1000000 ))
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo "$best"
+}
+
+ISAS="none sse2"
+grep -qw avx2 /proc/cpuinfo 2>/dev/null && ISAS="$ISAS avx2"
+for isa in $ISAS; do
+    build $isa
+done
+
+echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
+echo "  RM COMPILER - LOOP VECTORIZER, SCALAR VS SSE2 VS AVX2"
+echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
+echo "  Program: $OUTER x 4 loops of 1000 elements, best of $RUNS runs"
+echo ""
+
+scalar=$(measure none)
+for isa in $ISAS; do
+    ms=$scalar
+    [ "$isa" != none ] && ms=$(measure $isa)
+    printf "  --vector=%-5s : %6d ms   %d vector loops   speedup %.2fx\n" "$isa" "$ms" "$(grep -c '^LV[0-9]*:' "$WORK/$isa.s")" \
+        "$(awk -v a="$scalar" -v b="$ms" 'BEGIN { print (b > 0) ? a / b : 0 }')"
+done
+
+rm -rf "$WORK"
@@ -0,0 +1,22 @@
+// Test 09: Common subexpressions - repeated expressions, commutative operands, array read forwarding
+
+int main() {
+    int a = 3;
+    int b = 4;
+    int i = 2;
+    int arr[5] = {1, 2, 3, 4, 5};
+    
+    // Same product written in both operand orders
+    int x = a * b + b * a;
+    int y = a * b;
+    
+    // Index expression evaluated twice by the increment
+    ++arr[i];
+    
+    // Repeated reads of the same element after a write
+    arr[1] = arr[i] + arr[i];
+    arr[0] = x + y;
+    
+    // Read after a write to a different element must not be forwarded
+    arr[3] = arr[i] * 2;
+}
@@ -0,0 +1,28 @@
+// Test 10: Partial redundancy - expressions recomputed on some paths of if/else diamonds
+
+int main() {
+    int arr[8] = {3, 4, 0, 0, 0, 0, 0, 0};
+    int a = arr[0];
+    int b = arr[1];
+    int c = arr[2];
+    
+    // a * b is computed on one path only, then again after the join
+    if (c > 0) {
+        arr[3] = a * b;
+    } else {
+        a = a + 1;
+    }
+    arr[4] = a * b;
+    
+    // a - b is partially redundant: inserted on the path that lacks it
+    if (c > 1) {
+        arr[5] = a - b;
+    }
+    arr[7] = a - b;
+    
+    // Fully redundant across blocks (global CSE)
+    arr[6] = 0 - a;
+    if (c == 0) {
+        arr[2] = 0 - a;
+    }
+}
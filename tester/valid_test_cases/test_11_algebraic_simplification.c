@@ -0,0 +1,31 @@
+// Test 11: Algebraic simplification - identities, strength reduction, constant reassociation
+
+int main() {
+    int arr[12] = {7, 9, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    bool flags[4];
+    int x = arr[0];
+    int y = 0 - arr[1];
+    
+    // Identities
+    arr[2] = x * 1 + 0;
+    arr[7] = x - x;
+    arr[11] = y * 0;
+    
+    // Multiplication and division by powers of two
+    arr[3] = x * 8;
+    arr[4] = 4 * y;
+    arr[8] = y / 4;
+    arr[9] = x / 2;
+    
+    // Constants gathered into one operation
+    arr[5] = (x + 3) + 4;
+    arr[6] = (y - 10) + 2;
+    arr[10] = (x * 2) * 3;
+    
+    // Boolean identities
+    bool b = x > y;
+    flags[0] = b == true;
+    flags[1] = b == false;
+    flags[2] = !(!b);
+    flags[3] = b && true;
+}
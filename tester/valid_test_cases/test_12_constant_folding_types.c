@@ -0,0 +1,24 @@
+// Test 12: Constant folding - double arithmetic, char comparisons, mixed int/double/bool comparisons
+
+int main() {
+    bool flags[6];
+    double darr[4];
+    char c = 'A';
+    
+    // Char comparisons
+    flags[0] = c < 'Z';
+    flags[1] = 'a' == 'a';
+    flags[4] = c != 'A';
+    
+    // Double arithmetic keeps every digit
+    double d = 2.5 * 3.0;
+    darr[0] = d;
+    darr[1] = 0.1 + 0.2;
+    darr[2] = 1.0 / 3.0;
+    
+    // Mixed int/double and int/bool
+    darr[3] = 7 / 2.0;
+    flags[2] = d > 1.5;
+    flags[3] = 3 < 3.5;
+    flags[5] = 1 == true;
+}
@@ -0,0 +1,45 @@
+// Test 13: Constant branches - branch pruning, constants through merges, unreachable blocks
+
+int main() {
+    bool debug = false;
+    int mode = 2;
+    int arr[6] = {0, 0, 0, 0, 0, 0};
+    
+    // Branch on a constant flag: the body is unreachable
+    int x = 5;
+    if (debug) {
+        x = 7;
+    }
+    arr[0] = x;
+    
+    // Only one side of the if/else can execute
+    int y = 0;
+    if (mode == 2) {
+        y = x * 3;
+    } else {
+        y = x - 1;
+    }
+    arr[1] = y;
+    
+    // k keeps its value through the loop merge because the reassignment is never reached
+    int i = 0;
+    int k = 4;
+    while (i < 3) {
+        if (k != 4) {
+            k = 9;
+        }
+        arr[2] = arr[2] + k;
+        i++;
+    }
+    arr[3] = k;
+    
+    // Nested constant conditions
+    bool a = true;
+    bool b = false;
+    if (a) {
+        if (b) {
+            arr[4] = 1;
+        }
+        arr[5] = 2;
+    }
+}
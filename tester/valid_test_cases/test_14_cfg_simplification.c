@@ -0,0 +1,45 @@
+// Test 14: CFG simplification - jump chains, empty blocks, fall-through jumps, block merging
+
+int main() {
+    int a = 3;
+    int b = 8;
+    int c = 0;
+    int arr[4] = {0, 0, 0, 0};
+    
+    // Nested if/else: inner exits jump to outer exits (jump threading)
+    if (a < b) {
+        if (b > 5) {
+            c = 1;
+        } else {
+            c = 2;
+        }
+    } else {
+        if (a == 0) {
+            c = 3;
+        } else {
+            c = 4;
+        }
+    }
+    arr[0] = c;
+    
+    // Empty branches leave jumps to the next block and empty blocks behind
+    if (c > 0) {
+    } else {
+        arr[1] = 9;
+    }
+    
+    // Loop body ending in an if: back edge follows a jump chain
+    int i = 0;
+    while (i < 4) {
+        if (i == 2) {
+            arr[2] = arr[2] + i;
+        }
+        i++;
+    }
+    
+    // Straight-line code split by labels is merged into one block
+    if (a > 1) {
+        arr[3] = a + b;
+    }
+    arr[3] = arr[3] * 2;
+}
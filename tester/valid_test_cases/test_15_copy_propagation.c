@@ -0,0 +1,57 @@
+// Test 15: Constant and copy propagation - copy chains, merges of equal constants, loops
+
+int main() {
+    int a = 5;
+    int b = a;
+    int c = b;
+    int d = c;
+    int e = d + 1;
+    int flag = 0;
+    int sum = 0;
+    int i = 0;
+    int k = 0;
+    int step = 0;
+    int t = 0;
+    int y = 1;
+    int x = 0;
+    int arr[6] = {0, 0, 0, 0, 0, 0};
+    
+    // Long copy chain: every use of d becomes the constant 5
+    arr[0] = d * 2;
+    
+    // Both branches assign the same constant, so k is 7 after the merge
+    if (e > 3) {
+        k = 7;
+    } else {
+        k = 7;
+    }
+    arr[1] = k + e;
+    
+    // Branches assign different constants, k is not a constant after the merge
+    if (arr[0] > 9) {
+        k = 1;
+    } else {
+        k = 2;
+    }
+    arr[2] = k;
+    
+    // Loop: i and sum change in the loop, the copy of a does not
+    step = a;
+    while (i < 3) {
+        t = step;
+        sum = sum + t;
+        i = i + 1;
+    }
+    arr[3] = sum;
+    
+    // Copy killed in a loop: x = y is no longer available once y changes
+    x = y;
+    while (flag < 2) {
+        arr[4] = arr[4] + x;
+        y = y + 10;
+        x = y;
+        flag = flag + 1;
+    }
+    arr[5] = x;
+    
+}
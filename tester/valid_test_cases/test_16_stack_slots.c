@@ -0,0 +1,47 @@
+// Test 16: Stack slot sharing - short-lived temps, copies, swaps and loop-carried values
+
+int main() {
+    int a = 3;
+    int b = 4;
+    int t = 0;
+    int i = 0;
+    int x = 0;
+    int y = 0;
+    int p = 1;
+    int q = 2;
+    int arr[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+    // Many temps that are dead right after their use can share one slot
+    arr[0] = (a + b) * (a - b) + (a * b) - (b - a);
+
+    // Swap: t = a and a = b keep two values alive, they must not share
+    t = a;
+    a = b;
+    b = t;
+    arr[1] = a * 10 + b;
+
+    // A copy whose source is changed while the copy is still needed
+    x = a;
+    a = a + 100;
+    arr[2] = x + a;
+
+    // Loop-carried values: p and q are swapped in every iteration
+    while (i < 5) {
+        t = p;
+        p = q;
+        q = t + q;
+        i = i + 1;
+    }
+    arr[3] = p;
+    arr[4] = q;
+
+    // A value that stays alive across the loop next to short-lived temps
+    y = arr[0] + arr[1];
+    i = 0;
+    while (i < 3) {
+        arr[5] = arr[5] + (i * 2 + 1) * (i + 3);
+        i = i + 1;
+    }
+    arr[6] = y + arr[5];
+    arr[7] = x;
+}
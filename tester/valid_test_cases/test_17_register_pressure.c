@@ -0,0 +1,63 @@
+// Test 17: Register allocation - more live values than registers, loop counters and accumulators
+
+int main() {
+    int a = 1;
+    int b = 2;
+    int c = 3;
+    int d = 4;
+    int e = 5;
+    int f = 6;
+    int g = 7;
+    int h = 8;
+    int k = 9;
+    int m = 10;
+    int n = 11;
+    int p = 12;
+    int q = 13;
+    int i = 0;
+    int sum = 0;
+    int arr[6] = {0, 0, 0, 0, 0, 0};
+
+    // All thirteen values stay alive through the loop, some of them must be spilled
+    while (i < 4) {
+        a = a + b;
+        b = b + c;
+        c = c + d;
+        d = d + e;
+        e = e + f;
+        f = f + g;
+        g = g + h;
+        h = h + k;
+        k = k + m;
+        m = m + n;
+        n = n + p;
+        p = p + q;
+        q = q + a;
+        i = i + 1;
+    }
+    arr[0] = a + b + c + d;
+    arr[1] = e + f + g + h;
+    arr[2] = k + m + n + p + q;
+
+    // Nested loops: counters and the accumulator belong in registers
+    i = 0;
+    while (i < 10) {
+        k = 0;
+        while (k < 10) {
+            sum = sum + i * k;
+            k = k + 1;
+        }
+        i = i + 1;
+    }
+    arr[3] = sum;
+
+    // Comparisons on register values feed the branches
+    if (sum > a) {
+        arr[4] = sum - a;
+    } else {
+        arr[4] = a - sum;
+    }
+    if (a < b && e != f) {
+        arr[5] = g - h;
+    }
+}
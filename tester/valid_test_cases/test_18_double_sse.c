@@ -0,0 +1,50 @@
+// Test 18: Double code generation - SSE2 arithmetic, int/double mixing, double comparisons and constants
+
+int main() {
+    double x = 0.5;
+    double sum = 0.0;
+    double prod = 1.0;
+    double dres[8];
+    bool flags[8];
+    int i = 0;
+    int n = 7;
+
+    // Loop-carried doubles with int loop counters mixed in (converted to double)
+    while (i < 10) {
+        sum = sum + x * i;
+        prod = prod * 1.5 - i / 4.0;
+        x = x + 0.25;
+        i = i + 1;
+    }
+    dres[0] = sum;
+    dres[1] = prod;
+    dres[2] = n / 2.0 + sum / n;
+
+    // Subtraction on doubles
+    dres[3] = 0.0 - x;
+    dres[4] = 1.0 - x * 2.0;
+
+    // Double comparisons as values
+    flags[0] = sum < prod;
+    flags[1] = sum > prod;
+    flags[2] = x <= 3.0;
+    flags[3] = x >= 3.0;
+    flags[4] = x == 3.0;
+    flags[5] = x != 3.0;
+    flags[6] = n < x;
+
+    // Double comparisons as branch conditions
+    dres[5] = 0.0;
+    if (sum > 100.0) {
+        dres[5] = dres[5] + 1.0;
+    }
+    if (x <= 2.5) {
+        dres[5] = dres[5] + 10.0;
+    }
+    while (x < 100.0) {
+        x = x * 3.0;
+    }
+    dres[6] = x;
+    flags[7] = x == dres[6];
+    dres[7] = 100000000000000000000.0 * x * 2.0;
+}
@@ -0,0 +1,43 @@
+// Test 19: Division by constants - magic-number multiply for odd/even divisors, negative dividends and divisors
+
+int main() {
+    int q[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    int n = 0 - 1000;
+    int d = 0 - 7;
+
+    // Literals are 32-bit, so the wide values are built arithmetically
+    int m = 1000000;
+    int big = 123456 * m + 789123;
+    int p = 1073741824;
+    int huge = p * p * 4 - 1 + p * p * 4;
+    int wide = m * m + 39;
+    int k = 0;
+    int v = 0;
+
+    // Every sign of the dividend, truncation toward zero
+    while (n < 1000) {
+        q[0] = q[0] + n / 25;
+        q[1] = q[1] + n / 3;
+        q[2] = q[2] + n / 7;
+        q[3] = q[3] + n / 10;
+        q[4] = q[4] + n / 641;
+        q[5] = q[5] + n / 8;
+        q[6] = q[6] + n / d;
+        n = n + 7;
+    }
+
+    // Large dividends and divisors (the dividend changes every iteration)
+    while (k < 5) {
+        v = big * k + k;
+        q[7] = q[7] + v / 1000000007;
+        q[8] = q[8] + (v * 64) / 6;
+        q[9] = q[9] + (0 - v) / 9;
+        q[10] = q[10] + v / huge;
+        q[11] = q[11] + (0 - v) / (0 - 12);
+        q[12] = q[12] + (v * 1000) / wide;
+        q[13] = q[13] + (0 - v) / wide;
+        q[14] = q[14] + (huge - k) / huge;
+        q[15] = q[15] + (k - huge) / (0 - wide);
+        k = k + 1;
+    }
+}
@@ -0,0 +1,39 @@
+// Test 20: Byte-sized arrays - char and bool elements packed one byte each (movb/movzbl), next to 8-byte int arrays holding computed values wider than 32 bits
+
+int main() {
+    char letters[10] = {'r', 'm', 'c', 'o', 'm', 'p', 'i', 'l', 'e', 'r'};
+    char reversed[10];
+    bool late[9];
+    int counts[3] = {0, 0, 0};
+    int wide[9];
+    int scale = 100000;
+    int total = 0;
+    char last = 'a';
+    int i = 0;
+
+    // Variable indices: copy, compare and count through byte elements
+    while (i < 9) {
+        reversed[9 - i] = letters[i];
+        late[i] = letters[i] > 'k';
+        if (late[i] == true) {
+            counts[0] = counts[0] + 1;
+        }
+        if (letters[i] == letters[i + 1]) {
+            counts[1] = counts[1] + 1;
+        }
+        wide[i] = scale * scale * (i + 1) + i;
+        total = total + wide[i];
+        i = i + 1;
+    }
+    reversed[0] = letters[9];
+
+    // Constant indices and values kept in registers
+    last = reversed[0];
+    letters[0] = last;
+    letters[9] = 'z';
+    late[8] = false;
+    if (letters[9] != letters[0]) {
+        counts[2] = 9;
+    }
+    wide[0] = total - wide[8];
+}
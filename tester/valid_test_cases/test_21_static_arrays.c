@@ -0,0 +1,33 @@
+// Test 21: Static arrays - constant initializers as .data/.rodata images, uninitialized arrays in .bss
+
+int main() {
+    int primes[6] = {2, 3, 5, 7, 11, 13};
+    double weights[4] = {0.5, 1.25, 0.0, 2.0};
+    char word[5] = {'s', 't', 'a', 't', 'e'};
+    bool flags[3] = {true, false, true};
+    int sums[6];
+    int window[3] = {0, 0, 0};
+    double total = 0.0;
+    int i = 0;
+
+    // Read-only images: primes and weights are never stored to again
+    while (i < 6) {
+        sums[i] = primes[i] * 2;
+        if (i < 4) {
+            total = total + weights[i];
+        }
+        i = i + 1;
+    }
+
+    // Initialized arrays written at run time, and an initializer repeated in a loop
+    i = 0;
+    while (i < 3) {
+        window[0] = 1;
+        window[1] = 2;
+        window[2] = window[0] + window[1] + i;
+        word[i] = 'x';
+        flags[i] = word[i] == word[3];
+        i = i + 1;
+    }
+    sums[0] = window[2];
+}
@@ -0,0 +1,45 @@
+// Test 22: Loop idioms - fill and copy loops as straight stores or rep stos/movs, loop variable kept after the loop
+
+int main() {
+    char letters[10];
+    bool marks[45];
+    int table[40];
+    int backup[40];
+    double scale[6] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+    double saved[6];
+    int squares[8];
+    int i;
+    int after = 0;
+
+    // Constant fills: short ones as straight stores, long ones as rep stos
+    for (i = 0; i < 10; i++) {
+        letters[i] = 'A';
+    }
+    for (i = 0; i <= 44; i++) {
+        marks[i] = true;
+    }
+    for (i = 0; i < 40; i++) {
+        table[i] = 0;
+    }
+    after = i;
+
+    // A body depending on i stays a loop
+    for (i = 0; i < 8; i++) {
+        squares[i] = i * i;
+    }
+
+    // Copies of a part and of a whole array
+    for (i = 5; i < 40; i++) {
+        table[i] = 0 - 7;
+    }
+    for (i = 3; i < 40; i++) {
+        backup[i] = table[i];
+    }
+    for (i = 0; i < 6; i++) {
+        saved[i] = scale[i];
+    }
+    after = after + i + squares[7];
+    backup[0] = after;
+    letters[9] = 'z';
+    marks[44] = false;
+}
@@ -0,0 +1,64 @@
+// Test 23: Vectorized loops - element-wise int/double arrays, invariants, odd trip counts for the scalar rest, int reductions (double ones stay scalar)
+
+int main() {
+    int a[37];
+    int b[37];
+    int c[37];
+    double x[21];
+    double y[21];
+    int sums[3] = {0, 0, 0};
+    double totals[2] = {0.0, 0.0};
+    int i = 0;
+    int k = 5;
+    int total = 100;
+    int spent = 1000;
+    double scale = 1.5;
+    double sum = 0.25;
+    double product = 1.0;
+
+    // Inputs written by scalar loops (the counter is read as a value)
+    for (i = 0; i < 37; i = i + 1) {
+        a[i] = i * 3;
+        b[i] = 40 - i;
+    }
+    for (i = 0; i < 21; i = i + 1) {
+        x[i] = 0.5;
+        y[i] = 2.0;
+    }
+    x[3] = 1.25;
+    y[20] = 0.75;
+    k = a[2] - 1;
+    scale = x[3] + 0.25;
+
+    // Element-wise int: arrays, constants and an invariant variable, 37 = 2 * 18 + 1 = 4 * 9 + 1
+    for (i = 0; i < 37; i = i + 1) {
+        c[i] = a[i] + b[i] - k;
+    }
+    for (i = 1; i <= 35; i = i + 1) {
+        b[i] = c[i] - a[i] + 7;
+    }
+
+    // Element-wise double with all four operators
+    for (i = 0; i < 21; i = i + 1) {
+        x[i] = (x[i] * scale + y[i]) / 2.0 - 0.125;
+    }
+
+    // Reductions: int sum and difference vectorized, double sum and product stay in element order
+    for (i = 0; i < 37; i = i + 1) {
+        total = total + c[i];
+    }
+    for (i = 2; i < 33; i = i + 1) {
+        spent = spent - b[i] * 1;
+    }
+    for (i = 0; i < 21; i = i + 1) {
+        sum = sum + x[i] * y[i];
+    }
+    for (i = 0; i < 21; i = i + 1) {
+        product = product * y[i];
+    }
+    sums[0] = total;
+    sums[1] = spent;
+    sums[2] = i;
+    totals[0] = sum;
+    totals[1] = product;
+}
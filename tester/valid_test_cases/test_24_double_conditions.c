@@ -0,0 +1,42 @@
+// Test 24: Double conditions - doubles in registers as if/while conditions, -0.0 is false, infinity and NaN are true
+
+int main() {
+    double d = 5.5;
+    double big = 1000.0;
+    double notnum = 0.0;
+    double negzero = 0.0;
+    double half = 0.0 - 0.5;
+    int hits[6] = {0, 0, 0, 0, 0, 0};
+    int i = 0;
+
+    // Counts down to exactly 0.0
+    while (d) {
+        d = d - 0.5;
+        hits[0] = hits[0] + 1;
+    }
+
+    // Overflow to infinity, infinity - infinity is NaN, -0.5 * 0.0 is -0.0
+    for (i = 0; i < 12; i = i + 1) {
+        big = big * big;
+    }
+    notnum = big - big;
+    negzero = half * 0.0;
+    if (big) {
+        hits[1] = 1;
+    }
+    if (notnum) {
+        hits[2] = 1;
+    }
+    if (negzero) {
+        hits[3] = 1;
+    }
+    if (half) {
+        hits[4] = 1;
+    }
+
+    // NaN keeps the loop going until it becomes -0.0
+    while (notnum) {
+        hits[5] = hits[5] + 1;
+        notnum = negzero;
+    }
+}
@@ -0,0 +1,29 @@
+// Test 25: Wide constants - propagated values beyond 32 bits as operands of add, sub, mul, compare, division and stores
+
+int main() {
+    int a = 100000;
+    int big = a * a;
+    int x = 0;
+    int y = 0;
+    int r[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    int i = 0;
+
+    // big (10^10) reaches every operand as a constant that needs movabsq
+    while (i < 3) {
+        x = x + 7;
+        r[0] = x + big;
+        r[1] = x * big;
+        r[2] = x - big;
+        r[3] = big - x;
+        if (x < big) {
+            r[4] = r[4] + 1;
+        }
+        if (big > x) {
+            r[5] = r[5] + 1;
+        }
+        y = big;
+        r[6] = (r[1] + y) / big;
+        r[7] = big * 300 / x;
+        i = i + 1;
+    }
+}
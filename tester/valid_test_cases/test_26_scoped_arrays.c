@@ -0,0 +1,28 @@
+// Test 26: Same-name arrays in different scopes - the shared static label is sized for the largest declaration
+
+int main() {
+    int r[4] = {0, 0, 0, 0};
+    int i = 0;
+    int guard[2] = {7, 7};
+
+    if (r[0] == 0) {
+        int v[2] = {1, 2};
+        r[0] = v[0] + v[1];
+    }
+
+    if (r[0] == 3) {
+        int v[8];
+        i = 0;
+        while (i < 8) {
+            v[i] = i * 10;
+            i = i + 1;
+        }
+        r[1] = v[7] + v[6];
+        r[2] = guard[0] + guard[1];
+    }
+
+    for (i = 0; i < 2; i++) {
+        int v[4] = {5, 6, 7, 8};
+        r[3] = r[3] + v[i + 2];
+    }
+}